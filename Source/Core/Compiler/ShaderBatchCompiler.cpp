@@ -0,0 +1,156 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderBatchCompiler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+void ShaderBatchCompiler::Initialize(const char* pCacheDirectory, UI32 threadCount, bool compressCache)
+{
+	mCompiler.Initialize(pCacheDirectory, compressCache);
+	mThreadPool.Initialize(threadCount);
+}
+
+void ShaderBatchCompiler::Terminate()
+{
+	mThreadPool.Terminate();
+	mCompiler.Terminate();
+}
+
+std::vector<ShaderBatchEntry> ShaderBatchCompiler::Compile(const std::vector<ShaderCompileInfo>& infos)
+{
+	// Every task writes only to its own slot, so the output order is the input order.
+	std::vector<ShaderBatchEntry> entries(infos.size());
+	for (UI64 i = 0; i < infos.size(); i++)
+	{
+		entries[i].mInfo = infos[i];
+
+		ShaderBatchEntry* pEntry = &entries[i];
+		mThreadPool.Submit([this, pEntry] { pEntry->mResult = mCompiler.Compile(pEntry->mInfo, &pEntry->mCode); });
+	}
+
+	mThreadPool.Wait();
+	return entries;
+}
+
+bool ShaderBatchCompiler::CollectDirectory(const char* pDirectory, const ShaderCompileInfo& baseInfo, std::vector<ShaderCompileInfo>* pInfos)
+{
+	std::error_code errorCode;
+	std::vector<String> files;
+	for (auto itr = std::filesystem::recursive_directory_iterator(pDirectory, errorCode); !errorCode && itr != std::filesystem::recursive_directory_iterator(); itr.increment(errorCode))
+		if (itr->is_regular_file() && GetStage(itr->path().extension().string()) != ShaderStage::UNDEFINED)
+			files.push_back(itr->path().string());
+
+	if (errorCode)
+		return false;
+
+	std::sort(files.begin(), files.end());
+
+	for (const String& file : files)
+	{
+		ShaderCompileInfo info = baseInfo;
+		info.mFile = file;
+		info.mStage = GetStage(std::filesystem::path(file).extension().string());
+		pInfos->push_back(std::move(info));
+	}
+
+	return true;
+}
+
+bool ShaderBatchCompiler::LoadManifest(const char* pFile, const ShaderCompileInfo& baseInfo, std::vector<ShaderCompileInfo>* pInfos, String* pError)
+{
+	std::ifstream file(pFile);
+	if (!file.is_open())
+	{
+		*pError = String(pFile) + ": Failed to open the manifest!";
+		return false;
+	}
+
+	const std::filesystem::path root = std::filesystem::path(pFile).parent_path();
+
+	String line;
+	UI32 lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		std::istringstream stream(line);
+		String token;
+		if (!(stream >> token) || token[0] == '#')
+			continue;
+
+		ShaderCompileInfo info = baseInfo;
+		info.mFile = (root / token).string();
+		info.mStage = GetStage(std::filesystem::path(token).extension().string());
+
+		while (stream >> token)
+		{
+			UI64 separator = token.find('=');
+			if (separator != String::npos)
+				info.mDefines.push_back({ token.substr(0, separator), token.substr(separator + 1) });
+			else if (GetStage(token) != ShaderStage::UNDEFINED)
+				info.mStage = GetStage(token);
+			else
+			{
+				*pError = String(pFile) + "(" + std::to_string(lineNumber) + "): Unknown token \"" + token + "\"!";
+				return false;
+			}
+		}
+
+		if (info.mStage == ShaderStage::UNDEFINED)
+		{
+			*pError = String(pFile) + "(" + std::to_string(lineNumber) + "): Unable to deduce the shader stage!";
+			return false;
+		}
+
+		pInfos->push_back(std::move(info));
+	}
+
+	return true;
+}
+
+ShaderStage ShaderBatchCompiler::GetStage(String name)
+{
+	if (!name.empty() && name[0] == '.')
+		name.erase(0, 1);
+
+	if (name == "vert")
+		return ShaderStage::VERTEX;
+	else if (name == "tesc")
+		return ShaderStage::TESSELLATION_CONTROL;
+	else if (name == "tese")
+		return ShaderStage::TESSELLATION_EVALUATION;
+	else if (name == "geom")
+		return ShaderStage::GEOMETRY;
+	else if (name == "frag")
+		return ShaderStage::FRAGMENT;
+	else if (name == "comp")
+		return ShaderStage::COMPUTE;
+
+	return ShaderStage::UNDEFINED;
+}
+
+String ShaderBatchCompiler::GetVariantKey(const ShaderCompileInfo& info, const ShaderCompileInfo& baseInfo)
+{
+	static const char* pStageNames[] = { "", "vert", "tesc", "tese", "geom", "frag", "comp" };
+
+	String key;
+	if (info.mStage != GetStage(std::filesystem::path(info.mFile).extension().string()))
+		key = pStageNames[static_cast<UI8>(info.mStage)];
+
+	// Inherited defines come first, the ones of the variant are appended after them.
+	for (UI64 i = std::min(baseInfo.mDefines.size(), info.mDefines.size()); i < info.mDefines.size(); i++)
+	{
+		if (!key.empty())
+			key += ';';
+
+		key += info.mDefines[i].first;
+		if (!info.mDefines[i].second.empty())
+			key += '=' + info.mDefines[i].second;
+	}
+
+	return key;
+}
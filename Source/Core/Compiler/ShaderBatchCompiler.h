@@ -0,0 +1,102 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ShaderCompiler.h"
+#include "Core/Threading/ThreadPool.h"
+
+/**
+ * Shader batch entry structure.
+ * Holds one shader of a batch along with its own diagnostics.
+ */
+struct ShaderBatchEntry {
+	ShaderCompileInfo mInfo = {};
+	ShaderCode mCode = {};
+	ShaderCompileResult mResult = {};
+};
+
+/**
+ * Shader Batch Compiler object.
+ * Compiles many shaders at once on a thread pool. Results are returned in the order of the inputs
+ * regardless of which worker finished first.
+ */
+class ShaderBatchCompiler {
+public:
+	ShaderBatchCompiler() {}
+	~ShaderBatchCompiler() {}
+
+	/**
+	 * Initialize the batch compiler.
+	 *
+	 * @param pCacheDirectory: The compile cache directory. nullptr disables the cache.
+	 * @param threadCount: The number of worker threads. 0 uses all the cores.
+	 * @param compressCache: Whether new cache entries are compressed with the SPIR-V codec.
+	 */
+	void Initialize(const char* pCacheDirectory = nullptr, UI32 threadCount = 0, bool compressCache = false);
+
+	/**
+	 * Terminate the batch compiler.
+	 */
+	void Terminate();
+
+	/**
+	 * Compile a batch of shaders.
+	 *
+	 * @param infos: The compile infos.
+	 * @return The entries in the same order as the infos.
+	 */
+	std::vector<ShaderBatchEntry> Compile(const std::vector<ShaderCompileInfo>& infos);
+
+	const ShaderCompiler& GetCompiler() const { return mCompiler; }
+	ThreadPool& GetThreadPool() { return mThreadPool; }
+
+public:
+	/**
+	 * Collect all the shaders in a directory, recursively.
+	 * The stage is deduced from the file extension (.vert, .tesc, .tese, .geom, .frag, .comp) and other files
+	 * are skipped. The infos are sorted by path.
+	 *
+	 * @param pDirectory: The directory.
+	 * @param baseInfo: The info to copy the defines, include directories and target from.
+	 * @param pInfos: The vector to append the infos to.
+	 * @return Boolean value stating if the directory could be read.
+	 */
+	static bool CollectDirectory(const char* pDirectory, const ShaderCompileInfo& baseInfo, std::vector<ShaderCompileInfo>* pInfos);
+
+	/**
+	 * Load a shader manifest.
+	 * Each line is "<path> [stage] [NAME=VALUE ...]" where the path is relative to the manifest. Empty lines and
+	 * lines starting with '#' are ignored. The stage is deduced from the extension when omitted.
+	 *
+	 * @param pFile: The manifest file.
+	 * @param baseInfo: The info to copy the defines, include directories and target from.
+	 * @param pInfos: The vector to append the infos to.
+	 * @param pError: The string to store the error message if failed.
+	 * @return Boolean value.
+	 */
+	static bool LoadManifest(const char* pFile, const ShaderCompileInfo& baseInfo, std::vector<ShaderCompileInfo>* pInfos, String* pError);
+
+	/**
+	 * Get the shader stage from a name such as "vert" or ".frag".
+	 *
+	 * @param name: The stage name or file extension.
+	 * @return The shader stage. UNDEFINED if the name is unknown.
+	 */
+	static ShaderStage GetStage(String name);
+
+	/**
+	 * Get the key telling apart the variants of one source, such as the manifest lines compiling the same file.
+	 * Holds the stage if it is not the one of the file extension, followed by the defines which were not inherited
+	 * from the base info.
+	 *
+	 * @param info: The compile info.
+	 * @param baseInfo: The info the defines were inherited from.
+	 * @return The key, "stage;NAME=VALUE;...". Empty if the info is not a variant.
+	 */
+	static String GetVariantKey(const ShaderCompileInfo& info, const ShaderCompileInfo& baseInfo);
+
+private:
+	ShaderCompiler mCompiler = {};
+	ThreadPool mThreadPool = {};
+};
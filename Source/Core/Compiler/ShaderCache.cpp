@@ -0,0 +1,115 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderCache.h"
+#include "Core/Compression/SPIRVCodec.h"
+#include "Core/Types/Hasher.h"
+#include "Core/Types/Utilities.h"
+#include "Core/ErrorHandler/Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+bool ShaderCache::Initialize(const char* pDirectory, bool compress)
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(pDirectory, errorCode);
+
+	if (errorCode || !std::filesystem::is_directory(pDirectory))
+	{
+		Logger::LogError((TEXT("Failed to create the shader cache directory: ") + StringToWString(pDirectory)).c_str());
+		mDirectory.clear();
+		return false;
+	}
+
+	mDirectory = pDirectory;
+	mCompress = compress;
+	return true;
+}
+
+bool ShaderCache::Map(UI64 hash, MappedFile* pFile) const
+{
+	if (!IsValid() || !pFile->Open(GetEntryPath(hash, ".spv").c_str()))
+		return false;
+
+	// Reject truncated or foreign files.
+	if (pFile->GetSize() % sizeof(UI32) || *reinterpret_cast<const UI32*>(pFile->GetData()) != SPIRV_MAGIC_NUMBER)
+	{
+		pFile->Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool ShaderCache::Load(UI64 hash, ShaderStage stage, ShaderCode* pShaderCode) const
+{
+	MappedFile file;
+	if (Map(hash, &file))
+	{
+		pShaderCode->SetCode(std::move(file), ShaderCodeType::SPIR_V, stage);
+		return true;
+	}
+
+	std::vector<UI32> code;
+	if (!MapBlob(hash, ".spvz", &file) || !SPIRVCodec::Decode(file.GetData(), file.GetSize(), &code) || code.empty() || code[0] != SPIRV_MAGIC_NUMBER)
+		return false;
+
+	pShaderCode->SetCode(std::move(code), ShaderCodeType::SPIR_V, stage);
+	return true;
+}
+
+bool ShaderCache::Store(UI64 hash, const std::vector<UI32>& code) const
+{
+	if (!mCompress)
+		return StoreBlob(hash, ".spv", code.data(), code.size() * sizeof(UI32));
+
+	std::vector<BYTE> encoded;
+	SPIRVCodec::Encode(code.data(), code.size(), &encoded);
+	return StoreBlob(hash, ".spvz", encoded.data(), encoded.size());
+}
+
+bool ShaderCache::MapBlob(UI64 hash, const char* pExtension, MappedFile* pFile) const
+{
+	return IsValid() && pFile->Open(GetEntryPath(hash, pExtension).c_str());
+}
+
+bool ShaderCache::StoreBlob(UI64 hash, const char* pExtension, const void* pData, UI64 size) const
+{
+	if (!IsValid() || !size)
+		return false;
+
+	String entryPath = GetEntryPath(hash, pExtension);
+
+	// Unique temporary name so that concurrent writers never share a file.
+	std::stringstream temporaryPath;
+	temporaryPath << entryPath << "." << std::this_thread::get_id() << ".tmp";
+
+	{
+		std::ofstream file(temporaryPath.str(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		file.write(static_cast<const char*>(pData), size);
+		if (!file)
+			return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryPath.str(), entryPath, errorCode);
+
+	if (errorCode)
+	{
+		std::filesystem::remove(temporaryPath.str(), errorCode);
+		return false;
+	}
+
+	return true;
+}
+
+String ShaderCache::GetEntryPath(UI64 hash, const char* pExtension) const
+{
+	return (std::filesystem::path(mDirectory) / (Hasher::ToString(hash) + pExtension)).string();
+}
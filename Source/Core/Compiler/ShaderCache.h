@@ -0,0 +1,90 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Objects/ShaderCode.h"
+
+/**
+ * Shader Cache object.
+ * Stores compiled SPIR-V on disk, addressed by the hash of everything that went into compiling it.
+ */
+class ShaderCache {
+public:
+	ShaderCache() {}
+	~ShaderCache() {}
+
+	/**
+	 * Initialize the cache.
+	 * The directory is created if it does not exist.
+	 *
+	 * @param pDirectory: The cache directory.
+	 * @param compress: Whether new binaries are stored compressed with the SPIR-V codec.
+	 * @return Boolean value stating if the directory is usable.
+	 */
+	bool Initialize(const char* pDirectory, bool compress = false);
+
+	/**
+	 * Map a cached SPIR-V binary.
+	 * The code is not copied; the mapping can be handed straight to a ShaderCode object.
+	 *
+	 * @param hash: The content hash of the entry.
+	 * @param pFile: The mapped file to map the entry to.
+	 * @return Boolean value stating if the entry was found and is valid.
+	 */
+	bool Map(UI64 hash, MappedFile* pFile) const;
+
+	/**
+	 * Load a cached SPIR-V binary.
+	 * Uncompressed entries are mapped in place, compressed ones are decoded. The shader code is left untouched on failure.
+	 *
+	 * @param hash: The content hash of the entry.
+	 * @param stage: The shader stage of the code.
+	 * @param pShaderCode: The shader code to load to.
+	 * @return Boolean value stating if the entry was found and is valid.
+	 */
+	bool Load(UI64 hash, ShaderStage stage, ShaderCode* pShaderCode) const;
+
+	/**
+	 * Store a SPIR-V binary in the cache.
+	 * The binary is compressed if the cache was initialized to. The entry is written to a temporary file and renamed in place so readers never see a partial file.
+	 *
+	 * @param hash: The content hash of the entry.
+	 * @param code: The SPIR-V code.
+	 * @return Boolean value stating if the entry was written.
+	 */
+	bool Store(UI64 hash, const std::vector<UI32>& code) const;
+
+	/**
+	 * Map a cached blob.
+	 * Blobs hold data derived from a binary, such as its reflection, and are told apart by their extension.
+	 *
+	 * @param hash: The content hash of the entry.
+	 * @param pExtension: The extension of the entry, including the dot.
+	 * @param pFile: The mapped file to map the entry to.
+	 * @return Boolean value stating if the entry was found.
+	 */
+	bool MapBlob(UI64 hash, const char* pExtension, MappedFile* pFile) const;
+
+	/**
+	 * Store a blob in the cache.
+	 *
+	 * @param hash: The content hash of the entry.
+	 * @param pExtension: The extension of the entry, including the dot.
+	 * @param pData: The data to store.
+	 * @param size: The size of the data in bytes.
+	 * @return Boolean value stating if the entry was written.
+	 */
+	bool StoreBlob(UI64 hash, const char* pExtension, const void* pData, UI64 size) const;
+
+	bool IsValid() const { return !mDirectory.empty(); }
+	bool IsCompressed() const { return mCompress; }
+	const String& GetDirectory() const { return mDirectory; }
+
+private:
+	String GetEntryPath(UI64 hash, const char* pExtension) const;
+
+private:
+	String mDirectory;
+	bool mCompress = false;
+};
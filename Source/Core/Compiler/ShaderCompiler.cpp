@@ -0,0 +1,567 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderCompiler.h"
+#include "Core/Types/Hasher.h"
+
+#include <glslang/Public/ShaderLang.h>
+#include <glslang/Include/ResourceLimits.h>
+#include <SPIRV/GlslangToSpv.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/**
+ * Version of the cache key layout.
+ * Bump this whenever the way a key is built or the way code is generated changes.
+ */
+#define SHADER_CACHE_KEY_VERSION	1
+
+namespace _Helpers
+{
+	/**
+	 * Read a whole text file.
+	 *
+	 * @param path: The file path.
+	 * @param pString: The string to read to.
+	 * @return Boolean value stating if the file was read.
+	 */
+	bool ReadTextFile(const String& path, String* pString)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		std::stringstream stream;
+		stream << file.rdbuf();
+		*pString = stream.str();
+		return true;
+	}
+
+	/**
+	 * Resolve an include name to a file path.
+	 * Local includes are searched relative to the includer first, then in the include directories.
+	 *
+	 * @param headerName: The name written in the #include directive.
+	 * @param includerPath: The path of the file containing the directive.
+	 * @param includeDirectories: The additional search directories.
+	 * @param isLocal: Whether the directive used quotes instead of angle brackets.
+	 * @return The resolved path. Empty if not found.
+	 */
+	String ResolveInclude(const String& headerName, const String& includerPath, const std::vector<String>& includeDirectories, bool isLocal)
+	{
+		std::error_code errorCode;
+
+		if (isLocal)
+		{
+			std::filesystem::path candidate = std::filesystem::path(includerPath).parent_path() / headerName;
+			if (std::filesystem::is_regular_file(candidate, errorCode))
+				return std::filesystem::weakly_canonical(candidate, errorCode).string();
+		}
+
+		for (const String& directory : includeDirectories)
+		{
+			std::filesystem::path candidate = std::filesystem::path(directory) / headerName;
+			if (std::filesystem::is_regular_file(candidate, errorCode))
+				return std::filesystem::weakly_canonical(candidate, errorCode).string();
+		}
+
+		return String();
+	}
+
+	/**
+	 * Parse an #include directive from a single line.
+	 *
+	 * @param line: The source line.
+	 * @param pHeaderName: The string to store the header name.
+	 * @param pIsLocal: The boolean to store whether the include is a quoted include.
+	 * @return Boolean value stating if the line is an include directive.
+	 */
+	bool ParseIncludeDirective(const String& line, String* pHeaderName, bool* pIsLocal)
+	{
+		UI64 index = line.find_first_not_of(" \t");
+		if (index == String::npos || line[index] != '#')
+			return false;
+
+		index = line.find_first_not_of(" \t", index + 1);
+		if (index == String::npos || line.compare(index, 7, "include") != 0)
+			return false;
+
+		index = line.find_first_not_of(" \t", index + 7);
+		if (index == String::npos || (line[index] != '"' && line[index] != '<'))
+			return false;
+
+		const char closing = line[index] == '"' ? '"' : '>';
+		UI64 end = line.find(closing, index + 1);
+		if (end == String::npos)
+			return false;
+
+		*pHeaderName = line.substr(index + 1, end - index - 1);
+		*pIsLocal = closing == '"';
+		return true;
+	}
+
+	/**
+	 * Included file structure.
+	 * An include as it was read for the content hash. glslang is given the same source, so the compiled code always
+	 * matches the hash even if the file is saved again while compiling.
+	 */
+	struct IncludedFile {
+		ShaderFileStamp mStamp = {};		// Taken before the file was read.
+		String mSource = "";
+		bool mIsRead = false;
+	};
+
+	/**
+	 * Feed a source file and all of its transitive includes to a hasher.
+	 * Every file is hashed once, in the order it is first reached.
+	 *
+	 * @param source: The source of the file.
+	 * @param path: The path of the file.
+	 * @param includeDirectories: The additional search directories.
+	 * @param pHasher: The hasher.
+	 * @param pIncludes: The files already hashed, by resolved path.
+	 */
+	void HashExpandedSource(const String& source, const String& path, const std::vector<String>& includeDirectories, Hasher* pHasher, std::map<String, IncludedFile>* pIncludes)
+	{
+		pHasher->Update(source);
+
+		std::istringstream stream(source);
+		String line, headerName;
+		bool isLocal = false;
+		while (std::getline(stream, line))
+		{
+			if (!ParseIncludeDirective(line, &headerName, &isLocal))
+				continue;
+
+			String resolved = ResolveInclude(headerName, path, includeDirectories, isLocal);
+
+			// Unresolved includes still alter the key, glslang will report them when compiling.
+			if (resolved.empty())
+			{
+				pHasher->Update(headerName);
+				continue;
+			}
+
+			auto result = pIncludes->insert({ resolved, IncludedFile() });
+			if (!result.second)
+				continue;
+
+			// A save after the stamp makes the recorded stamp stale, so the next lookup compiles again.
+			IncludedFile& include = result.first->second;
+			include.mStamp = ShaderFileStamp::Create(resolved);
+			include.mIsRead = ReadTextFile(resolved, &include.mSource);
+
+			if (include.mIsRead)
+				HashExpandedSource(include.mSource, resolved, includeDirectories, pHasher, pIncludes);
+		}
+	}
+
+	/**
+	 * Includer for glslang serving the files read for the content hash.
+	 */
+	class FileIncluder : public glslang::TShader::Includer {
+	public:
+		FileIncluder(const std::vector<String>& includeDirectories, const std::map<String, IncludedFile>& includes) : mIncludeDirectories(includeDirectories), mIncludes(includes) {}
+		~FileIncluder() {}
+
+		virtual IncludeResult* includeLocal(const char* pHeaderName, const char* pIncluderName, size_t inclusionDepth) override final
+		{
+			return Include(pHeaderName, pIncluderName, true);
+		}
+
+		virtual IncludeResult* includeSystem(const char* pHeaderName, const char* pIncluderName, size_t inclusionDepth) override final
+		{
+			return Include(pHeaderName, pIncluderName, false);
+		}
+
+		virtual void releaseInclude(IncludeResult* pResult) override final
+		{
+			delete pResult;
+		}
+
+	private:
+		IncludeResult* Include(const char* pHeaderName, const char* pIncluderName, bool isLocal)
+		{
+			String resolved = ResolveInclude(pHeaderName, pIncluderName, mIncludeDirectories, isLocal);
+			if (resolved.empty())
+				return nullptr;
+
+			auto itr = mIncludes.find(resolved);
+			if (itr == mIncludes.end() || !itr->second.mIsRead)
+				return nullptr;
+
+			return new IncludeResult(resolved, itr->second.mSource.data(), itr->second.mSource.size(), nullptr);
+		}
+
+	private:
+		const std::vector<String>& mIncludeDirectories;
+		const std::map<String, IncludedFile>& mIncludes;
+	};
+
+	/**
+	 * Get the glslang stage of a shader stage.
+	 *
+	 * @param stage: The shader stage.
+	 * @return The EShLanguage.
+	 */
+	EShLanguage GetLanguage(ShaderStage stage)
+	{
+		switch (stage)
+		{
+		case ShaderStage::VERTEX:
+			return EShLangVertex;
+		case ShaderStage::TESSELLATION_CONTROL:
+			return EShLangTessControl;
+		case ShaderStage::TESSELLATION_EVALUATION:
+			return EShLangTessEvaluation;
+		case ShaderStage::GEOMETRY:
+			return EShLangGeometry;
+		case ShaderStage::FRAGMENT:
+			return EShLangFragment;
+		case ShaderStage::COMPUTE:
+			return EShLangCompute;
+		default:
+			return EShLangCount;
+		}
+	}
+
+	/**
+	 * Get the default built in resource limits.
+	 * These match the limits glslangValidator uses when no configuration is given.
+	 *
+	 * @return The TBuiltInResource structure.
+	 */
+	TBuiltInResource GetDefaultResources()
+	{
+		TBuiltInResource resources = {};
+		resources.maxLights = 32;
+		resources.maxClipPlanes = 6;
+		resources.maxTextureUnits = 32;
+		resources.maxTextureCoords = 32;
+		resources.maxVertexAttribs = 64;
+		resources.maxVertexUniformComponents = 4096;
+		resources.maxVaryingFloats = 64;
+		resources.maxVertexTextureImageUnits = 32;
+		resources.maxCombinedTextureImageUnits = 80;
+		resources.maxTextureImageUnits = 32;
+		resources.maxFragmentUniformComponents = 4096;
+		resources.maxDrawBuffers = 32;
+		resources.maxVertexUniformVectors = 128;
+		resources.maxVaryingVectors = 8;
+		resources.maxFragmentUniformVectors = 16;
+		resources.maxVertexOutputVectors = 16;
+		resources.maxFragmentInputVectors = 15;
+		resources.minProgramTexelOffset = -8;
+		resources.maxProgramTexelOffset = 7;
+		resources.maxClipDistances = 8;
+		resources.maxComputeWorkGroupCountX = 65535;
+		resources.maxComputeWorkGroupCountY = 65535;
+		resources.maxComputeWorkGroupCountZ = 65535;
+		resources.maxComputeWorkGroupSizeX = 1024;
+		resources.maxComputeWorkGroupSizeY = 1024;
+		resources.maxComputeWorkGroupSizeZ = 64;
+		resources.maxComputeUniformComponents = 1024;
+		resources.maxComputeTextureImageUnits = 16;
+		resources.maxComputeImageUniforms = 8;
+		resources.maxComputeAtomicCounters = 8;
+		resources.maxComputeAtomicCounterBuffers = 1;
+		resources.maxVaryingComponents = 60;
+		resources.maxVertexOutputComponents = 64;
+		resources.maxGeometryInputComponents = 64;
+		resources.maxGeometryOutputComponents = 128;
+		resources.maxFragmentInputComponents = 128;
+		resources.maxImageUnits = 8;
+		resources.maxCombinedImageUnitsAndFragmentOutputs = 8;
+		resources.maxCombinedShaderOutputResources = 8;
+		resources.maxImageSamples = 0;
+		resources.maxVertexImageUniforms = 0;
+		resources.maxTessControlImageUniforms = 0;
+		resources.maxTessEvaluationImageUniforms = 0;
+		resources.maxGeometryImageUniforms = 0;
+		resources.maxFragmentImageUniforms = 8;
+		resources.maxCombinedImageUniforms = 8;
+		resources.maxGeometryTextureImageUnits = 16;
+		resources.maxGeometryOutputVertices = 256;
+		resources.maxGeometryTotalOutputComponents = 1024;
+		resources.maxGeometryUniformComponents = 1024;
+		resources.maxGeometryVaryingComponents = 64;
+		resources.maxTessControlInputComponents = 128;
+		resources.maxTessControlOutputComponents = 128;
+		resources.maxTessControlTextureImageUnits = 16;
+		resources.maxTessControlUniformComponents = 1024;
+		resources.maxTessControlTotalOutputComponents = 4096;
+		resources.maxTessEvaluationInputComponents = 128;
+		resources.maxTessEvaluationOutputComponents = 128;
+		resources.maxTessEvaluationTextureImageUnits = 16;
+		resources.maxTessEvaluationUniformComponents = 1024;
+		resources.maxTessPatchComponents = 120;
+		resources.maxPatchVertices = 32;
+		resources.maxTessGenLevel = 64;
+		resources.maxViewports = 16;
+		resources.maxVertexAtomicCounters = 0;
+		resources.maxTessControlAtomicCounters = 0;
+		resources.maxTessEvaluationAtomicCounters = 0;
+		resources.maxGeometryAtomicCounters = 0;
+		resources.maxFragmentAtomicCounters = 8;
+		resources.maxCombinedAtomicCounters = 8;
+		resources.maxAtomicCounterBindings = 1;
+		resources.maxVertexAtomicCounterBuffers = 0;
+		resources.maxTessControlAtomicCounterBuffers = 0;
+		resources.maxTessEvaluationAtomicCounterBuffers = 0;
+		resources.maxGeometryAtomicCounterBuffers = 0;
+		resources.maxFragmentAtomicCounterBuffers = 1;
+		resources.maxCombinedAtomicCounterBuffers = 1;
+		resources.maxAtomicCounterBufferSize = 16384;
+		resources.maxTransformFeedbackBuffers = 4;
+		resources.maxTransformFeedbackInterleavedComponents = 64;
+		resources.maxCullDistances = 8;
+		resources.maxCombinedClipAndCullDistances = 8;
+		resources.maxSamples = 4;
+		resources.maxMeshOutputVerticesNV = 256;
+		resources.maxMeshOutputPrimitivesNV = 512;
+		resources.maxMeshWorkGroupSizeX_NV = 32;
+		resources.maxMeshWorkGroupSizeY_NV = 1;
+		resources.maxMeshWorkGroupSizeZ_NV = 1;
+		resources.maxTaskWorkGroupSizeX_NV = 32;
+		resources.maxTaskWorkGroupSizeY_NV = 1;
+		resources.maxTaskWorkGroupSizeZ_NV = 1;
+		resources.maxMeshViewCountNV = 4;
+		resources.maxDualSourceDrawBuffersEXT = 1;
+
+		resources.limits.nonInductiveForLoops = true;
+		resources.limits.whileLoops = true;
+		resources.limits.doWhileLoops = true;
+		resources.limits.generalUniformIndexing = true;
+		resources.limits.generalAttributeMatrixVectorIndexing = true;
+		resources.limits.generalVaryingIndexing = true;
+		resources.limits.generalSamplerIndexing = true;
+		resources.limits.generalVariableIndexing = true;
+		resources.limits.generalConstantMatrixVectorIndexing = true;
+
+		return resources;
+	}
+}
+
+void ShaderCompiler::Initialize(const char* pCacheDirectory, bool compressCache)
+{
+	glslang::InitializeProcess();
+
+	if (pCacheDirectory && mCache.Initialize(pCacheDirectory, compressCache))
+		mDependencyGraph.Load(GetDependencyGraphPath().c_str());
+}
+
+void ShaderCompiler::Terminate()
+{
+	SaveDependencyGraph();
+	glslang::FinalizeProcess();
+}
+
+bool ShaderCompiler::SaveDependencyGraph() const
+{
+	if (!mCache.IsValid())
+		return false;
+
+	return mDependencyGraph.Save(GetDependencyGraphPath().c_str());
+}
+
+ShaderCompileResult ShaderCompiler::Compile(const ShaderCompileInfo& info, ShaderCode* pShaderCode)
+{
+	ShaderCompileResult result = {};
+
+	EShLanguage language = _Helpers::GetLanguage(info.mStage);
+	if (language == EShLangCount)
+	{
+		result.mLog = info.mFile + ": Invalid or undefined shader stage!";
+		return result;
+	}
+
+	// Everything that affects code generation, except the source text.
+	Hasher optionsHasher;
+	{
+		glslang::Version version = glslang::GetVersion();
+
+		optionsHasher.UpdateValue(static_cast<UI32>(SHADER_CACHE_KEY_VERSION));
+		optionsHasher.UpdateValue(version.major);
+		optionsHasher.UpdateValue(version.minor);
+		optionsHasher.UpdateValue(version.patch);
+		optionsHasher.Update(String(version.flavor));
+		optionsHasher.UpdateValue(info.mStage);
+		optionsHasher.UpdateValue(info.mTarget);
+		optionsHasher.Update(info.mEntryPoint);
+
+		for (const auto& define : info.mDefines)
+		{
+			optionsHasher.Update(define.first);
+			optionsHasher.Update(define.second);
+		}
+	}
+
+	// The compile key identifies this source file with these options, the content hash is only known after reading it.
+	const String sourcePath = ShaderDependencyGraph::GetCanonicalPath(info.mFile);
+	Hasher keyHasher = optionsHasher;
+	keyHasher.Update(sourcePath);
+
+	for (const String& directory : info.mIncludeDirectories)
+		keyHasher.Update(directory);
+
+	const UI64 compileKey = keyHasher.GetHash();
+
+	// Incremental path: none of the files this compilation read have changed, so not even the sources are read.
+	if (mDependencyGraph.Lookup(compileKey, &result.mHash) && mCache.Load(result.mHash, info.mStage, pShaderCode))
+	{
+		result.mSuccess = true;
+		result.mCacheHit = true;
+
+		Finalize(info, &result, pShaderCode);
+		return result;
+	}
+
+	// Every file is stamped before it is read. A save in between leaves a stale stamp behind, which only costs a
+	// recompilation, whereas a stamp taken afterwards would tie the new file to the old code.
+	const ShaderFileStamp sourceStamp = ShaderFileStamp::Create(sourcePath);
+
+	String source;
+	if (!_Helpers::ReadTextFile(info.mFile, &source))
+	{
+		result.mLog = info.mFile + ": Failed to open the shader file!";
+		return result;
+	}
+
+	// Build the content address of this compilation.
+	std::map<String, _Helpers::IncludedFile> includes;
+	std::vector<ShaderFileStamp> includeStamps;
+	{
+		Hasher hasher = optionsHasher;
+		_Helpers::HashExpandedSource(source, sourcePath, info.mIncludeDirectories, &hasher, &includes);
+
+		result.mHash = hasher.GetHash();
+		for (const auto& include : includes)
+		{
+			result.mIncludes.push_back(include.first);
+			includeStamps.push_back(include.second.mStamp);
+		}
+	}
+
+	// Warm path: no glslang work at all, and the cached code is used in place.
+	if (mCache.Load(result.mHash, info.mStage, pShaderCode))
+	{
+		mDependencyGraph.Record(compileKey, sourceStamp, includeStamps, result.mHash);
+
+		result.mSuccess = true;
+		result.mCacheHit = true;
+
+		Finalize(info, &result, pShaderCode);
+		return result;
+	}
+
+	String preamble;
+	for (const auto& define : info.mDefines)
+		preamble += "#define " + define.first + " " + define.second + "\n";
+
+	glslang::EShTargetClientVersion clientVersion = glslang::EShTargetVulkan_1_2;
+	glslang::EShTargetLanguageVersion targetVersion = glslang::EShTargetSpv_1_5;
+	switch (info.mTarget)
+	{
+	case ShaderTargetEnvironment::VULKAN_1_0:
+		clientVersion = glslang::EShTargetVulkan_1_0;
+		targetVersion = glslang::EShTargetSpv_1_0;
+		break;
+	case ShaderTargetEnvironment::VULKAN_1_1:
+		clientVersion = glslang::EShTargetVulkan_1_1;
+		targetVersion = glslang::EShTargetSpv_1_3;
+		break;
+	default:
+		break;
+	}
+
+	const char* pSource = source.c_str();
+	const char* pName = sourcePath.c_str();
+	const I32 sourceLength = static_cast<I32>(source.size());
+
+	glslang::TShader shader(language);
+	shader.setStringsWithLengthsAndNames(&pSource, &sourceLength, &pName, 1);
+	shader.setPreamble(preamble.c_str());
+	shader.setEntryPoint(info.mEntryPoint.c_str());
+	shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientVulkan, 100);
+	shader.setEnvClient(glslang::EShClientVulkan, clientVersion);
+	shader.setEnvTarget(glslang::EShTargetSpv, targetVersion);
+
+	const TBuiltInResource resources = _Helpers::GetDefaultResources();
+	const EShMessages messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+
+	_Helpers::FileIncluder includer(info.mIncludeDirectories, includes);
+	if (!shader.parse(&resources, 450, false, messages, includer))
+	{
+		result.mLog = shader.getInfoLog();
+		return result;
+	}
+
+	glslang::TProgram program;
+	program.addShader(&shader);
+	if (!program.link(messages))
+	{
+		result.mLog = program.getInfoLog();
+		return result;
+	}
+
+	std::vector<UI32> code;
+	spv::SpvBuildLogger logger;
+	glslang::GlslangToSpv(*program.getIntermediate(language), code, &logger);
+	result.mLog = shader.getInfoLog() + logger.getAllMessages();
+
+	if (code.empty())
+		return result;
+
+	mCache.Store(result.mHash, code);
+	mDependencyGraph.Record(compileKey, sourceStamp, includeStamps, result.mHash);
+
+	pShaderCode->SetCode(std::move(code), ShaderCodeType::SPIR_V, info.mStage);
+	result.mSuccess = true;
+
+	Finalize(info, &result, pShaderCode);
+	return result;
+}
+
+void ShaderCompiler::Finalize(const ShaderCompileInfo& info, ShaderCompileResult* pResult, ShaderCode* pShaderCode) const
+{
+	ShaderOptimizationResult optimization = ShaderOptimizer::Optimize(pShaderCode, info.mOptimization, info.mTarget, pResult->mHash, mCache.IsValid() ? &mCache : nullptr);
+
+	pResult->mLog += optimization.mLog;
+	pResult->mInstructionCount = optimization.mInstructionCount;
+	pResult->mOptimizedInstructionCount = optimization.mOptimizedInstructionCount;
+
+	// The reflection belongs to the final code, so it is keyed by the hash of whatever the optimizer produced.
+	const UI64 codeHash = optimization.mSuccess ? optimization.mHash : pResult->mHash;
+	ShaderReflection reflection;
+
+	MappedFile cachedFile;
+	if (mCache.MapBlob(codeHash, ".refl", &cachedFile) && reflection.Deserialize(cachedFile.GetData(), cachedFile.GetSize()))
+	{
+		pShaderCode->SetReflection(std::move(reflection));
+		return;
+	}
+
+	String error;
+	if (!ShaderReflector::Reflect(*pShaderCode, &reflection, &error))
+	{
+		pResult->mLog += error + "\n";
+		return;
+	}
+
+	if (mCache.IsValid())
+	{
+		std::vector<BYTE> bytes;
+		reflection.Serialize(&bytes);
+		mCache.StoreBlob(codeHash, ".refl", bytes.data(), bytes.size());
+	}
+
+	pShaderCode->SetReflection(std::move(reflection));
+}
+
+String ShaderCompiler::GetDependencyGraphPath() const
+{
+	return (std::filesystem::path(mCache.GetDirectory()) / "ShaderDependencies.graph").string();
+}
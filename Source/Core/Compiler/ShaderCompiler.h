@@ -0,0 +1,91 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ShaderCache.h"
+#include "ShaderDependencyGraph.h"
+#include "ShaderOptimizer.h"
+#include "ShaderReflector.h"
+
+/**
+ * Shader compile info structure.
+ */
+struct ShaderCompileInfo {
+	String mFile = "";												// GLSL source file.
+	String mEntryPoint = "main";									// Entry point function.
+	std::vector<std::pair<String, String>> mDefines = {};			// Macro name and value pairs.
+	std::vector<String> mIncludeDirectories = {};					// Additional #include search paths.
+	ShaderStage mStage = ShaderStage::UNDEFINED;					// Shader stage.
+	ShaderTargetEnvironment mTarget = ShaderTargetEnvironment::VULKAN_1_2;	// Target environment.
+	ShaderOptimizationLevel mOptimization = ShaderOptimizationLevel::NONE;	// SPIR-V optimization preset.
+};
+
+/**
+ * Shader compile result structure.
+ */
+struct ShaderCompileResult {
+	String mLog = "";							// Compiler diagnostics.
+	std::vector<String> mIncludes = {};			// Every file resolved through #include. Empty if the dependency graph was used.
+	UI64 mHash = 0;								// Content hash used as the cache key.
+	UI32 mInstructionCount = 0;					// SPIR-V instruction count before optimization.
+	UI32 mOptimizedInstructionCount = 0;		// SPIR-V instruction count after optimization.
+	bool mSuccess = false;						// Whether the shader code is usable.
+	bool mCacheHit = false;						// Whether the code was loaded from the cache.
+};
+
+/**
+ * Shader Compiler object.
+ * Compiles GLSL to SPIR-V using glslang. The key of each compilation is the hash of the include expanded
+ * source, stage, defines, target environment and compiler version, so a warm cache never touches glslang.
+ * When a cache directory is used, a dependency graph of the includes is kept next to it so that shaders whose
+ * files did not change are resolved without reading their sources at all.
+ * Successfully compiled code carries its reflection, which is cached alongside the binary.
+ */
+class ShaderCompiler {
+public:
+	ShaderCompiler() {}
+	~ShaderCompiler() {}
+
+	/**
+	 * Initialize the compiler.
+	 *
+	 * @param pCacheDirectory: The cache directory. nullptr disables the cache.
+	 * @param compressCache: Whether new cache entries are compressed with the SPIR-V codec.
+	 */
+	void Initialize(const char* pCacheDirectory = nullptr, bool compressCache = false);
+
+	/**
+	 * Terminate the compiler.
+	 * The dependency graph is saved to the cache directory.
+	 */
+	void Terminate();
+
+	/**
+	 * Save the dependency graph to the cache directory.
+	 *
+	 * @return Boolean value.
+	 */
+	bool SaveDependencyGraph() const;
+
+	/**
+	 * Compile a shader.
+	 * Diagnostics are returned in the result and are never shown to the user by the compiler.
+	 *
+	 * @param info: The compile info.
+	 * @param pShaderCode: The shader code to store the SPIR-V in.
+	 * @return The compile result.
+	 */
+	ShaderCompileResult Compile(const ShaderCompileInfo& info, ShaderCode* pShaderCode);
+
+	const ShaderCache& GetCache() const { return mCache; }
+	const ShaderDependencyGraph& GetDependencyGraph() const { return mDependencyGraph; }
+
+private:
+	void Finalize(const ShaderCompileInfo& info, ShaderCompileResult* pResult, ShaderCode* pShaderCode) const;
+	String GetDependencyGraphPath() const;
+
+private:
+	ShaderCache mCache = {};
+	ShaderDependencyGraph mDependencyGraph = {};
+};
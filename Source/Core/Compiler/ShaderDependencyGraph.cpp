@@ -0,0 +1,235 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderDependencyGraph.h"
+#include "Core/Types/Hasher.h"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#define SHADER_DEPENDENCY_GRAPH_VERSION		1
+
+namespace _Helpers
+{
+	/**
+	 * Parse a hexadecimal token.
+	 *
+	 * @param token: The token.
+	 * @param pValue: The value to store the result in.
+	 * @return Boolean value stating if the whole token was a valid number.
+	 */
+	bool ParseHex(const String& token, UI64* pValue)
+	{
+		const char* pEnd = token.data() + token.size();
+		std::from_chars_result result = std::from_chars(token.data(), pEnd, *pValue, 16);
+		return result.ec == std::errc() && result.ptr == pEnd;
+	}
+}
+
+bool ShaderFileStamp::IsCurrent() const
+{
+	ShaderFileStamp current = Create(mPath);
+	return current.mWriteTime == mWriteTime && current.mSize == mSize;
+}
+
+ShaderFileStamp ShaderFileStamp::Create(const String& path)
+{
+	ShaderFileStamp stamp = {};
+	stamp.mPath = path;
+
+	std::error_code errorCode;
+	auto writeTime = std::filesystem::last_write_time(path, errorCode);
+	if (errorCode)
+		return stamp;
+
+	stamp.mWriteTime = static_cast<I64>(writeTime.time_since_epoch().count());
+	stamp.mSize = static_cast<UI64>(std::filesystem::file_size(path, errorCode));
+	return stamp;
+}
+
+bool ShaderDependencyGraph::Load(const char* pFile)
+{
+	std::ifstream file(pFile);
+	if (!file.is_open())
+		return false;
+
+	String magic;
+	UI32 version = 0;
+	if (!(file >> magic >> version) || magic != "SSDG" || version != SHADER_DEPENDENCY_GRAPH_VERSION)
+		return false;
+
+	std::unordered_map<UI64, Node> nodes;
+	String line;
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		String keyword, key, codeHash;
+		UI64 fileCount = 0;
+		if (!(stream >> keyword) || keyword != "node")
+			continue;
+
+		// A corrupt graph is discarded rather than trusted.
+		UI64 nodeKey = 0;
+		Node node = {};
+		if (!(stream >> key >> codeHash >> fileCount) || !_Helpers::ParseHex(key, &nodeKey) || !_Helpers::ParseHex(codeHash, &node.mCodeHash))
+			return false;
+
+		for (UI64 i = 0; i < fileCount; i++)
+		{
+			if (!std::getline(file, line))
+				return false;
+
+			// The path is the rest of the line so that it may contain spaces.
+			std::istringstream fileStream(line);
+			ShaderFileStamp stamp = {};
+			if (!(fileStream >> stamp.mWriteTime >> stamp.mSize))
+				return false;
+
+			fileStream.get();
+			std::getline(fileStream, stamp.mPath);
+			node.mFiles.push_back(std::move(stamp));
+		}
+
+		if (node.mFiles.empty())
+			return false;
+
+		node.mSource = node.mFiles.front().mPath;
+		nodes[nodeKey] = std::move(node);
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mNodes = std::move(nodes);
+	mDependents.clear();
+
+	for (const auto& node : mNodes)
+		Link(node.second);
+
+	return true;
+}
+
+bool ShaderDependencyGraph::Save(const char* pFile) const
+{
+	std::stringstream temporaryPath;
+	temporaryPath << pFile << "." << std::this_thread::get_id() << ".tmp";
+
+	{
+		std::ofstream file(temporaryPath.str(), std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		file << "SSDG " << SHADER_DEPENDENCY_GRAPH_VERSION << "\n";
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (const auto& node : mNodes)
+		{
+			file << "node " << Hasher::ToString(node.first) << " " << Hasher::ToString(node.second.mCodeHash) << " " << node.second.mFiles.size() << "\n";
+
+			for (const ShaderFileStamp& stamp : node.second.mFiles)
+				file << stamp.mWriteTime << " " << stamp.mSize << " " << stamp.mPath << "\n";
+		}
+
+		if (!file)
+			return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryPath.str(), pFile, errorCode);
+
+	if (errorCode)
+	{
+		std::filesystem::remove(temporaryPath.str(), errorCode);
+		return false;
+	}
+
+	return true;
+}
+
+void ShaderDependencyGraph::Record(UI64 compileKey, const ShaderFileStamp& source, const std::vector<ShaderFileStamp>& includes, UI64 codeHash)
+{
+	Node node = {};
+	node.mSource = source.mPath;
+	node.mCodeHash = codeHash;
+	node.mFiles.push_back(source);
+	node.mFiles.insert(node.mFiles.end(), includes.begin(), includes.end());
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto itr = mNodes.find(compileKey);
+	if (itr != mNodes.end())
+	{
+		Unlink(itr->second);
+		itr->second = std::move(node);
+		Link(itr->second);
+	}
+	else
+		Link(mNodes[compileKey] = std::move(node));
+}
+
+bool ShaderDependencyGraph::Lookup(UI64 compileKey, UI64* pCodeHash) const
+{
+	Node node = {};
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		auto itr = mNodes.find(compileKey);
+		if (itr == mNodes.end())
+			return false;
+
+		node = itr->second;
+	}
+
+	// Stat the files outside the lock so that other workers are not blocked on the file system.
+	for (const ShaderFileStamp& stamp : node.mFiles)
+		if (!stamp.IsCurrent())
+			return false;
+
+	*pCodeHash = node.mCodeHash;
+	return true;
+}
+
+std::vector<String> ShaderDependencyGraph::GetDependents(const String& file) const
+{
+	std::vector<String> dependents;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto itr = mDependents.find(GetCanonicalPath(file));
+	if (itr == mDependents.end())
+		return dependents;
+
+	for (const auto& dependent : itr->second)
+		dependents.push_back(dependent.first);
+
+	return dependents;
+}
+
+String ShaderDependencyGraph::GetCanonicalPath(const String& path)
+{
+	std::error_code errorCode;
+	std::filesystem::path canonical = std::filesystem::weakly_canonical(path, errorCode);
+	return errorCode ? path : canonical.string();
+}
+
+void ShaderDependencyGraph::Link(const Node& node)
+{
+	for (const ShaderFileStamp& stamp : node.mFiles)
+		mDependents[stamp.mPath][node.mSource]++;
+}
+
+void ShaderDependencyGraph::Unlink(const Node& node)
+{
+	for (const ShaderFileStamp& stamp : node.mFiles)
+	{
+		auto itr = mDependents.find(stamp.mPath);
+		if (itr == mDependents.end())
+			continue;
+
+		if (--itr->second[node.mSource] == 0)
+			itr->second.erase(node.mSource);
+
+		if (itr->second.empty())
+			mDependents.erase(itr);
+	}
+}
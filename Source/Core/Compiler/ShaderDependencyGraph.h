@@ -0,0 +1,118 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <mutex>
+#include <map>
+
+/**
+ * Shader file stamp structure.
+ * Identifies the on disk state of a file without reading it.
+ */
+struct ShaderFileStamp {
+	String mPath = "";
+	I64 mWriteTime = 0;
+	UI64 mSize = 0;
+
+	/**
+	 * Check if the file still has the recorded state.
+	 *
+	 * @return Boolean value.
+	 */
+	bool IsCurrent() const;
+
+	/**
+	 * Create a stamp of a file.
+	 *
+	 * @param path: The file path.
+	 * @return The file stamp.
+	 */
+	static ShaderFileStamp Create(const String& path);
+};
+
+/**
+ * Shader Dependency Graph object.
+ * Records which files each compilation read and keeps the reverse graph from every included file to the
+ * shader sources depending on it. All the methods are thread safe.
+ */
+class ShaderDependencyGraph {
+	/**
+	 * Compilation node structure.
+	 */
+	struct Node {
+		String mSource = "";
+		std::vector<ShaderFileStamp> mFiles = {};	// The source followed by all of its transitive includes.
+		UI64 mCodeHash = 0;
+	};
+
+public:
+	ShaderDependencyGraph() {}
+	~ShaderDependencyGraph() {}
+
+	/**
+	 * Load the graph from a file.
+	 *
+	 * @param pFile: The file path.
+	 * @return Boolean value stating if the file was loaded.
+	 */
+	bool Load(const char* pFile);
+
+	/**
+	 * Save the graph to a file.
+	 * The file is replaced atomically.
+	 *
+	 * @param pFile: The file path.
+	 * @return Boolean value.
+	 */
+	bool Save(const char* pFile) const;
+
+	/**
+	 * Record a compilation.
+	 * The stamps must be taken before the files were read, so a file saved while compiling is seen as changed.
+	 *
+	 * @param compileKey: The key identifying the source and its compile options.
+	 * @param source: The stamp of the shader source, with its canonical path.
+	 * @param includes: The stamps of every file the source included, with their canonical paths.
+	 * @param codeHash: The content hash of the compiled code.
+	 */
+	void Record(UI64 compileKey, const ShaderFileStamp& source, const std::vector<ShaderFileStamp>& includes, UI64 codeHash);
+
+	/**
+	 * Look up the content hash of a compilation.
+	 * This only succeeds if none of the files it depends on have changed since it was recorded.
+	 *
+	 * @param compileKey: The key identifying the source and its compile options.
+	 * @param pCodeHash: The variable to store the content hash.
+	 * @return Boolean value.
+	 */
+	bool Lookup(UI64 compileKey, UI64* pCodeHash) const;
+
+	/**
+	 * Get the shader sources affected by a change to a file.
+	 * The file itself is included if it is a shader source.
+	 *
+	 * @param file: The changed file.
+	 * @return The sorted canonical paths of the affected sources.
+	 */
+	std::vector<String> GetDependents(const String& file) const;
+
+	/**
+	 * Get the canonical form of a path as used by the graph.
+	 *
+	 * @param path: The path.
+	 * @return The canonical path.
+	 */
+	static String GetCanonicalPath(const String& path);
+
+private:
+	void Link(const Node& node);
+	void Unlink(const Node& node);
+
+private:
+	std::unordered_map<UI64, Node> mNodes;
+	std::unordered_map<String, std::map<String, UI32>> mDependents;	// File to dependent sources and their node counts.
+	mutable std::mutex mMutex;
+};
@@ -0,0 +1,127 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderHotReloader.h"
+
+#include <set>
+
+bool ShaderHotReloader::Initialize(const char* pCacheDirectory, UI32 debounceMilliseconds)
+{
+	mCompiler.Initialize(pCacheDirectory);
+
+	// Leave a core for the render loop.
+	mThreadPool.Initialize(std::max(std::thread::hardware_concurrency(), 2U) - 1);
+
+	mIsInitialized = mFileWatcher.Initialize([this](const std::vector<String>& files) { OnFilesChanged(files); }, debounceMilliseconds);
+	return mIsInitialized;
+}
+
+void ShaderHotReloader::Terminate()
+{
+	if (!mIsInitialized)
+		return;
+
+	// Stop the events first so that no new work is submitted while the pool drains.
+	mFileWatcher.Terminate();
+	mThreadPool.Terminate();
+	mCompiler.Terminate();
+
+	mShaders.clear();
+	mReadyShaders.clear();
+	mIsInitialized = false;
+}
+
+bool ShaderHotReloader::WatchDirectory(const char* pDirectory)
+{
+	return mFileWatcher.AddDirectory(pDirectory);
+}
+
+UI64 ShaderHotReloader::Register(const ShaderCompileInfo& info)
+{
+	RegisteredShader shader = {};
+	shader.mInfo = info;
+	shader.mSourcePath = ShaderDependencyGraph::GetCanonicalPath(info.mFile);
+
+	std::lock_guard<std::mutex> lock(mShaderMutex);
+	mShaders[mNextHandle] = std::move(shader);
+	return mNextHandle++;
+}
+
+void ShaderHotReloader::Unregister(UI64 handle)
+{
+	std::lock_guard<std::mutex> lock(mShaderMutex);
+	mShaders.erase(handle);
+}
+
+bool ShaderHotReloader::Poll(std::vector<ShaderReload>* pReloads)
+{
+	if (!mHasReadyShaders)
+		return false;
+
+	std::unique_lock<std::mutex> lock(mReadyMutex, std::try_to_lock);
+	if (!lock.owns_lock())
+		return false;
+
+	for (auto itr = mReadyShaders.begin(); itr != mReadyShaders.end(); itr++)
+		pReloads->push_back(std::move(*itr));
+
+	mReadyShaders.clear();
+	mHasReadyShaders = false;
+	return true;
+}
+
+void ShaderHotReloader::OnFilesChanged(const std::vector<String>& files)
+{
+	// Sources affected through includes, plus the changed files themselves in case they were never compiled.
+	std::set<String> affectedSources;
+	for (const String& file : files)
+	{
+		affectedSources.insert(ShaderDependencyGraph::GetCanonicalPath(file));
+
+		for (const String& dependent : mCompiler.GetDependencyGraph().GetDependents(file))
+			affectedSources.insert(dependent);
+	}
+
+	std::lock_guard<std::mutex> lock(mShaderMutex);
+	for (auto& shader : mShaders)
+	{
+		if (affectedSources.find(shader.second.mSourcePath) == affectedSources.end())
+			continue;
+
+		const UI64 handle = shader.first;
+		const UI64 generation = ++shader.second.mGeneration;
+		ShaderCompileInfo info = shader.second.mInfo;
+
+		mThreadPool.Submit([this, handle, generation, info] { Recompile(handle, generation, info); });
+	}
+}
+
+void ShaderHotReloader::Recompile(UI64 handle, UI64 generation, const ShaderCompileInfo& info)
+{
+	ShaderReload reload = {};
+	reload.mHandle = handle;
+	reload.mResult = mCompiler.Compile(info, &reload.mCode);
+
+	// Drop the result if the shader was unregistered or changed again while compiling.
+	{
+		std::lock_guard<std::mutex> lock(mShaderMutex);
+		auto itr = mShaders.find(handle);
+		if (itr == mShaders.end() || itr->second.mGeneration != generation)
+			return;
+	}
+
+	std::lock_guard<std::mutex> lock(mReadyMutex);
+
+	// Only the newest result of a shader is kept.
+	for (auto itr = mReadyShaders.begin(); itr != mReadyShaders.end(); itr++)
+	{
+		if (itr->mHandle == handle)
+		{
+			*itr = std::move(reload);
+			return;
+		}
+	}
+
+	mReadyShaders.push_back(std::move(reload));
+	mHasReadyShaders = true;
+}
@@ -0,0 +1,105 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ShaderCompiler.h"
+#include "Core/FileSystem/FileWatcher.h"
+#include "Core/Threading/ThreadPool.h"
+
+/**
+ * Shader reload structure.
+ * A recompiled shader handed over to the render loop.
+ */
+struct ShaderReload {
+	UI64 mHandle = 0;					// Handle returned when the shader was registered.
+	ShaderCode mCode = {};
+	ShaderCompileResult mResult = {};
+};
+
+/**
+ * Shader Hot Reloader object.
+ * Watches shader directories and recompiles every registered shader affected by a change on worker threads.
+ * Finished shaders are queued for the render loop, which collects them with Poll without ever waiting.
+ */
+class ShaderHotReloader {
+public:
+	ShaderHotReloader() {}
+	~ShaderHotReloader() {}
+
+	/**
+	 * Initialize the reloader.
+	 *
+	 * @param pCacheDirectory: The compile cache directory. nullptr disables the cache.
+	 * @param debounceMilliseconds: The quiet period to wait for after a burst of file events.
+	 * @return Boolean value.
+	 */
+	bool Initialize(const char* pCacheDirectory = nullptr, UI32 debounceMilliseconds = 30);
+
+	/**
+	 * Terminate the reloader.
+	 */
+	void Terminate();
+
+	/**
+	 * Watch a directory for shader and include changes.
+	 *
+	 * @param pDirectory: The directory.
+	 * @return Boolean value.
+	 */
+	bool WatchDirectory(const char* pDirectory);
+
+	/**
+	 * Register a shader to be recompiled when it or any of its includes change.
+	 *
+	 * @param info: The compile info.
+	 * @return The handle of the shader.
+	 */
+	UI64 Register(const ShaderCompileInfo& info);
+
+	/**
+	 * Unregister a shader.
+	 *
+	 * @param handle: The handle of the shader.
+	 */
+	void Unregister(UI64 handle);
+
+	/**
+	 * Collect the shaders which finished recompiling.
+	 * This never blocks; if a worker is publishing at the same time the shaders are collected next call.
+	 *
+	 * @param pReloads: The vector to append the reloaded shaders to.
+	 * @return Boolean value stating if anything was collected.
+	 */
+	bool Poll(std::vector<ShaderReload>* pReloads);
+
+	ShaderCompiler& GetCompiler() { return mCompiler; }
+
+private:
+	void OnFilesChanged(const std::vector<String>& files);
+	void Recompile(UI64 handle, UI64 generation, const ShaderCompileInfo& info);
+
+private:
+	/**
+	 * Registered shader structure.
+	 */
+	struct RegisteredShader {
+		ShaderCompileInfo mInfo = {};
+		String mSourcePath = "";
+		UI64 mGeneration = 0;		// Incremented on every change so that stale results are dropped.
+	};
+
+	ShaderCompiler mCompiler = {};
+	FileWatcher mFileWatcher = {};
+	ThreadPool mThreadPool = {};
+
+	std::unordered_map<UI64, RegisteredShader> mShaders;
+	std::mutex mShaderMutex;
+	UI64 mNextHandle = 1;
+
+	std::vector<ShaderReload> mReadyShaders;
+	std::mutex mReadyMutex;
+	std::atomic<bool> mHasReadyShaders = false;
+
+	bool mIsInitialized = false;
+};
@@ -0,0 +1,87 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderOptimizer.h"
+#include "Core/Types/Hasher.h"
+
+#include <spirv-tools/optimizer.hpp>
+
+/**
+ * Number of words in the SPIR-V module header.
+ */
+#define SPIRV_HEADER_WORD_COUNT		5
+
+ShaderOptimizationResult ShaderOptimizer::Optimize(ShaderCode* pShaderCode, ShaderOptimizationLevel level, ShaderTargetEnvironment target, UI64 inputHash, const ShaderCache* pCache)
+{
+	ShaderOptimizationResult result = {};
+	result.mInstructionCount = CountInstructions(pShaderCode->GetCode(), pShaderCode->GetWordCount());
+	result.mOptimizedInstructionCount = result.mInstructionCount;
+
+	if (level == ShaderOptimizationLevel::NONE || pShaderCode->GetType() != ShaderCodeType::SPIR_V)
+		return result;
+
+	// The vendored SPIRV-Tools only understands SPIR-V up to 1.3 (Vulkan 1.1).
+	spv_target_env environment = SPV_ENV_VULKAN_1_1;
+	if (target == ShaderTargetEnvironment::VULKAN_1_0)
+		environment = SPV_ENV_VULKAN_1_0;
+	else if (target == ShaderTargetEnvironment::VULKAN_1_2)
+	{
+		result.mLog = "SPIR-V optimization skipped: Vulkan 1.2 (SPIR-V 1.5) targets are not supported by SPIRV-Tools.\n";
+		return result;
+	}
+
+	Hasher hasher;
+	hasher.Update(String(spvSoftwareVersionString()));
+	hasher.UpdateValue(inputHash);
+	hasher.UpdateValue(level);
+	hasher.UpdateValue(environment);
+	result.mHash = hasher.GetHash();
+
+	if (pCache && pCache->Load(result.mHash, pShaderCode->GetStage(), pShaderCode))
+	{
+		result.mOptimizedInstructionCount = CountInstructions(pShaderCode->GetCode(), pShaderCode->GetWordCount());
+		result.mSuccess = true;
+		result.mCacheHit = true;
+		return result;
+	}
+
+	spvtools::Optimizer optimizer(environment);
+	optimizer.SetMessageConsumer([&result](spv_message_level_t, const char*, const spv_position_t& position, const char* pMessage)
+		{
+			result.mLog += "SPIR-V optimizer (word " + std::to_string(position.index) + "): " + pMessage + "\n";
+		});
+
+	if (level == ShaderOptimizationLevel::SIZE)
+		optimizer.RegisterSizePasses();
+	else
+		optimizer.RegisterPerformancePasses();
+
+	std::vector<UI32> optimizedCode;
+	if (!optimizer.Run(pShaderCode->GetCode(), static_cast<size_t>(pShaderCode->GetWordCount()), &optimizedCode) || optimizedCode.empty())
+		return result;
+
+	if (pCache)
+		pCache->Store(result.mHash, optimizedCode);
+
+	result.mOptimizedInstructionCount = CountInstructions(optimizedCode.data(), optimizedCode.size());
+	result.mSuccess = true;
+
+	pShaderCode->SetCode(std::move(optimizedCode), ShaderCodeType::SPIR_V, pShaderCode->GetStage());
+	return result;
+}
+
+UI32 ShaderOptimizer::CountInstructions(const UI32* pCode, UI64 wordCount)
+{
+	UI32 instructionCount = 0;
+	for (UI64 index = SPIRV_HEADER_WORD_COUNT; index < wordCount; instructionCount++)
+	{
+		// The high half of the first word of every instruction is its word count.
+		const UI32 instructionWordCount = pCode[index] >> 16;
+		if (instructionWordCount == 0)
+			break;
+
+		index += instructionWordCount;
+	}
+
+	return instructionCount;
+}
@@ -0,0 +1,70 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ShaderCache.h"
+#include "Core/Objects/ShaderCode.h"
+
+/**
+ * Target environment of the compiled SPIR-V.
+ */
+enum class ShaderTargetEnvironment : UI8 {
+	VULKAN_1_0,
+	VULKAN_1_1,
+	VULKAN_1_2,
+};
+
+/**
+ * Shader optimization level enum.
+ */
+enum class ShaderOptimizationLevel : UI8 {
+	NONE,
+	PERFORMANCE,
+	SIZE,
+};
+
+/**
+ * Shader optimization result structure.
+ */
+struct ShaderOptimizationResult {
+	String mLog = "";						// Optimizer diagnostics.
+	UI64 mHash = 0;							// Cache key of the optimized code.
+	UI32 mInstructionCount = 0;				// Instruction count of the input.
+	UI32 mOptimizedInstructionCount = 0;	// Instruction count of the output.
+	bool mSuccess = false;					// Whether the shader code was replaced with the optimized code.
+	bool mCacheHit = false;					// Whether the optimized code was loaded from the cache.
+};
+
+/**
+ * Shader Optimizer object.
+ * Runs the SPIRV-Tools optimizer over compiled SPIR-V. The output is cached under the hash of the input
+ * code hash, level and target, so an unchanged shader is only optimized once.
+ */
+class ShaderOptimizer {
+public:
+	ShaderOptimizer() {}
+	~ShaderOptimizer() {}
+
+	/**
+	 * Optimize shader code in place.
+	 * The code is left untouched if the level is NONE or the optimizer fails.
+	 *
+	 * @param pShaderCode: The SPIR-V shader code.
+	 * @param level: The optimization level.
+	 * @param target: The target environment of the code.
+	 * @param inputHash: The content hash of the input code.
+	 * @param pCache: The cache to use. nullptr to always optimize.
+	 * @return The optimization result.
+	 */
+	static ShaderOptimizationResult Optimize(ShaderCode* pShaderCode, ShaderOptimizationLevel level, ShaderTargetEnvironment target, UI64 inputHash, const ShaderCache* pCache);
+
+	/**
+	 * Count the instructions of a SPIR-V module.
+	 *
+	 * @param pCode: The code words.
+	 * @param wordCount: The number of words.
+	 * @return The instruction count.
+	 */
+	static UI32 CountInstructions(const UI32* pCode, UI64 wordCount);
+};
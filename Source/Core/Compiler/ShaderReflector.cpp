@@ -0,0 +1,212 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderReflector.h"
+
+#include <spirv_cross.hpp>
+#include <algorithm>
+
+namespace _Helpers
+{
+	/**
+	 * Get the default size of an array sized by a specialization constant.
+	 *
+	 * @param compiler: The SPIRV-Cross compiler.
+	 * @param id: The ID of the constant sizing the array.
+	 * @return The default value of the constant. 0 if it is an expression which cannot be evaluated here.
+	 */
+	UI32 GetSpecializedArraySize(const spirv_cross::Compiler& compiler, UI32 id)
+	{
+		try
+		{
+			return compiler.get_constant(id).scalar();
+		}
+		catch (const spirv_cross::CompilerError&)
+		{
+			// OpSpecConstantOp sizes are only known once the pipeline specializes them.
+			return 0;
+		}
+	}
+
+	/**
+	 * Add the descriptor bindings of a resource list.
+	 *
+	 * @param compiler: The SPIRV-Cross compiler.
+	 * @param resources: The resources.
+	 * @param type: The descriptor type of the resources.
+	 * @param pBindings: The vector to append the bindings to.
+	 */
+	void AddDescriptorBindings(const spirv_cross::Compiler& compiler, const spirv_cross::SmallVector<spirv_cross::Resource>& resources, ShaderResourceType type, std::vector<ShaderDescriptorBinding>* pBindings)
+	{
+		for (const spirv_cross::Resource& resource : resources)
+		{
+			const spirv_cross::SPIRType& spirType = compiler.get_type(resource.type_id);
+
+			ShaderDescriptorBinding binding = {};
+			binding.mName = resource.name;
+			binding.mSet = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+			binding.mBinding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+			binding.mType = type;
+
+			// Buffer images are texel buffers, not images.
+			if (spirType.basetype == spirv_cross::SPIRType::Image || spirType.basetype == spirv_cross::SPIRType::SampledImage)
+			{
+				if (spirType.image.dim == spv::DimBuffer)
+				{
+					if (type == ShaderResourceType::STORAGE_IMAGE)
+						binding.mType = ShaderResourceType::STORAGE_TEXEL_BUFFER;
+					else
+						binding.mType = ShaderResourceType::UNIFORM_TEXEL_BUFFER;
+				}
+			}
+
+			// Multi dimensional arrays are flattened. A runtime array has a count of 0.
+			for (UI64 i = 0; i < spirType.array.size(); i++)
+			{
+				if (spirType.array_size_literal[i])
+					binding.mCount *= spirType.array[i];
+				else
+				{
+					binding.mCount *= GetSpecializedArraySize(compiler, spirType.array[i]);
+					binding.mIsSpecializationSized = true;
+				}
+			}
+
+			pBindings->push_back(std::move(binding));
+		}
+	}
+
+	/**
+	 * Get the attribute type of a SPIR-V base type.
+	 *
+	 * @param baseType: The base type.
+	 * @return The attribute type.
+	 */
+	ShaderAttributeType GetAttributeType(spirv_cross::SPIRType::BaseType baseType)
+	{
+		switch (baseType)
+		{
+		case spirv_cross::SPIRType::Int:
+			return ShaderAttributeType::SIGNED_INT;
+
+		case spirv_cross::SPIRType::UInt:
+			return ShaderAttributeType::UNSIGNED_INT;
+
+		case spirv_cross::SPIRType::Half:
+			return ShaderAttributeType::HALF_FLOAT;
+
+		case spirv_cross::SPIRType::Float:
+			return ShaderAttributeType::FLOAT;
+
+		case spirv_cross::SPIRType::Double:
+			return ShaderAttributeType::DOUBLE;
+
+		default:
+			return ShaderAttributeType::UNDEFINED;
+		}
+	}
+}
+
+bool ShaderReflector::Reflect(const ShaderCode& shaderCode, ShaderReflection* pReflection, String* pError)
+{
+	pReflection->Clear();
+
+	if (shaderCode.GetType() != ShaderCodeType::SPIR_V || shaderCode.IsEmpty())
+	{
+		if (pError)
+			*pError = "Only SPIR-V code can be reflected!";
+
+		return false;
+	}
+
+	try
+	{
+		spirv_cross::Compiler compiler(shaderCode.GetCode(), static_cast<size_t>(shaderCode.GetWordCount()));
+
+		// Only the resources the entry point actually uses end up in the layout.
+		auto activeVariables = compiler.get_active_interface_variables();
+		spirv_cross::ShaderResources resources = compiler.get_shader_resources(activeVariables);
+
+		std::vector<ShaderDescriptorBinding>& bindings = pReflection->mDescriptorBindings;
+		_Helpers::AddDescriptorBindings(compiler, resources.uniform_buffers, ShaderResourceType::UNIFORM_BUFFER, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.storage_buffers, ShaderResourceType::STORAGE_BUFFER, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.sampled_images, ShaderResourceType::COMBINED_IMAGE_SAMPLER, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.separate_images, ShaderResourceType::SAMPLED_IMAGE, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.storage_images, ShaderResourceType::STORAGE_IMAGE, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.separate_samplers, ShaderResourceType::SAMPLER, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.subpass_inputs, ShaderResourceType::INPUT_ATTACHMENT, &bindings);
+		_Helpers::AddDescriptorBindings(compiler, resources.acceleration_structures, ShaderResourceType::ACCELERATION_STRUCTURE, &bindings);
+
+		std::sort(bindings.begin(), bindings.end(), [](const ShaderDescriptorBinding& lhs, const ShaderDescriptorBinding& rhs)
+			{
+				return lhs.mSet < rhs.mSet || (lhs.mSet == rhs.mSet && lhs.mBinding < rhs.mBinding);
+			});
+
+		// The range covers the members the shader uses, not the whole block.
+		for (const spirv_cross::Resource& resource : resources.push_constant_buffers)
+		{
+			auto ranges = compiler.get_active_buffer_ranges(resource.id);
+			if (ranges.empty())
+				continue;
+
+			UI64 begin = ranges.front().offset, end = 0;
+			for (const spirv_cross::BufferRange& range : ranges)
+			{
+				begin = std::min<UI64>(begin, range.offset);
+				end = std::max<UI64>(end, range.offset + range.range);
+			}
+
+			ShaderPushConstantRange pushConstant = {};
+			pushConstant.mOffset = static_cast<UI32>(begin);
+			pushConstant.mSize = static_cast<UI32>(end - begin);
+			pReflection->mPushConstantRanges.push_back(pushConstant);
+		}
+
+		if (shaderCode.GetStage() == ShaderStage::VERTEX)
+		{
+			for (const spirv_cross::Resource& resource : resources.stage_inputs)
+			{
+				if (compiler.has_decoration(resource.id, spv::DecorationBuiltIn))
+					continue;
+
+				const spirv_cross::SPIRType& spirType = compiler.get_type(resource.type_id);
+
+				ShaderVertexInput input = {};
+				input.mName = resource.name;
+				input.mLocation = compiler.get_decoration(resource.id, spv::DecorationLocation);
+				input.mComponentCount = static_cast<UI8>(spirType.vecsize);
+				input.mColumnCount = static_cast<UI8>(spirType.columns);
+				input.mType = _Helpers::GetAttributeType(spirType.basetype);
+				pReflection->mVertexInputs.push_back(std::move(input));
+			}
+
+			std::sort(pReflection->mVertexInputs.begin(), pReflection->mVertexInputs.end(), [](const ShaderVertexInput& lhs, const ShaderVertexInput& rhs)
+				{
+					return lhs.mLocation < rhs.mLocation;
+				});
+		}
+
+		for (const spirv_cross::SpecializationConstant& constant : compiler.get_specialization_constants())
+		{
+			const spirv_cross::SPIRType& spirType = compiler.get_type(compiler.get_constant(constant.id).constant_type);
+
+			ShaderSpecializationConstant specialization = {};
+			specialization.mName = compiler.get_name(constant.id);
+			specialization.mConstantID = constant.constant_id;
+			specialization.mSize = spirType.basetype == spirv_cross::SPIRType::Boolean ? sizeof(UI32) : spirType.width / 8;	// Booleans are VkBool32.
+			pReflection->mSpecializationConstants.push_back(std::move(specialization));
+		}
+	}
+	catch (const spirv_cross::CompilerError& error)
+	{
+		pReflection->Clear();
+
+		if (pError)
+			*pError = String("SPIR-V reflection failed: ") + error.what();
+
+		return false;
+	}
+
+	pReflection->mIsValid = true;
+	return true;
+}
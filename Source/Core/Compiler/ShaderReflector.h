@@ -0,0 +1,27 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Objects/ShaderCode.h"
+
+/**
+ * Shader Reflector object.
+ * Extracts the resource interface of SPIR-V modules using SPIRV-Cross.
+ */
+class ShaderReflector {
+public:
+	ShaderReflector() {}
+	~ShaderReflector() {}
+
+	/**
+	 * Reflect a SPIR-V module.
+	 * Descriptor bindings are sorted by set and binding, vertex inputs by location.
+	 *
+	 * @param shaderCode: The SPIR-V code.
+	 * @param pReflection: The reflection to fill.
+	 * @param pError: The string to store the error in, if any.
+	 * @return Boolean value.
+	 */
+	static bool Reflect(const ShaderCode& shaderCode, ShaderReflection* pReflection, String* pError = nullptr);
+};
@@ -0,0 +1,153 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderVariantSet.h"
+#include "Core/Types/Utilities.h"
+#include "Core/ErrorHandler/Logger.h"
+
+bool ShaderVariantSet::Initialize(ShaderCompiler* pCompiler, ThreadPool* pThreadPool, const ShaderCompileInfo& info, const std::vector<String>& features, ShaderFeatureMask fallbackMask)
+{
+	if (features.size() > SHADER_MAX_FEATURES)
+	{
+		Logger::LogError(TEXT("A shader variant set can not have more than 64 features!"));
+		return false;
+	}
+
+	this->pCompiler = pCompiler;
+	this->pThreadPool = pThreadPool;
+	mInfo = info;
+	mFeatures = features;
+	mFallbackMask = GetValidMask(fallbackMask);
+
+	std::unique_ptr<ShaderVariant> fallback = std::make_unique<ShaderVariant>();
+	fallback->mResult = pCompiler->Compile(GetCompileInfo(mFallbackMask), &fallback->mCode);
+	fallback->mState = fallback->mResult.mSuccess ? ShaderVariantState::READY : ShaderVariantState::FAILED;
+
+	if (!fallback->mResult.mSuccess)
+		Logger::LogError(StringToWString(fallback->mResult.mLog).c_str());
+
+	pFallback = fallback.get();
+	mVariants[mFallbackMask] = std::move(fallback);
+	return pFallback->mState == ShaderVariantState::READY;
+}
+
+void ShaderVariantSet::Terminate()
+{
+	std::unique_lock<std::mutex> lock(mVariantMutex);
+	mIdleCondition.wait(lock, [this] { return mCompilingVariants == 0; });
+
+	mVariants.clear();
+	pFallback = nullptr;
+}
+
+const ShaderCode& ShaderVariantSet::GetVariant(ShaderFeatureMask mask, bool* pIsExact)
+{
+	ShaderVariant* pVariant = FindOrRequest(mask);
+	const bool isReady = pVariant && pVariant->mState.load(std::memory_order_acquire) == ShaderVariantState::READY;
+
+	if (pIsExact)
+		*pIsExact = isReady;
+
+	return isReady ? pVariant->mCode : pFallback->mCode;
+}
+
+void ShaderVariantSet::Request(ShaderFeatureMask mask)
+{
+	FindOrRequest(mask);
+}
+
+ShaderVariantState ShaderVariantSet::GetState(ShaderFeatureMask mask) const
+{
+	ShaderVariant* pVariant = Find(mask);
+	if (!pVariant)
+		return ShaderVariantState::UNREQUESTED;
+
+	return pVariant->mState.load(std::memory_order_acquire);
+}
+
+bool ShaderVariantSet::GetResult(ShaderFeatureMask mask, ShaderCompileResult* pResult) const
+{
+	ShaderVariant* pVariant = Find(mask);
+	if (!pVariant)
+		return false;
+
+	ShaderVariantState state = pVariant->mState.load(std::memory_order_acquire);
+	if (state != ShaderVariantState::READY && state != ShaderVariantState::FAILED)
+		return false;
+
+	*pResult = pVariant->mResult;
+	return true;
+}
+
+ShaderFeatureMask ShaderVariantSet::GetFeatureMask(const String& name) const
+{
+	for (UI64 i = 0; i < mFeatures.size(); i++)
+		if (mFeatures[i] == name)
+			return ShaderFeatureMask(1) << i;
+
+	return 0;
+}
+
+ShaderVariantSet::ShaderVariant* ShaderVariantSet::FindOrRequest(ShaderFeatureMask mask)
+{
+	mask = GetValidMask(mask);
+
+	ShaderVariant* pVariant = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mVariantMutex);
+		std::unique_ptr<ShaderVariant>& variant = mVariants[mask];
+		if (variant)
+			return variant.get();
+
+		variant = std::make_unique<ShaderVariant>();
+		variant->mState = ShaderVariantState::COMPILING;
+		pVariant = variant.get();
+		mCompilingVariants++;
+	}
+
+	pThreadPool->Submit([this, pVariant, info = GetCompileInfo(mask)]
+		{
+			pVariant->mResult = pCompiler->Compile(info, &pVariant->mCode);
+			pVariant->mState.store(pVariant->mResult.mSuccess ? ShaderVariantState::READY : ShaderVariantState::FAILED, std::memory_order_release);
+
+			if (!pVariant->mResult.mSuccess)
+				Logger::LogError(StringToWString(pVariant->mResult.mLog).c_str());
+
+			std::lock_guard<std::mutex> lock(mVariantMutex);
+			mCompilingVariants--;
+			mIdleCondition.notify_all();
+		});
+
+	return pVariant;
+}
+
+ShaderVariantSet::ShaderVariant* ShaderVariantSet::Find(ShaderFeatureMask mask) const
+{
+	mask = GetValidMask(mask);
+
+	std::lock_guard<std::mutex> lock(mVariantMutex);
+	auto itr = mVariants.find(mask);
+	if (itr == mVariants.end())
+		return nullptr;
+
+	return itr->second.get();
+}
+
+ShaderCompileInfo ShaderVariantSet::GetCompileInfo(ShaderFeatureMask mask) const
+{
+	ShaderCompileInfo info = mInfo;
+	for (UI64 i = 0; i < mFeatures.size(); i++)
+		if (mask & (ShaderFeatureMask(1) << i))
+			info.mDefines.push_back({ mFeatures[i], "1" });
+
+	return info;
+}
+
+ShaderFeatureMask ShaderVariantSet::GetValidMask(ShaderFeatureMask mask) const
+{
+	// Bits without a feature would create duplicate variants of the same code.
+	if (mFeatures.size() < SHADER_MAX_FEATURES)
+		mask &= (ShaderFeatureMask(1) << mFeatures.size()) - 1;
+
+	return mask;
+}
@@ -0,0 +1,132 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ShaderCompiler.h"
+#include "Core/Threading/ThreadPool.h"
+
+#define SHADER_MAX_FEATURES		64
+
+/**
+ * Shader feature mask.
+ * Bit i enables the i-th feature define of a variant set.
+ */
+typedef UI64 ShaderFeatureMask;
+
+/**
+ * Shader variant state enum.
+ */
+enum class ShaderVariantState : UI8 {
+	UNREQUESTED,
+	COMPILING,
+	READY,
+	FAILED
+};
+
+/**
+ * Shader Variant Set object.
+ * The permutations of one shader over a list of feature defines. Variants are compiled the first time they
+ * are requested, on a worker thread, and the fallback variant is handed out until they are ready. Only the
+ * fallback is compiled up front, so startup does not pay for combinations which are never drawn.
+ */
+class ShaderVariantSet {
+public:
+	ShaderVariantSet() {}
+	~ShaderVariantSet() { Terminate(); }
+
+	/**
+	 * Initialize the variant set.
+	 * The fallback variant is compiled on the calling thread.
+	 *
+	 * @param pCompiler: The compiler used for every variant. Must outlive the set.
+	 * @param pThreadPool: The pool to compile the variants on. Must outlive the set.
+	 * @param info: The compile info shared by every variant.
+	 * @param features: The feature defines. A feature is defined to 1 when its bit is set and left undefined otherwise.
+	 * @param fallbackMask: The features of the fallback variant.
+	 * @return Boolean value stating if the fallback variant compiled.
+	 */
+	bool Initialize(ShaderCompiler* pCompiler, ThreadPool* pThreadPool, const ShaderCompileInfo& info, const std::vector<String>& features, ShaderFeatureMask fallbackMask = 0);
+
+	/**
+	 * Terminate the variant set.
+	 * Waits for the variants which are still compiling.
+	 */
+	void Terminate();
+
+	/**
+	 * Get a variant.
+	 * Requests the variant if it was not requested before. This never blocks on a compilation.
+	 *
+	 * @param mask: The features of the variant.
+	 * @param pIsExact: The variable to store whether the requested variant was returned, rather than the fallback. Optional.
+	 * @return The variant if it is ready, the fallback variant otherwise.
+	 */
+	const ShaderCode& GetVariant(ShaderFeatureMask mask, bool* pIsExact = nullptr);
+
+	/**
+	 * Request a variant to be compiled in the background without using it yet.
+	 *
+	 * @param mask: The features of the variant.
+	 */
+	void Request(ShaderFeatureMask mask);
+
+	/**
+	 * Get the state of a variant.
+	 *
+	 * @param mask: The features of the variant.
+	 * @return The state.
+	 */
+	ShaderVariantState GetState(ShaderFeatureMask mask) const;
+
+	/**
+	 * Get the compile result of a finished variant.
+	 *
+	 * @param mask: The features of the variant.
+	 * @param pResult: The result to fill.
+	 * @return Boolean value stating if the variant finished compiling.
+	 */
+	bool GetResult(ShaderFeatureMask mask, ShaderCompileResult* pResult) const;
+
+	/**
+	 * Get the mask of a feature.
+	 *
+	 * @param name: The name of the feature define.
+	 * @return The mask. 0 if the feature does not belong to the set.
+	 */
+	ShaderFeatureMask GetFeatureMask(const String& name) const;
+
+	const std::vector<String>& GetFeatures() const { return mFeatures; }
+	ShaderFeatureMask GetFallbackMask() const { return mFallbackMask; }
+
+private:
+	/**
+	 * Shader variant structure.
+	 * The code and result are written once by the compiling thread before the state is published.
+	 */
+	struct ShaderVariant {
+		ShaderCode mCode = {};
+		ShaderCompileResult mResult = {};
+		std::atomic<ShaderVariantState> mState = ShaderVariantState::UNREQUESTED;
+	};
+
+	ShaderVariant* FindOrRequest(ShaderFeatureMask mask);
+	ShaderVariant* Find(ShaderFeatureMask mask) const;
+	ShaderCompileInfo GetCompileInfo(ShaderFeatureMask mask) const;
+	ShaderFeatureMask GetValidMask(ShaderFeatureMask mask) const;
+
+private:
+	ShaderCompileInfo mInfo = {};
+	std::vector<String> mFeatures;
+
+	std::unordered_map<ShaderFeatureMask, std::unique_ptr<ShaderVariant>> mVariants;
+	mutable std::mutex mVariantMutex;
+
+	std::condition_variable mIdleCondition;
+	UI32 mCompilingVariants = 0;	// Guarded by the variant mutex.
+
+	ShaderCompiler* pCompiler = nullptr;
+	ThreadPool* pThreadPool = nullptr;
+	ShaderVariant* pFallback = nullptr;
+	ShaderFeatureMask mFallbackMask = 0;
+};
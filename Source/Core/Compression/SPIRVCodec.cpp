@@ -0,0 +1,436 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SPIRVCodec.h"
+#include "Core/Objects/ShaderCode.h"
+
+#define SPV_ENABLE_UTILITY_CODE
+#include <spirv.hpp>
+
+#include <cstring>
+
+#define SPIRV_CODEC_MODE_RAW		0
+#define SPIRV_CODEC_MODE_SPIRV		1
+#define SPIRV_HEADER_WORD_COUNT		5
+
+namespace _Helpers
+{
+	/**
+	 * SPIR-V codec stream enum.
+	 */
+	enum SPIRVStream : UI8 {
+		SPIRV_STREAM_OPCODE,
+		SPIRV_STREAM_WORD_COUNT,
+		SPIRV_STREAM_RESULT_TYPE,
+		SPIRV_STREAM_RESULT,
+		SPIRV_STREAM_ID,
+		SPIRV_STREAM_LITERAL,
+		SPIRV_STREAM_STRING,
+		SPIRV_STREAM_COUNT
+	};
+
+	/**
+	 * SPIR-V opcode layout structure.
+	 * The operand pattern maps each operand after the result to a stream: 'i' ID, 'l' literal, 's' string.
+	 * The last character repeats for the remaining operands.
+	 */
+	struct SPIRVOpcodeLayout {
+		const char* pPattern = "l";
+		UI8 mPatternLength = 1;
+		bool mHasResultType = false;
+		bool mHasResult = false;
+	};
+
+	/**
+	 * SPIR-V opcode layout table.
+	 * The patterns only steer words into the stream which compresses them best; a wrong guess costs size, never correctness.
+	 */
+	class SPIRVOpcodeLayoutTable {
+	public:
+		SPIRVOpcodeLayoutTable()
+		{
+			for (UI32 opcode = 0; opcode < LayoutCount; opcode++)
+				spv::HasResultAndType(static_cast<spv::Op>(opcode), &mLayouts[opcode].mHasResult, &mLayouts[opcode].mHasResultType);
+
+			// Operations whose operands are all IDs.
+			SetRange(spv::OpConvertFToU, spv::OpBitcast, "i");
+			SetRange(spv::OpSNegate, spv::OpSMulExtended, "i");
+			SetRange(spv::OpAny, spv::OpFUnordGreaterThanEqual, "i");
+			SetRange(spv::OpShiftRightLogical, spv::OpBitCount, "i");
+			SetRange(spv::OpDPdx, spv::OpFwidthCoarse, "i");
+			SetRange(spv::OpAtomicLoad, spv::OpAtomicXor, "i");
+			SetRange(spv::OpControlBarrier, spv::OpMemoryBarrier, "i");
+			SetRange(spv::OpTypeSampledImage, spv::OpTypeRuntimeArray, "i");
+			SetRange(spv::OpAccessChain, spv::OpPtrAccessChain, "i");
+			SetRange(spv::OpVectorExtractDynamic, spv::OpVectorInsertDynamic, "i");
+			SetRange(spv::OpCopyObject, spv::OpTranspose, "i");
+			SetRange(spv::OpPhi, spv::OpPhi, "i");
+			SetRange(spv::OpBranch, spv::OpBranchConditional, "i");
+			SetRange(spv::OpReturnValue, spv::OpReturnValue, "i");
+			SetRange(spv::OpTypeStruct, spv::OpTypeStruct, "i");
+			SetRange(spv::OpTypeFunction, spv::OpTypeFunction, "i");
+			SetRange(spv::OpConstantComposite, spv::OpConstantComposite, "i");
+			SetRange(spv::OpSpecConstantComposite, spv::OpSpecConstantComposite, "i");
+			SetRange(spv::OpFunctionCall, spv::OpFunctionCall, "i");
+			SetRange(spv::OpCompositeConstruct, spv::OpCompositeConstruct, "i");
+			SetRange(spv::OpSampledImage, spv::OpSampledImage, "i");
+			SetRange(spv::OpImage, spv::OpImageQuerySamples, "i");
+
+			// Mixed operations.
+			SetRange(spv::OpLoad, spv::OpLoad, "il");
+			SetRange(spv::OpStore, spv::OpStore, "iil");
+			SetRange(spv::OpTypeVector, spv::OpTypeMatrix, "il");
+			SetRange(spv::OpTypeImage, spv::OpTypeImage, "il");
+			SetRange(spv::OpTypePointer, spv::OpTypePointer, "li");
+			SetRange(spv::OpVariable, spv::OpVariable, "li");
+			SetRange(spv::OpFunction, spv::OpFunction, "li");
+			SetRange(spv::OpDecorate, spv::OpMemberDecorate, "il");
+			SetRange(spv::OpExecutionMode, spv::OpExecutionMode, "il");
+			SetRange(spv::OpSelectionMerge, spv::OpSelectionMerge, "il");
+			SetRange(spv::OpLoopMerge, spv::OpLoopMerge, "iil");
+			SetRange(spv::OpCompositeExtract, spv::OpCompositeExtract, "il");
+			SetRange(spv::OpCompositeInsert, spv::OpCompositeInsert, "iil");
+			SetRange(spv::OpVectorShuffle, spv::OpVectorShuffle, "iil");
+			SetRange(spv::OpExtInst, spv::OpExtInst, "ili");
+			SetRange(spv::OpSwitch, spv::OpSwitch, "iil");
+			SetRange(spv::OpLine, spv::OpLine, "il");
+			SetRange(spv::OpImageSampleImplicitLod, spv::OpImageSampleExplicitLod, "iili");
+			SetRange(spv::OpImageSampleDrefImplicitLod, spv::OpImageSampleDrefExplicitLod, "iiili");
+			SetRange(spv::OpImageSampleProjImplicitLod, spv::OpImageSampleProjExplicitLod, "iili");
+			SetRange(spv::OpImageSampleProjDrefImplicitLod, spv::OpImageSampleProjDrefExplicitLod, "iiili");
+			SetRange(spv::OpImageFetch, spv::OpImageFetch, "iili");
+			SetRange(spv::OpImageGather, spv::OpImageDrefGather, "iiili");
+			SetRange(spv::OpImageRead, spv::OpImageRead, "iili");
+			SetRange(spv::OpImageWrite, spv::OpImageWrite, "iiili");
+
+			// Literal strings are kept as raw words.
+			SetRange(spv::OpSourceExtension, spv::OpSourceExtension, "s");
+			SetRange(spv::OpName, spv::OpName, "is");
+			SetRange(spv::OpMemberName, spv::OpMemberName, "ils");
+			SetRange(spv::OpString, spv::OpString, "s");
+			SetRange(spv::OpExtension, spv::OpExtInstImport, "s");
+			SetRange(spv::OpEntryPoint, spv::OpEntryPoint, "lis");
+			SetRange(spv::OpModuleProcessed, spv::OpModuleProcessed, "s");
+		}
+
+		/**
+		 * Get the layout of an opcode.
+		 *
+		 * @param opcode: The opcode.
+		 * @return The layout.
+		 */
+		SPIRVOpcodeLayout Get(UI32 opcode) const
+		{
+			if (opcode < LayoutCount)
+				return mLayouts[opcode];
+
+			SPIRVOpcodeLayout layout = {};
+			spv::HasResultAndType(static_cast<spv::Op>(opcode), &layout.mHasResult, &layout.mHasResultType);
+			return layout;
+		}
+
+	private:
+		void SetRange(spv::Op first, spv::Op last, const char* pPattern)
+		{
+			for (UI32 opcode = first; opcode <= static_cast<UI32>(last); opcode++)
+			{
+				mLayouts[opcode].pPattern = pPattern;
+				mLayouts[opcode].mPatternLength = static_cast<UI8>(std::strlen(pPattern));
+			}
+		}
+
+	private:
+		static constexpr UI32 LayoutCount = 512;
+		SPIRVOpcodeLayout mLayouts[LayoutCount] = {};
+	};
+
+	const SPIRVOpcodeLayoutTable& GetOpcodeLayoutTable()
+	{
+		static const SPIRVOpcodeLayoutTable table;
+		return table;
+	}
+
+	/**
+	 * Get the stream of an operand.
+	 *
+	 * @param layout: The opcode layout.
+	 * @param index: The index of the operand after the result.
+	 * @return The stream.
+	 */
+	SPIRVStream GetOperandStream(const SPIRVOpcodeLayout& layout, UI64 index)
+	{
+		const char kind = layout.pPattern[index < layout.mPatternLength ? index : layout.mPatternLength - 1];
+		if (kind == 'i')
+			return SPIRV_STREAM_ID;
+		else if (kind == 's')
+			return SPIRV_STREAM_STRING;
+
+		return SPIRV_STREAM_LITERAL;
+	}
+
+	UI32 ZigZagEncode(UI32 value) { return (value << 1) ^ static_cast<UI32>(static_cast<I32>(value) >> 31); }
+	UI32 ZigZagDecode(UI32 value) { return (value >> 1) ^ (0U - (value & 1)); }
+
+	void WriteVarint(std::vector<BYTE>* pStream, UI32 value)
+	{
+		while (value >= 0x80)
+		{
+			pStream->push_back(static_cast<BYTE>(value | 0x80));
+			value >>= 7;
+		}
+
+		pStream->push_back(static_cast<BYTE>(value));
+	}
+
+	void WriteWord(std::vector<BYTE>* pStream, UI32 value)
+	{
+		const BYTE* pValue = reinterpret_cast<const BYTE*>(&value);
+		pStream->insert(pStream->end(), pValue, pValue + sizeof(UI32));
+	}
+
+	/**
+	 * Byte reader structure.
+	 * Reads fail once the stream is exhausted; the failure is sticky so a decode loop checks once per instruction.
+	 */
+	struct ByteReader {
+		const BYTE* pBegin = nullptr;
+		const BYTE* pEnd = nullptr;
+		bool mFailed = false;
+
+		UI32 ReadVarint()
+		{
+			UI32 value = 0;
+			for (UI32 shift = 0; shift < 35; shift += 7)
+			{
+				if (pBegin == pEnd)
+				{
+					mFailed = true;
+					return 0;
+				}
+
+				const BYTE byte = *pBegin++;
+				value |= static_cast<UI32>(byte & 0x7F) << shift;
+
+				if (!(byte & 0x80))
+					return value;
+			}
+
+			mFailed = true;
+			return 0;
+		}
+
+		UI32 ReadWord()
+		{
+			if (pEnd - pBegin < static_cast<I64>(sizeof(UI32)))
+			{
+				mFailed = true;
+				return 0;
+			}
+
+			UI32 value = 0;
+			std::memcpy(&value, pBegin, sizeof(UI32));
+			pBegin += sizeof(UI32);
+			return value;
+		}
+	};
+
+	/**
+	 * Check if a module can be split into instructions.
+	 *
+	 * @param pCode: The code words.
+	 * @param wordCount: The number of words.
+	 * @return Boolean value.
+	 */
+	bool IsWellFormed(const UI32* pCode, UI64 wordCount)
+	{
+		if (wordCount < SPIRV_HEADER_WORD_COUNT || pCode[0] != SPIRV_MAGIC_NUMBER)
+			return false;
+
+		const SPIRVOpcodeLayoutTable& table = GetOpcodeLayoutTable();
+		for (UI64 index = SPIRV_HEADER_WORD_COUNT; index < wordCount;)
+		{
+			const UI32 instructionWordCount = pCode[index] >> 16;
+			const SPIRVOpcodeLayout layout = table.Get(pCode[index] & 0xFFFF);
+
+			if (instructionWordCount < 1U + layout.mHasResultType + layout.mHasResult || instructionWordCount > wordCount - index)
+				return false;
+
+			index += instructionWordCount;
+		}
+
+		return true;
+	}
+}
+
+void SPIRVCodec::Encode(const UI32* pCode, UI64 wordCount, std::vector<BYTE>* pEncoded)
+{
+	_Helpers::WriteWord(pEncoded, SPIRV_CODEC_MAGIC);
+	_Helpers::WriteVarint(pEncoded, static_cast<UI32>(wordCount));
+
+	if (!_Helpers::IsWellFormed(pCode, wordCount))
+	{
+		pEncoded->push_back(SPIRV_CODEC_MODE_RAW);
+		pEncoded->insert(pEncoded->end(), reinterpret_cast<const BYTE*>(pCode), reinterpret_cast<const BYTE*>(pCode + wordCount));
+		return;
+	}
+
+	pEncoded->push_back(SPIRV_CODEC_MODE_SPIRV);
+	for (UI64 i = 0; i < SPIRV_HEADER_WORD_COUNT; i++)
+		_Helpers::WriteWord(pEncoded, pCode[i]);
+
+	std::vector<BYTE> streams[_Helpers::SPIRV_STREAM_COUNT];
+	const _Helpers::SPIRVOpcodeLayoutTable& table = _Helpers::GetOpcodeLayoutTable();
+
+	UI32 instructionCount = 0;
+	UI32 previousResult = 0;
+	for (UI64 index = SPIRV_HEADER_WORD_COUNT; index < wordCount; instructionCount++)
+	{
+		const UI32 opcode = pCode[index] & 0xFFFF;
+		const UI32 instructionWordCount = pCode[index] >> 16;
+		const _Helpers::SPIRVOpcodeLayout layout = table.Get(opcode);
+
+		_Helpers::WriteVarint(&streams[_Helpers::SPIRV_STREAM_OPCODE], opcode);
+		_Helpers::WriteVarint(&streams[_Helpers::SPIRV_STREAM_WORD_COUNT], instructionWordCount);
+
+		UI64 word = index + 1;
+		if (layout.mHasResultType)
+			_Helpers::WriteVarint(&streams[_Helpers::SPIRV_STREAM_RESULT_TYPE], pCode[word++]);
+
+		// Results are mostly allocated in order, so the delta to the next expected ID is usually 0.
+		if (layout.mHasResult)
+		{
+			_Helpers::WriteVarint(&streams[_Helpers::SPIRV_STREAM_RESULT], _Helpers::ZigZagEncode(pCode[word] - (previousResult + 1)));
+			previousResult = pCode[word++];
+		}
+
+		for (UI64 operand = 0; word < index + instructionWordCount; word++, operand++)
+		{
+			const _Helpers::SPIRVStream stream = _Helpers::GetOperandStream(layout, operand);
+			if (stream == _Helpers::SPIRV_STREAM_ID)
+				_Helpers::WriteVarint(&streams[stream], _Helpers::ZigZagEncode(previousResult - pCode[word]));
+			else if (stream == _Helpers::SPIRV_STREAM_STRING)
+				_Helpers::WriteWord(&streams[stream], pCode[word]);
+			else
+				_Helpers::WriteVarint(&streams[stream], pCode[word]);
+		}
+
+		index += instructionWordCount;
+	}
+
+	_Helpers::WriteVarint(pEncoded, instructionCount);
+	for (const std::vector<BYTE>& stream : streams)
+		_Helpers::WriteVarint(pEncoded, static_cast<UI32>(stream.size()));
+
+	for (const std::vector<BYTE>& stream : streams)
+		pEncoded->insert(pEncoded->end(), stream.begin(), stream.end());
+}
+
+bool SPIRVCodec::Decode(const BYTE* pEncoded, UI64 size, std::vector<UI32>* pCode)
+{
+	_Helpers::ByteReader reader = { pEncoded, pEncoded + size };
+	if (reader.ReadWord() != SPIRV_CODEC_MAGIC)
+		return false;
+
+	const UI32 wordCount = reader.ReadVarint();
+	if (reader.mFailed || reader.pBegin == reader.pEnd)
+		return false;
+
+	const BYTE mode = *reader.pBegin++;
+	if (mode == SPIRV_CODEC_MODE_RAW)
+	{
+		if (static_cast<UI64>(reader.pEnd - reader.pBegin) != static_cast<UI64>(wordCount) * sizeof(UI32))
+			return false;
+
+		// An empty module has no storage to copy into.
+		pCode->resize(wordCount);
+		if (wordCount == 0)
+			return true;
+
+		std::memcpy(pCode->data(), reader.pBegin, static_cast<UI64>(wordCount) * sizeof(UI32));
+		return true;
+	}
+
+	// Every word takes at least one encoded byte, which bounds the allocation for corrupt input.
+	if (mode != SPIRV_CODEC_MODE_SPIRV || wordCount < SPIRV_HEADER_WORD_COUNT || wordCount > size)
+		return false;
+
+	pCode->resize(wordCount);
+	UI32* pWords = pCode->data();
+	for (UI64 i = 0; i < SPIRV_HEADER_WORD_COUNT; i++)
+		pWords[i] = reader.ReadWord();
+
+	const UI32 instructionCount = reader.ReadVarint();
+
+	UI32 streamSizes[_Helpers::SPIRV_STREAM_COUNT] = {};
+	for (UI32& streamSize : streamSizes)
+		streamSize = reader.ReadVarint();
+
+	if (reader.mFailed)
+		return false;
+
+	_Helpers::ByteReader streams[_Helpers::SPIRV_STREAM_COUNT] = {};
+	for (UI64 i = 0; i < _Helpers::SPIRV_STREAM_COUNT; i++)
+	{
+		if (static_cast<UI64>(reader.pEnd - reader.pBegin) < streamSizes[i])
+			return false;
+
+		streams[i] = { reader.pBegin, reader.pBegin + streamSizes[i] };
+		reader.pBegin += streamSizes[i];
+	}
+
+	const _Helpers::SPIRVOpcodeLayoutTable& table = _Helpers::GetOpcodeLayoutTable();
+
+	UI64 index = SPIRV_HEADER_WORD_COUNT;
+	UI32 previousResult = 0;
+	for (UI32 instruction = 0; instruction < instructionCount; instruction++)
+	{
+		const UI32 opcode = streams[_Helpers::SPIRV_STREAM_OPCODE].ReadVarint();
+		const UI32 instructionWordCount = streams[_Helpers::SPIRV_STREAM_WORD_COUNT].ReadVarint();
+		const _Helpers::SPIRVOpcodeLayout layout = table.Get(opcode);
+
+		if (opcode > 0xFFFF || instructionWordCount > 0xFFFF || instructionWordCount < 1U + layout.mHasResultType + layout.mHasResult
+			|| instructionWordCount > wordCount - index)
+			return false;
+
+		UI64 word = index;
+		pWords[word++] = (instructionWordCount << 16) | opcode;
+
+		if (layout.mHasResultType)
+			pWords[word++] = streams[_Helpers::SPIRV_STREAM_RESULT_TYPE].ReadVarint();
+
+		if (layout.mHasResult)
+		{
+			previousResult = _Helpers::ZigZagDecode(streams[_Helpers::SPIRV_STREAM_RESULT].ReadVarint()) + previousResult + 1;
+			pWords[word++] = previousResult;
+		}
+
+		for (UI64 operand = 0; word < index + instructionWordCount; word++, operand++)
+		{
+			const _Helpers::SPIRVStream stream = _Helpers::GetOperandStream(layout, operand);
+			if (stream == _Helpers::SPIRV_STREAM_ID)
+				pWords[word] = previousResult - _Helpers::ZigZagDecode(streams[stream].ReadVarint());
+			else if (stream == _Helpers::SPIRV_STREAM_STRING)
+				pWords[word] = streams[stream].ReadWord();
+			else
+				pWords[word] = streams[stream].ReadVarint();
+		}
+
+		index += instructionWordCount;
+	}
+
+	for (const _Helpers::ByteReader& stream : streams)
+		if (stream.mFailed || stream.pBegin != stream.pEnd)
+			return false;
+
+	return index == wordCount;
+}
+
+bool SPIRVCodec::IsEncoded(const BYTE* pData, UI64 size)
+{
+	UI32 magic = 0;
+	if (size < sizeof(UI32))
+		return false;
+
+	std::memcpy(&magic, pData, sizeof(UI32));
+	return magic == SPIRV_CODEC_MAGIC;
+}
@@ -0,0 +1,50 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#define SPIRV_CODEC_MAGIC		0x5A565053	// "SPVZ"
+
+/**
+ * SPIR-V Codec object.
+ * Lossless compression for SPIR-V modules. Instructions are split into separate streams (opcodes, word counts,
+ * result types, result IDs, ID operands, literals and strings) and every word is stored as a variable length
+ * integer. Result IDs are stored as deltas to the previous result and ID operands relative to it, which turns
+ * most words into a single byte. Input which is not well formed SPIR-V is stored raw, so any word stream
+ * round-trips bit exact.
+ */
+class SPIRVCodec {
+public:
+	SPIRVCodec() {}
+	~SPIRVCodec() {}
+
+	/**
+	 * Encode a SPIR-V module.
+	 *
+	 * @param pCode: The code words.
+	 * @param wordCount: The number of words.
+	 * @param pEncoded: The vector to append the encoded bytes to.
+	 */
+	static void Encode(const UI32* pCode, UI64 wordCount, std::vector<BYTE>* pEncoded);
+
+	/**
+	 * Decode an encoded module.
+	 *
+	 * @param pEncoded: The encoded bytes.
+	 * @param size: The number of encoded bytes.
+	 * @param pCode: The vector to store the decoded words in.
+	 * @return Boolean value stating if the input was a valid encoded module.
+	 */
+	static bool Decode(const BYTE* pEncoded, UI64 size, std::vector<UI32>* pCode);
+
+	/**
+	 * Check if a block of bytes is an encoded module.
+	 *
+	 * @param pData: The bytes.
+	 * @param size: The number of bytes.
+	 * @return Boolean value.
+	 */
+	static bool IsEncoded(const BYTE* pData, UI64 size);
+};
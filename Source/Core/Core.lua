@@ -24,10 +24,24 @@ project "Core"
 
 	includedirs {
 		"$(SolutionDir)Source/",
+		"%{IncludeDir.glslang}",
+		"%{IncludeDir.SPIRVTools}",
+		"%{IncludeDir.SPIRVCross}",
 	}
 
 	libdirs {
+		"%{IncludeLib.glslang}",
+		"%{IncludeLib.SPIRVTools}",
 	}
 
 	links { 
+		"glslang",
+		"MachineIndependent",
+		"GenericCodeGen",
+		"OGLCompiler",
+		"OSDependent",
+		"SPIRV",
+		"SPIRV-Tools-opt",
+		"SPIRV-Tools",
+		"SPIRV-Cross",
 	}
\ No newline at end of file
@@ -0,0 +1,240 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FileWatcher.h"
+
+#include <chrono>
+#include <filesystem>
+#include <set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define WATCH_EVENT_MASK	(IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF)
+
+#endif // __linux__
+
+bool FileWatcher::Initialize(std::function<void(const std::vector<String>&)>&& callback, UI32 debounceMilliseconds)
+{
+	mCallback = std::move(callback);
+	mDebounceMilliseconds = debounceMilliseconds;
+	mShouldStop = false;
+
+#ifdef __linux__
+	mDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	mWakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (mDescriptor < 0 || mWakeDescriptor < 0)
+	{
+		Terminate();
+		return false;
+	}
+
+#endif // __linux__
+
+	mThread = std::thread(&FileWatcher::WatcherLoop, this);
+	return true;
+}
+
+void FileWatcher::Terminate()
+{
+	mShouldStop = true;
+
+#ifdef __linux__
+	if (mWakeDescriptor >= 0)
+	{
+		UI64 value = 1;
+		write(mWakeDescriptor, &value, sizeof(value));
+	}
+
+#endif // __linux__
+
+	if (mThread.joinable())
+		mThread.join();
+
+#ifdef __linux__
+	if (mDescriptor >= 0)
+		close(mDescriptor);
+
+	if (mWakeDescriptor >= 0)
+		close(mWakeDescriptor);
+
+	mDescriptor = -1;
+	mWakeDescriptor = -1;
+	mWatchDescriptors.clear();
+
+#endif // __linux__
+}
+
+bool FileWatcher::AddDirectory(const char* pDirectory)
+{
+	std::error_code errorCode;
+	if (!std::filesystem::is_directory(pDirectory, errorCode))
+		return false;
+
+	const String root = std::filesystem::weakly_canonical(pDirectory, errorCode).string();
+
+#ifdef __linux__
+	// inotify is not recursive, so every sub directory needs its own watch.
+	std::vector<String> directories = { root };
+	for (auto itr = std::filesystem::recursive_directory_iterator(root, errorCode); !errorCode && itr != std::filesystem::recursive_directory_iterator(); itr.increment(errorCode))
+		if (itr->is_directory())
+			directories.push_back(itr->path().string());
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (const String& directory : directories)
+	{
+		I32 watch = inotify_add_watch(mDescriptor, directory.c_str(), WATCH_EVENT_MASK);
+		if (watch < 0)
+			return false;
+
+		mWatchDescriptors[watch] = directory;
+	}
+
+#else
+	std::lock_guard<std::mutex> lock(mMutex);
+	mDirectories.push_back(root);
+
+	// Seed the write times so that existing files are not reported as changed.
+	std::vector<String> changes;
+	PollChanges(&changes);
+
+#endif // __linux__
+
+	return true;
+}
+
+void FileWatcher::WatcherLoop()
+{
+	std::set<String> pendingChanges;
+	auto lastEvent = std::chrono::steady_clock::now();
+
+	while (!mShouldStop)
+	{
+		std::vector<String> changes;
+
+#ifdef __linux__
+		I32 timeout = -1;
+		if (!pendingChanges.empty())
+		{
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastEvent).count();
+			timeout = static_cast<I32>(std::max<I64>(static_cast<I64>(mDebounceMilliseconds) - elapsed, 0));
+		}
+
+		pollfd descriptors[2] = {
+			{ mDescriptor, POLLIN, 0 },
+			{ mWakeDescriptor, POLLIN, 0 }
+		};
+
+		if (poll(descriptors, 2, timeout) < 0)
+			continue;
+
+		if (descriptors[0].revents & POLLIN)
+			PollChanges(&changes);
+
+#else
+		std::this_thread::sleep_for(std::chrono::milliseconds(std::max(mDebounceMilliseconds, 10U)));
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			PollChanges(&changes);
+		}
+
+#endif // __linux__
+
+		if (!changes.empty())
+		{
+			pendingChanges.insert(changes.begin(), changes.end());
+			lastEvent = std::chrono::steady_clock::now();
+			continue;
+		}
+
+		// Deliver once the burst has settled.
+		if (!pendingChanges.empty()
+			&& std::chrono::steady_clock::now() - lastEvent >= std::chrono::milliseconds(mDebounceMilliseconds))
+		{
+			mCallback(std::vector<String>(pendingChanges.begin(), pendingChanges.end()));
+			pendingChanges.clear();
+		}
+	}
+}
+
+void FileWatcher::PollChanges(std::vector<String>* pChanges)
+{
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+
+	while (true)
+	{
+		ssize_t length = read(mDescriptor, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;
+
+		for (char* pPointer = buffer; pPointer < buffer + length; pPointer += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(pPointer)->len)
+		{
+			const inotify_event* pEvent = reinterpret_cast<inotify_event*>(pPointer);
+
+			String directory;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				auto itr = mWatchDescriptors.find(pEvent->wd);
+				if (itr == mWatchDescriptors.end())
+					continue;
+
+				if (pEvent->mask & (IN_DELETE_SELF | IN_IGNORED))
+				{
+					mWatchDescriptors.erase(itr);
+					continue;
+				}
+
+				directory = itr->second;
+			}
+
+			if (!pEvent->len)
+				continue;
+
+			String path = directory + "/" + pEvent->name;
+
+			// Newly created directories need to be watched as well.
+			if (pEvent->mask & IN_ISDIR)
+			{
+				if (pEvent->mask & (IN_CREATE | IN_MOVED_TO))
+					AddDirectory(path.c_str());
+
+				continue;
+			}
+
+			// A plain create is followed by a close write, which is what gets reported.
+			if (pEvent->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				pChanges->push_back(std::move(path));
+		}
+	}
+
+#else
+	std::error_code errorCode;
+	for (const String& directory : mDirectories)
+	{
+		for (auto itr = std::filesystem::recursive_directory_iterator(directory, errorCode); !errorCode && itr != std::filesystem::recursive_directory_iterator(); itr.increment(errorCode))
+		{
+			if (!itr->is_regular_file())
+				continue;
+
+			const String path = itr->path().string();
+			const I64 writeTime = static_cast<I64>(itr->last_write_time(errorCode).time_since_epoch().count());
+
+			auto entry = mWriteTimes.find(path);
+			if (entry == mWriteTimes.end())
+				mWriteTimes[path] = writeTime;
+			else if (entry->second != writeTime)
+			{
+				entry->second = writeTime;
+				pChanges->push_back(path);
+			}
+		}
+	}
+
+#endif // __linux__
+}
@@ -0,0 +1,67 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * File Watcher object.
+ * Watches directories for modified files on a background thread. Bursts of events (editors usually write,
+ * rename and touch a file in one save) are coalesced and delivered once the directories have been quiet for
+ * the debounce period. Uses inotify on Linux and falls back to polling write times elsewhere.
+ */
+class FileWatcher {
+public:
+	FileWatcher() {}
+	~FileWatcher() { Terminate(); }
+
+	/**
+	 * Initialize the watcher and start the watcher thread.
+	 *
+	 * @param callback: The function called on the watcher thread with the sorted, unique changed files.
+	 * @param debounceMilliseconds: The quiet period to wait before delivering the changes.
+	 * @return Boolean value.
+	 */
+	bool Initialize(std::function<void(const std::vector<String>&)>&& callback, UI32 debounceMilliseconds = 30);
+
+	/**
+	 * Stop the watcher thread.
+	 */
+	void Terminate();
+
+	/**
+	 * Watch a directory and its sub directories.
+	 *
+	 * @param pDirectory: The directory.
+	 * @return Boolean value.
+	 */
+	bool AddDirectory(const char* pDirectory);
+
+private:
+	void WatcherLoop();
+	void PollChanges(std::vector<String>* pChanges);
+
+private:
+	std::function<void(const std::vector<String>&)> mCallback;
+	std::thread mThread;
+	std::mutex mMutex;
+	std::atomic<bool> mShouldStop = false;
+	UI32 mDebounceMilliseconds = 30;
+
+#ifdef __linux__
+	std::unordered_map<I32, String> mWatchDescriptors;
+	I32 mDescriptor = -1;
+	I32 mWakeDescriptor = -1;
+
+#else
+	std::vector<String> mDirectories;
+	std::unordered_map<String, I64> mWriteTimes;
+
+#endif // __linux__
+};
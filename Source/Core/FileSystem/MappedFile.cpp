@@ -0,0 +1,116 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif // _WIN32
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: pData(other.pData), mSize(other.mSize)
+{
+	other.pData = nullptr;
+	other.mSize = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+
+		pData = other.pData;
+		mSize = other.mSize;
+
+		other.pData = nullptr;
+		other.mSize = 0;
+	}
+
+	return *this;
+}
+
+bool MappedFile::Open(const char* pFile)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(pFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(hFile);
+
+	if (!hMapping)
+		return false;
+
+	// The view keeps the mapping alive, so the handle is not needed after this.
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+
+	if (!pView)
+		return false;
+
+	pData = static_cast<const BYTE*>(pView);
+	mSize = static_cast<UI64>(size.QuadPart);
+
+#else
+	I32 descriptor = open(pFile, O_RDONLY | O_CLOEXEC);
+	if (descriptor < 0)
+		return false;
+
+	struct stat status = {};
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+	{
+		close(descriptor);
+		return false;
+	}
+
+	// The mapping holds its own reference to the file, so the descriptor is not needed after this.
+	void* pView = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+
+	if (pView == MAP_FAILED)
+		return false;
+
+	madvise(pView, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+
+	pData = static_cast<const BYTE*>(pView);
+	mSize = static_cast<UI64>(status.st_size);
+
+#endif // _WIN32
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (!pData)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(pData);
+
+#else
+	munmap(const_cast<BYTE*>(pData), static_cast<size_t>(mSize));
+
+#endif // _WIN32
+
+	pData = nullptr;
+	mSize = 0;
+}
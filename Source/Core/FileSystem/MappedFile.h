@@ -0,0 +1,45 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+/**
+ * Mapped File object.
+ * Maps a whole file read-only into the address space. The mapping is page aligned so any 32 bit word
+ * data in the file (like SPIR-V) can be read in place without copying it to the heap.
+ */
+class MappedFile {
+public:
+	MappedFile() {}
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/**
+	 * Map a file.
+	 * Any previous mapping is released first.
+	 *
+	 * @param pFile: The file path.
+	 * @return Boolean value stating if the file was mapped. Empty files can not be mapped.
+	 */
+	bool Open(const char* pFile);
+
+	/**
+	 * Release the mapping.
+	 */
+	void Close();
+
+	const BYTE* GetData() const { return pData; }
+	UI64 GetSize() const { return mSize; }
+	bool IsOpen() const { return pData != nullptr; }
+
+private:
+	const BYTE* pData = nullptr;
+	UI64 mSize = 0;
+};
@@ -4,24 +4,84 @@
 #include "ShaderCode.h"
 #include "Core/ErrorHandler/MessageBox.h"
 
-#include <fstream>
-
 bool ShaderCode::LoadCode(const char* pFile)
 {
-	std::ifstream file(pFile, std::ios::ate | std::ios::binary);
-
-	if (!file.is_open())
+	MappedFile file;
+	if (!file.Open(pFile))
 	{
 		MessageBox::IssueError(TEXT("Failed to open the shader file! \nMake sure that the provided shader path is correct."));
 		return false;
 	}
 
-	UI64 size = file.tellg();
-	file.seekg(0);
+	ShaderCodeType type = ShaderCodeType::UNDEFINED;
+	if (file.GetSize() >= sizeof(UI32) && *reinterpret_cast<const UI32*>(file.GetData()) == SPIRV_MAGIC_NUMBER)
+	{
+		if (file.GetSize() % sizeof(UI32))
+		{
+			MessageBox::IssueError(TEXT("The SPIR-V shader file is truncated!"));
+			return false;
+		}
 
-	mCode.resize(size);
-	file.read(reinterpret_cast<char*>(mCode.data()), size);
+		type = ShaderCodeType::SPIR_V;
+	}
 
-	file.close();
+	SetCode(std::move(file), type, mStage);
 	return true;
 }
+
+void ShaderCode::SetCode(std::vector<UI32>&& code, ShaderCodeType type, ShaderStage stage)
+{
+	mMappedCode.Close();
+	pCodeView = nullptr;
+	mCodeViewSize = 0;
+	mCode = std::move(code);
+	mReflection.Clear();
+	mType = type;
+	mStage = stage;
+}
+
+void ShaderCode::SetCode(MappedFile&& file, ShaderCodeType type, ShaderStage stage)
+{
+	mCode.clear();
+	mCode.shrink_to_fit();
+	mMappedCode = std::move(file);
+	pCodeView = nullptr;
+	mCodeViewSize = 0;
+	mReflection.Clear();
+	mType = type;
+	mStage = stage;
+}
+
+void ShaderCode::SetCode(const UI32* pCode, UI64 size, ShaderCodeType type, ShaderStage stage)
+{
+	mCode.clear();
+	mCode.shrink_to_fit();
+	mMappedCode.Close();
+	pCodeView = pCode;
+	mCodeViewSize = size;
+	mReflection.Clear();
+	mType = type;
+	mStage = stage;
+}
+
+const UI32* ShaderCode::GetCode() const
+{
+	if (pCodeView)
+		return pCodeView;
+
+	if (mMappedCode.IsOpen())
+		return reinterpret_cast<const UI32*>(mMappedCode.GetData());
+
+	return mCode.data();
+}
+
+UI64 ShaderCode::GetCodeSize() const
+{
+	if (pCodeView)
+		return mCodeViewSize;
+
+	if (mMappedCode.IsOpen())
+		return mMappedCode.GetSize();
+
+	return mCode.size() * sizeof(UI32);
+}
@@ -3,7 +3,10 @@
 
 #pragma once
 
-#include "Core/Types/DataTypes.h"
+#include "Core/FileSystem/MappedFile.h"
+#include "ShaderReflection.h"
+
+#define SPIRV_MAGIC_NUMBER	0x07230203
 
 enum class ShaderCodeType : UI8 {
 	UNDEFINED,
@@ -12,14 +15,107 @@ enum class ShaderCodeType : UI8 {
 	SPIR_V
 };
 
+enum class ShaderStage : UI8 {
+	UNDEFINED,
+	VERTEX,
+	TESSELLATION_CONTROL,
+	TESSELLATION_EVALUATION,
+	GEOMETRY,
+	FRAGMENT,
+	COMPUTE
+};
+
+/**
+ * Shader Code object.
+ * The code is either owned (compiled in memory), a read-only view over a mapped file or a view over memory owned
+ * by someone else, like a shader pack.
+ */
 class ShaderCode {
 public:
 	ShaderCode() {}
 	~ShaderCode() {}
 
+	ShaderCode(ShaderCode&&) = default;
+	ShaderCode& operator=(ShaderCode&&) = default;
+
+	/**
+	 * Load shader code from a file.
+	 * The file is mapped, not copied.
+	 *
+	 * @param pFile: The file path.
+	 * @return Boolean value.
+	 */
 	bool LoadCode(const char* pFile);
 
+	/**
+	 * Set the shader code directly.
+	 *
+	 * @param code: The shader code words.
+	 * @param type: The type of the code.
+	 * @param stage: The shader stage the code belongs to.
+	 */
+	void SetCode(std::vector<UI32>&& code, ShaderCodeType type, ShaderStage stage);
+
+	/**
+	 * Set the shader code to an already mapped file.
+	 *
+	 * @param file: The mapped file.
+	 * @param type: The type of the code.
+	 * @param stage: The shader stage the code belongs to.
+	 */
+	void SetCode(MappedFile&& file, ShaderCodeType type, ShaderStage stage);
+
+	/**
+	 * Set the shader code to a view over external memory.
+	 * The memory is not copied and must outlive this object (or the next SetCode call).
+	 *
+	 * @param pCode: The code words.
+	 * @param size: The size of the code in bytes.
+	 * @param type: The type of the code.
+	 * @param stage: The shader stage the code belongs to.
+	 */
+	void SetCode(const UI32* pCode, UI64 size, ShaderCodeType type, ShaderStage stage);
+
+	void SetStage(ShaderStage stage) { mStage = stage; }
+
+	/**
+	 * Get the code words.
+	 * The pointer is valid for as long as this object holds the code.
+	 *
+	 * @return The code pointer.
+	 */
+	const UI32* GetCode() const;
+
+	/**
+	 * Get the size of the code in bytes.
+	 *
+	 * @return The size.
+	 */
+	UI64 GetCodeSize() const;
+
+	UI64 GetWordCount() const { return GetCodeSize() / sizeof(UI32); }
+	bool IsEmpty() const { return GetCodeSize() == 0; }
+
+	ShaderCodeType GetType() const { return mType; }
+	ShaderStage GetStage() const { return mStage; }
+
+	/**
+	 * Set the reflection of the code.
+	 * Setting new code invalidates the reflection.
+	 *
+	 * @param reflection: The reflection.
+	 */
+	void SetReflection(ShaderReflection&& reflection) { mReflection = std::move(reflection); }
+
+	const ShaderReflection& GetReflection() const { return mReflection; }
+	bool HasReflection() const { return mReflection.mIsValid; }
+
 private:
 	std::vector<UI32> mCode;
+	MappedFile mMappedCode = {};
+	const UI32* pCodeView = nullptr;
+	UI64 mCodeViewSize = 0;
+	ShaderReflection mReflection = {};
 	ShaderCodeType mType = ShaderCodeType::UNDEFINED;
-};
\ No newline at end of file
+	ShaderStage mStage = ShaderStage::UNDEFINED;
+};
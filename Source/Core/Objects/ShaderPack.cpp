@@ -0,0 +1,285 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderPack.h"
+#include "Core/Types/Hasher.h"
+#include "Core/Compression/SPIRVCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace _Helpers
+{
+	/**
+	 * Check if a range lies within a file.
+	 *
+	 * @param offset: The offset of the range.
+	 * @param size: The size of the range.
+	 * @param fileSize: The size of the file.
+	 * @return Boolean value.
+	 */
+	bool IsInFile(UI64 offset, UI64 size, UI64 fileSize)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	}
+
+	/**
+	 * Order entries by name hash, then by name.
+	 */
+	bool IsEntryLess(const ShaderPackEntry& entry, UI64 hash, const char* pName, UI64 nameSize, const BYTE* pData)
+	{
+		if (entry.mNameHash != hash)
+			return entry.mNameHash < hash;
+
+		const I32 result = std::memcmp(pData + entry.mNameOffset, pName, std::min<UI64>(entry.mNameSize, nameSize));
+		return result < 0 || (result == 0 && entry.mNameSize < nameSize);
+	}
+}
+
+bool ShaderPack::Open(const char* pFile)
+{
+	Close();
+
+	if (!mFile.Open(pFile))
+		return false;
+
+	const UI64 fileSize = mFile.GetSize();
+	const BYTE* pData = mFile.GetData();
+
+	ShaderPackHeader header = {};
+	if (fileSize < sizeof(ShaderPackHeader))
+	{
+		Close();
+		return false;
+	}
+
+	std::memcpy(&header, pData, sizeof(ShaderPackHeader));
+	if (header.mMagic != SHADER_PACK_MAGIC || header.mVersion != SHADER_PACK_VERSION || header.mFileSize != fileSize
+		|| header.mIndexOffset % alignof(ShaderPackEntry)
+		|| !_Helpers::IsInFile(header.mIndexOffset, static_cast<UI64>(header.mEntryCount) * sizeof(ShaderPackEntry), fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	const ShaderPackEntry* pIndex = reinterpret_cast<const ShaderPackEntry*>(pData + header.mIndexOffset);
+	for (UI32 i = 0; i < header.mEntryCount; i++)
+	{
+		const ShaderPackEntry& entry = pIndex[i];
+		if (!_Helpers::IsInFile(entry.mNameOffset, entry.mNameSize, fileSize)
+			|| !_Helpers::IsInFile(entry.mCodeOffset, entry.mCodeSize, fileSize)
+			|| !_Helpers::IsInFile(entry.mReflectionOffset, entry.mReflectionSize, fileSize)
+			|| entry.mCodeOffset % sizeof(UI32) || (entry.mEncoding == SHADER_PACK_ENCODING_RAW && entry.mCodeSize % sizeof(UI32))
+			|| entry.mEncoding > SHADER_PACK_ENCODING_SPIRV
+			|| (i && _Helpers::IsEntryLess(entry, pIndex[i - 1].mNameHash, reinterpret_cast<const char*>(pData + pIndex[i - 1].mNameOffset), pIndex[i - 1].mNameSize, pData)))
+		{
+			Close();
+			return false;
+		}
+	}
+
+	pEntries = pIndex;
+	mEntryCount = header.mEntryCount;
+	return true;
+}
+
+void ShaderPack::Close()
+{
+	mFile.Close();
+	pEntries = nullptr;
+	mEntryCount = 0;
+}
+
+const ShaderPackEntry* ShaderPack::Find(const String& name) const
+{
+	const UI64 hash = GetNameHash(name);
+	const BYTE* pData = mFile.GetData();
+
+	const ShaderPackEntry* pEnd = pEntries + mEntryCount;
+	const ShaderPackEntry* pEntry = std::lower_bound(pEntries, pEnd, hash, [&name, pData](const ShaderPackEntry& entry, UI64 hash)
+		{
+			return _Helpers::IsEntryLess(entry, hash, name.data(), name.size(), pData);
+		});
+
+	if (pEntry == pEnd || pEntry->mNameHash != hash || pEntry->mNameSize != name.size()
+		|| std::memcmp(pData + pEntry->mNameOffset, name.data(), name.size()))
+		return nullptr;
+
+	return pEntry;
+}
+
+bool ShaderPack::Load(const String& name, ShaderCode* pShaderCode) const
+{
+	const ShaderPackEntry* pEntry = Find(name);
+	if (!pEntry)
+		return false;
+
+	return Load(*pEntry, pShaderCode);
+}
+
+bool ShaderPack::Load(const ShaderPackEntry& entry, ShaderCode* pShaderCode) const
+{
+	const BYTE* pData = mFile.GetData();
+	if (entry.mEncoding == SHADER_PACK_ENCODING_SPIRV)
+	{
+		std::vector<UI32> code;
+		if (!SPIRVCodec::Decode(pData + entry.mCodeOffset, entry.mCodeSize, &code))
+			return false;
+
+		pShaderCode->SetCode(std::move(code), ShaderCodeType::SPIR_V, entry.mStage);
+	}
+	else
+		pShaderCode->SetCode(reinterpret_cast<const UI32*>(pData + entry.mCodeOffset), entry.mCodeSize, ShaderCodeType::SPIR_V, entry.mStage);
+
+	if (entry.mReflectionSize)
+	{
+		ShaderReflection reflection;
+		if (reflection.Deserialize(pData + entry.mReflectionOffset, entry.mReflectionSize))
+			pShaderCode->SetReflection(std::move(reflection));
+	}
+
+	return true;
+}
+
+String ShaderPack::GetName(const ShaderPackEntry& entry) const
+{
+	return String(reinterpret_cast<const char*>(mFile.GetData() + entry.mNameOffset), entry.mNameSize);
+}
+
+UI64 ShaderPack::GetNameHash(const String& name)
+{
+	Hasher hasher;
+	hasher.Update(name.data(), name.size());
+	return hasher.GetHash();
+}
+
+bool ShaderPackWriter::Add(const String& name, const ShaderCode& shaderCode)
+{
+	if (shaderCode.GetType() != ShaderCodeType::SPIR_V || shaderCode.IsEmpty())
+		return false;
+
+	for (const PackedShader& shader : mShaders)
+		if (shader.mName == name)
+			return false;
+
+	PackedShader shader = {};
+	shader.mName = name;
+	shader.mCode.assign(shaderCode.GetCode(), shaderCode.GetCode() + shaderCode.GetWordCount());
+	shader.mStage = shaderCode.GetStage();
+
+	if (shaderCode.HasReflection())
+		shaderCode.GetReflection().Serialize(&shader.mReflection);
+
+	mShaders.push_back(std::move(shader));
+	return true;
+}
+
+bool ShaderPackWriter::Write(const char* pFile) const
+{
+	// Layout: header, index, names, then the code and reflection of each shader.
+	std::vector<UI64> hashes(mShaders.size());
+	std::vector<UI64> order(mShaders.size());
+
+	for (UI64 i = 0; i < mShaders.size(); i++)
+	{
+		hashes[i] = ShaderPack::GetNameHash(mShaders[i].mName);
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [this, &hashes](UI64 lhs, UI64 rhs)
+		{
+			if (hashes[lhs] != hashes[rhs])
+				return hashes[lhs] < hashes[rhs];
+
+			return mShaders[lhs].mName < mShaders[rhs].mName;
+		});
+
+	// Encoded code of each shader in index order. Empty when the code is stored raw.
+	std::vector<std::vector<BYTE>> encodedCode(mShaders.size());
+	if (mCompress)
+		for (UI64 i = 0; i < order.size(); i++)
+			SPIRVCodec::Encode(mShaders[order[i]].mCode.data(), mShaders[order[i]].mCode.size(), &encodedCode[i]);
+
+	ShaderPackHeader header = {};
+	header.mEntryCount = static_cast<UI32>(mShaders.size());
+	header.mIndexOffset = sizeof(ShaderPackHeader);
+
+	UI64 offset = header.mIndexOffset + mShaders.size() * sizeof(ShaderPackEntry);
+	std::vector<ShaderPackEntry> index(mShaders.size());
+
+	for (UI64 i = 0; i < order.size(); i++)
+	{
+		const PackedShader& shader = mShaders[order[i]];
+		ShaderPackEntry& entry = index[i];
+		entry.mNameHash = hashes[order[i]];
+		entry.mNameOffset = offset;
+		entry.mNameSize = static_cast<UI32>(shader.mName.size());
+		entry.mStage = shader.mStage;
+		offset += entry.mNameSize;
+	}
+
+	for (UI64 i = 0; i < order.size(); i++)
+	{
+		const PackedShader& shader = mShaders[order[i]];
+		ShaderPackEntry& entry = index[i];
+
+		offset = (offset + sizeof(UI32) - 1) & ~static_cast<UI64>(sizeof(UI32) - 1);
+		entry.mCodeOffset = offset;
+		entry.mEncoding = mCompress ? SHADER_PACK_ENCODING_SPIRV : SHADER_PACK_ENCODING_RAW;
+		entry.mCodeSize = static_cast<UI32>(mCompress ? encodedCode[i].size() : shader.mCode.size() * sizeof(UI32));
+		offset += entry.mCodeSize;
+
+		entry.mReflectionOffset = offset;
+		entry.mReflectionSize = static_cast<UI32>(shader.mReflection.size());
+		offset += entry.mReflectionSize;
+	}
+
+	header.mFileSize = offset;
+
+	std::stringstream temporaryPath;
+	temporaryPath << pFile << "." << std::this_thread::get_id() << ".tmp";
+
+	{
+		std::ofstream file(temporaryPath.str(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(ShaderPackHeader));
+		file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(ShaderPackEntry));
+
+		for (UI64 i = 0; i < order.size(); i++)
+			file.write(mShaders[order[i]].mName.data(), mShaders[order[i]].mName.size());
+
+		static const char padding[sizeof(UI32)] = {};
+		for (UI64 i = 0; i < order.size(); i++)
+		{
+			const PackedShader& shader = mShaders[order[i]];
+			const ShaderPackEntry& entry = index[i];
+
+			file.write(padding, entry.mCodeOffset - static_cast<UI64>(file.tellp()));
+			if (mCompress)
+				file.write(reinterpret_cast<const char*>(encodedCode[i].data()), entry.mCodeSize);
+			else
+				file.write(reinterpret_cast<const char*>(shader.mCode.data()), entry.mCodeSize);
+			file.write(reinterpret_cast<const char*>(shader.mReflection.data()), entry.mReflectionSize);
+		}
+
+		if (!file)
+			return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryPath.str(), pFile, errorCode);
+
+	if (errorCode)
+	{
+		std::filesystem::remove(temporaryPath.str(), errorCode);
+		return false;
+	}
+
+	return true;
+}
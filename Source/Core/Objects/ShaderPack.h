@@ -0,0 +1,176 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ShaderCode.h"
+
+#define SHADER_PACK_MAGIC		0x4B505353	// "SSPK"
+#define SHADER_PACK_VERSION		1
+
+#define SHADER_PACK_ENCODING_RAW		0	// Plain SPIR-V words, used in place.
+#define SHADER_PACK_ENCODING_SPIRV		1	// SPIR-V codec stream, decoded on load.
+
+/**
+ * Shader pack header structure.
+ * Every offset in a pack is relative to the start of the file.
+ */
+struct ShaderPackHeader {
+	UI32 mMagic = SHADER_PACK_MAGIC;
+	UI32 mVersion = SHADER_PACK_VERSION;
+	UI32 mEntryCount = 0;
+	UI32 mReserved = 0;
+	UI64 mIndexOffset = 0;		// Offset of the entry index.
+	UI64 mFileSize = 0;			// Size of the whole pack, to detect truncation.
+};
+
+/**
+ * Shader pack entry structure.
+ * The index is an array of these sorted by name hash (and name on collisions).
+ */
+struct ShaderPackEntry {
+	UI64 mNameHash = 0;
+	UI64 mNameOffset = 0;
+	UI64 mCodeOffset = 0;			// Always 4 byte aligned.
+	UI64 mReflectionOffset = 0;
+	UI32 mNameSize = 0;
+	UI32 mCodeSize = 0;				// Size of the stored (possibly encoded) code in bytes.
+	UI32 mReflectionSize = 0;		// 0 if the shader was packed without reflection.
+	ShaderStage mStage = ShaderStage::UNDEFINED;
+	UI8 mEncoding = SHADER_PACK_ENCODING_RAW;
+	UI8 mReserved[2] = {};
+};
+
+static_assert(sizeof(ShaderPackHeader) == 32, "The shader pack header layout changed!");
+static_assert(sizeof(ShaderPackEntry) == 48, "The shader pack entry layout changed!");
+
+/**
+ * Shader Pack object.
+ * A single mapped file holding many SPIR-V modules with their reflection and names. The file starts with an
+ * index sorted by name hash, so a shader is found with a binary search straight over the mapped memory and its
+ * code is used in place.
+ */
+class ShaderPack {
+public:
+	ShaderPack() {}
+	~ShaderPack() {}
+
+	/**
+	 * Open a pack.
+	 * The index and every entry range are validated once here, so lookups do no checks.
+	 *
+	 * @param pFile: The pack file.
+	 * @return Boolean value.
+	 */
+	bool Open(const char* pFile);
+
+	/**
+	 * Close the pack.
+	 * Shader code loaded from the pack must not be used afterwards.
+	 */
+	void Close();
+
+	/**
+	 * Find an entry.
+	 *
+	 * @param name: The name the shader was packed with.
+	 * @return The entry pointer. nullptr if the pack does not contain the shader.
+	 */
+	const ShaderPackEntry* Find(const String& name) const;
+
+	/**
+	 * Load a shader from the pack.
+	 * Raw code is not copied, the shader code object views the mapped pack. Encoded code is decoded.
+	 *
+	 * @param name: The name the shader was packed with.
+	 * @param pShaderCode: The shader code to load to.
+	 * @return Boolean value stating if the shader was found.
+	 */
+	bool Load(const String& name, ShaderCode* pShaderCode) const;
+
+	/**
+	 * Load a shader from an entry of the pack.
+	 *
+	 * @param entry: The entry.
+	 * @param pShaderCode: The shader code to load to.
+	 * @return Boolean value.
+	 */
+	bool Load(const ShaderPackEntry& entry, ShaderCode* pShaderCode) const;
+
+	/**
+	 * Get the name of an entry.
+	 *
+	 * @param entry: The entry.
+	 * @return The name.
+	 */
+	String GetName(const ShaderPackEntry& entry) const;
+
+	const ShaderPackEntry* GetEntries() const { return pEntries; }
+	UI32 GetEntryCount() const { return mEntryCount; }
+	bool IsOpen() const { return mFile.IsOpen(); }
+
+	/**
+	 * Get the hash of an entry name.
+	 *
+	 * @param name: The name.
+	 * @return The hash.
+	 */
+	static UI64 GetNameHash(const String& name);
+
+private:
+	MappedFile mFile = {};
+	const ShaderPackEntry* pEntries = nullptr;
+	UI32 mEntryCount = 0;
+};
+
+/**
+ * Shader Pack Writer object.
+ */
+class ShaderPackWriter {
+public:
+	ShaderPackWriter() {}
+	~ShaderPackWriter() {}
+
+	/**
+	 * Add a shader to the pack.
+	 * The code and its reflection, if any, are copied.
+	 *
+	 * @param name: The name to find the shader with.
+	 * @param shaderCode: The SPIR-V code.
+	 * @return Boolean value. False if the code is not SPIR-V or the name is already used.
+	 */
+	bool Add(const String& name, const ShaderCode& shaderCode);
+
+	/**
+	 * Write the pack.
+	 * The pack is written to a temporary file and renamed in place so readers never see a partial pack.
+	 *
+	 * @param pFile: The pack file.
+	 * @return Boolean value.
+	 */
+	bool Write(const char* pFile) const;
+
+	/**
+	 * Set whether the code is compressed with the SPIR-V codec.
+	 * Compressed packs are smaller on disk but the code is decoded to the heap when loaded.
+	 *
+	 * @param compress: The boolean value.
+	 */
+	void SetCompression(bool compress) { mCompress = compress; }
+
+	UI64 GetShaderCount() const { return mShaders.size(); }
+
+private:
+	/**
+	 * Packed shader structure.
+	 */
+	struct PackedShader {
+		String mName = "";
+		std::vector<UI32> mCode;
+		std::vector<BYTE> mReflection;
+		ShaderStage mStage = ShaderStage::UNDEFINED;
+	};
+
+	std::vector<PackedShader> mShaders;
+	bool mCompress = false;
+};
@@ -0,0 +1,173 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderReflection.h"
+
+#include <cstring>
+
+#define SHADER_REFLECTION_MAGIC		0x46455253	// "SREF"
+#define SHADER_REFLECTION_VERSION	2
+
+namespace _Helpers
+{
+	/**
+	 * Binary writer structure.
+	 */
+	struct BinaryWriter {
+		BinaryWriter(std::vector<BYTE>* pBytes) : pBytes(pBytes) {}
+
+		void Write(UI32 value)
+		{
+			const BYTE* pValue = reinterpret_cast<const BYTE*>(&value);
+			pBytes->insert(pBytes->end(), pValue, pValue + sizeof(UI32));
+		}
+
+		void Write(const String& string)
+		{
+			Write(static_cast<UI32>(string.size()));
+			pBytes->insert(pBytes->end(), string.begin(), string.end());
+		}
+
+		std::vector<BYTE>* pBytes = nullptr;
+	};
+
+	/**
+	 * Binary reader structure.
+	 * Every read fails once the stream is exhausted.
+	 */
+	struct BinaryReader {
+		BinaryReader(const BYTE* pBytes, UI64 size) : pBytes(pBytes), mSize(size) {}
+
+		bool Read(UI32* pValue)
+		{
+			if (mOffset + sizeof(UI32) > mSize)
+				return false;
+
+			std::memcpy(pValue, pBytes + mOffset, sizeof(UI32));
+			mOffset += sizeof(UI32);
+			return true;
+		}
+
+		template<class Type>
+		bool ReadAs(Type* pValue)
+		{
+			UI32 value = 0;
+			if (!Read(&value))
+				return false;
+
+			*pValue = static_cast<Type>(value);
+			return true;
+		}
+
+		bool Read(String* pString)
+		{
+			UI32 length = 0;
+			if (!Read(&length) || mOffset + length > mSize)
+				return false;
+
+			pString->assign(reinterpret_cast<const char*>(pBytes + mOffset), length);
+			mOffset += length;
+			return true;
+		}
+
+		const BYTE* pBytes = nullptr;
+		UI64 mSize = 0;
+		UI64 mOffset = 0;
+	};
+}
+
+void ShaderReflection::Serialize(std::vector<BYTE>* pBytes) const
+{
+	_Helpers::BinaryWriter writer(pBytes);
+	writer.Write(SHADER_REFLECTION_MAGIC);
+	writer.Write(SHADER_REFLECTION_VERSION);
+
+	writer.Write(static_cast<UI32>(mDescriptorBindings.size()));
+	for (const ShaderDescriptorBinding& binding : mDescriptorBindings)
+	{
+		writer.Write(binding.mName);
+		writer.Write(binding.mSet);
+		writer.Write(binding.mBinding);
+		writer.Write(binding.mCount);
+		writer.Write(static_cast<UI32>(binding.mType));
+		writer.Write(static_cast<UI32>(binding.mIsSpecializationSized));
+	}
+
+	writer.Write(static_cast<UI32>(mPushConstantRanges.size()));
+	for (const ShaderPushConstantRange& range : mPushConstantRanges)
+	{
+		writer.Write(range.mOffset);
+		writer.Write(range.mSize);
+	}
+
+	writer.Write(static_cast<UI32>(mVertexInputs.size()));
+	for (const ShaderVertexInput& input : mVertexInputs)
+	{
+		writer.Write(input.mName);
+		writer.Write(input.mLocation);
+		writer.Write(input.mComponentCount);
+		writer.Write(input.mColumnCount);
+		writer.Write(static_cast<UI32>(input.mType));
+	}
+
+	writer.Write(static_cast<UI32>(mSpecializationConstants.size()));
+	for (const ShaderSpecializationConstant& constant : mSpecializationConstants)
+	{
+		writer.Write(constant.mName);
+		writer.Write(constant.mConstantID);
+		writer.Write(constant.mSize);
+	}
+}
+
+bool ShaderReflection::Deserialize(const BYTE* pBytes, UI64 size)
+{
+	Clear();
+
+	_Helpers::BinaryReader reader(pBytes, size);
+	UI32 magic = 0, version = 0, count = 0;
+	if (!reader.Read(&magic) || !reader.Read(&version) || magic != SHADER_REFLECTION_MAGIC || version != SHADER_REFLECTION_VERSION)
+		return false;
+
+	bool isValid = reader.Read(&count);
+	for (UI32 i = 0; isValid && i < count; i++)
+	{
+		ShaderDescriptorBinding binding = {};
+		isValid = reader.Read(&binding.mName) && reader.Read(&binding.mSet) && reader.Read(&binding.mBinding)
+			&& reader.Read(&binding.mCount) && reader.ReadAs(&binding.mType) && reader.ReadAs(&binding.mIsSpecializationSized);
+		mDescriptorBindings.push_back(std::move(binding));
+	}
+
+	isValid = isValid && reader.Read(&count);
+	for (UI32 i = 0; isValid && i < count; i++)
+	{
+		ShaderPushConstantRange range = {};
+		isValid = reader.Read(&range.mOffset) && reader.Read(&range.mSize);
+		mPushConstantRanges.push_back(range);
+	}
+
+	isValid = isValid && reader.Read(&count);
+	for (UI32 i = 0; isValid && i < count; i++)
+	{
+		ShaderVertexInput input = {};
+		isValid = reader.Read(&input.mName) && reader.Read(&input.mLocation) && reader.ReadAs(&input.mComponentCount)
+			&& reader.ReadAs(&input.mColumnCount) && reader.ReadAs(&input.mType);
+		mVertexInputs.push_back(std::move(input));
+	}
+
+	isValid = isValid && reader.Read(&count);
+	for (UI32 i = 0; isValid && i < count; i++)
+	{
+		ShaderSpecializationConstant constant = {};
+		isValid = reader.Read(&constant.mName) && reader.Read(&constant.mConstantID) && reader.Read(&constant.mSize);
+		mSpecializationConstants.push_back(std::move(constant));
+	}
+
+	if (!isValid)
+	{
+		Clear();
+		return false;
+	}
+
+	mIsValid = true;
+	return true;
+}
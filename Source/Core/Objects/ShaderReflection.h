@@ -0,0 +1,110 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+/**
+ * Shader resource type enum.
+ */
+enum class ShaderResourceType : UI8 {
+	UNDEFINED,
+	UNIFORM_BUFFER,
+	STORAGE_BUFFER,
+	UNIFORM_TEXEL_BUFFER,
+	STORAGE_TEXEL_BUFFER,
+	COMBINED_IMAGE_SAMPLER,
+	SAMPLED_IMAGE,
+	STORAGE_IMAGE,
+	SAMPLER,
+	INPUT_ATTACHMENT,
+	ACCELERATION_STRUCTURE,
+};
+
+/**
+ * Shader attribute base type enum.
+ */
+enum class ShaderAttributeType : UI8 {
+	UNDEFINED,
+	SIGNED_INT,
+	UNSIGNED_INT,
+	HALF_FLOAT,
+	FLOAT,
+	DOUBLE,
+};
+
+/**
+ * Shader descriptor binding structure.
+ */
+struct ShaderDescriptorBinding {
+	String mName = "";
+	UI32 mSet = 0;
+	UI32 mBinding = 0;
+	UI32 mCount = 1;		// Array element count. 0 for runtime sized arrays.
+	ShaderResourceType mType = ShaderResourceType::UNDEFINED;
+	bool mIsSpecializationSized = false;	// The count is the default of a specialization constant and may change per pipeline.
+};
+
+/**
+ * Shader push constant range structure.
+ */
+struct ShaderPushConstantRange {
+	UI32 mOffset = 0;
+	UI32 mSize = 0;
+};
+
+/**
+ * Shader vertex input structure.
+ */
+struct ShaderVertexInput {
+	String mName = "";
+	UI32 mLocation = 0;
+	UI8 mComponentCount = 0;	// Vector size.
+	UI8 mColumnCount = 1;		// Matrix columns, each consuming one location.
+	ShaderAttributeType mType = ShaderAttributeType::UNDEFINED;
+};
+
+/**
+ * Shader specialization constant structure.
+ */
+struct ShaderSpecializationConstant {
+	String mName = "";
+	UI32 mConstantID = 0;
+	UI32 mSize = 0;				// Size in bytes.
+};
+
+/**
+ * Shader Reflection object.
+ * The resource interface of a SPIR-V module.
+ */
+class ShaderReflection {
+public:
+	ShaderReflection() {}
+	~ShaderReflection() {}
+
+	/**
+	 * Serialize the reflection to a byte stream.
+	 *
+	 * @param pBytes: The vector to append the bytes to.
+	 */
+	void Serialize(std::vector<BYTE>* pBytes) const;
+
+	/**
+	 * Deserialize the reflection from a byte stream.
+	 *
+	 * @param pBytes: The bytes.
+	 * @param size: The number of bytes.
+	 * @return Boolean value stating if the stream was valid.
+	 */
+	bool Deserialize(const BYTE* pBytes, UI64 size);
+
+	void Clear() { *this = ShaderReflection(); }
+
+public:
+	std::vector<ShaderDescriptorBinding> mDescriptorBindings;
+	std::vector<ShaderPushConstantRange> mPushConstantRanges;
+	std::vector<ShaderVertexInput> mVertexInputs;
+	std::vector<ShaderSpecializationConstant> mSpecializationConstants;
+	bool mIsValid = false;
+};
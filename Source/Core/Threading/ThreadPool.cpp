@@ -0,0 +1,146 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ThreadPool.h"
+
+void ThreadPool::Initialize(UI32 threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+	mShouldStop = false;
+
+	for (UI32 i = 0; i < threadCount; i++)
+		mQueues.push_back(std::make_unique<WorkerQueue>());
+
+	for (UI32 i = 0; i < threadCount; i++)
+		mWorkers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+void ThreadPool::Terminate()
+{
+	if (mWorkers.empty())
+		return;
+
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mShouldStop = true;
+	}
+
+	mWakeCondition.notify_all();
+
+	for (auto itr = mWorkers.begin(); itr != mWorkers.end(); itr++)
+		itr->join();
+
+	mWorkers.clear();
+	mQueues.clear();
+}
+
+void ThreadPool::Submit(std::function<void()>&& task)
+{
+	// Execute in place if the pool was never initialized.
+	if (mQueues.empty())
+	{
+		task();
+		return;
+	}
+
+	mPendingTasks++;
+
+	WorkerQueue& queue = *mQueues[mNextQueue++ % mQueues.size()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+		queue.mTasks.push_back(std::move(task));
+	}
+
+	{
+		// Publishing under the lock makes sure a worker about to sleep sees the new task.
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQueuedTasks++;
+	}
+
+	mWakeCondition.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::function<void()> task;
+	while (mPendingTasks > 0)
+	{
+		if (TrySteal(static_cast<UI32>(mQueues.size()), &task))
+		{
+			Execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mIdleCondition.wait(lock, [this] { return mPendingTasks == 0; });
+	}
+}
+
+void ThreadPool::WorkerLoop(UI32 index)
+{
+	std::function<void()> task;
+	while (true)
+	{
+		if (TryPop(index, &task) || TrySteal(index, &task))
+		{
+			Execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mWakeCondition.wait(lock, [this] { return mShouldStop || mQueuedTasks > 0; });
+
+		if (mShouldStop && mQueuedTasks <= 0)
+			return;
+	}
+}
+
+bool ThreadPool::TryPop(UI32 index, std::function<void()>* pTask)
+{
+	WorkerQueue& queue = *mQueues[index];
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+
+	if (queue.mTasks.empty())
+		return false;
+
+	*pTask = std::move(queue.mTasks.back());
+	queue.mTasks.pop_back();
+	mQueuedTasks--;
+	return true;
+}
+
+bool ThreadPool::TrySteal(UI32 index, std::function<void()>* pTask)
+{
+	const UI64 queueCount = mQueues.size();
+	for (UI64 i = 1; i <= queueCount; i++)
+	{
+		WorkerQueue& queue = *mQueues[(index + i) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+
+		if (queue.mTasks.empty())
+			continue;
+
+		*pTask = std::move(queue.mTasks.front());
+		queue.mTasks.pop_front();
+		mQueuedTasks--;
+		return true;
+	}
+
+	return false;
+}
+
+void ThreadPool::Execute(std::function<void()>& task)
+{
+	task();
+	task = nullptr;
+
+	if (--mPendingTasks == 0)
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mIdleCondition.notify_all();
+	}
+}
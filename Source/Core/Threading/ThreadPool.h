@@ -0,0 +1,80 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Thread Pool object.
+ * Every worker owns a task queue. Workers pop from the back of their own queue and steal from the front
+ * of the others when it runs dry, so long running tasks do not leave the remaining cores idle.
+ */
+class ThreadPool {
+	/**
+	 * Worker queue structure.
+	 */
+	struct WorkerQueue {
+		std::deque<std::function<void()>> mTasks;
+		std::mutex mMutex;
+	};
+
+public:
+	ThreadPool() {}
+	~ThreadPool() { Terminate(); }
+
+	/**
+	 * Initialize the pool.
+	 *
+	 * @param threadCount: The number of worker threads. 0 uses the hardware concurrency.
+	 */
+	void Initialize(UI32 threadCount = 0);
+
+	/**
+	 * Terminate the pool.
+	 * Waits for all the submitted tasks before joining the workers.
+	 */
+	void Terminate();
+
+	/**
+	 * Submit a task.
+	 *
+	 * @param task: The task to be executed.
+	 */
+	void Submit(std::function<void()>&& task);
+
+	/**
+	 * Wait till all the submitted tasks are complete.
+	 * The calling thread executes tasks while it waits.
+	 */
+	void Wait();
+
+	UI32 GetThreadCount() const { return static_cast<UI32>(mWorkers.size()); }
+
+private:
+	void WorkerLoop(UI32 index);
+	bool TryPop(UI32 index, std::function<void()>* pTask);
+	bool TrySteal(UI32 index, std::function<void()>* pTask);
+	void Execute(std::function<void()>& task);
+
+private:
+	std::vector<std::thread> mWorkers;
+	std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+
+	std::mutex mSleepMutex;
+	std::condition_variable mWakeCondition;
+	std::condition_variable mIdleCondition;
+
+	std::atomic<I64> mQueuedTasks = 0;		// Tasks waiting in a queue.
+	std::atomic<I64> mPendingTasks = 0;		// Tasks queued or running.
+	std::atomic<UI32> mNextQueue = 0;
+	bool mShouldStop = false;
+};
@@ -0,0 +1,31 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Hasher.h"
+
+void Hasher::Update(const void* pData, UI64 size)
+{
+	const BYTE* pBytes = static_cast<const BYTE*>(pData);
+	for (UI64 i = 0; i < size; i++)
+	{
+		mHash ^= pBytes[i];
+		mHash *= 1099511628211ULL;
+	}
+}
+
+void Hasher::Update(const String& string)
+{
+	UpdateValue(static_cast<UI64>(string.size()));
+	Update(string.data(), string.size());
+}
+
+String Hasher::ToString(UI64 hash)
+{
+	const char digits[] = "0123456789abcdef";
+
+	String string(16, '0');
+	for (I32 i = 15; i >= 0; i--, hash >>= 4)
+		string[i] = digits[hash & 0xF];
+
+	return string;
+}
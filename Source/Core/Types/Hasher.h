@@ -0,0 +1,58 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "DataTypes.h"
+
+/**
+ * Hasher object.
+ * This is an incremental 64 bit FNV-1a hasher used to build content addresses.
+ */
+class Hasher {
+public:
+	Hasher() {}
+	~Hasher() {}
+
+	/**
+	 * Feed a block of bytes to the hasher.
+	 *
+	 * @param pData: The data pointer.
+	 * @param size: The size of the data in bytes.
+	 */
+	void Update(const void* pData, UI64 size);
+
+	/**
+	 * Feed a string to the hasher.
+	 * The length is hashed too so that adjacent strings can not alias each other.
+	 *
+	 * @param string: The string to be hashed.
+	 */
+	void Update(const String& string);
+
+	/**
+	 * Feed a trivially copyable value to the hasher.
+	 *
+	 * @param value: The value to be hashed.
+	 */
+	template<class Type>
+	void UpdateValue(const Type& value) { Update(&value, sizeof(Type)); }
+
+	/**
+	 * Get the current hash value.
+	 *
+	 * @return The 64 bit hash.
+	 */
+	UI64 GetHash() const { return mHash; }
+
+	/**
+	 * Convert a hash to a fixed width hexadecimal string.
+	 *
+	 * @param hash: The hash value.
+	 * @return The 16 character string.
+	 */
+	static String ToString(UI64 hash);
+
+private:
+	UI64 mHash = 14695981039346656037ULL;
+};
@@ -0,0 +1,240 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BindlessTable.h"
+#include "Macros.h"
+
+#include <algorithm>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			constexpr VkDescriptorType BindlessDescriptorTypes[] = {
+				VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			};
+		}
+
+		void VulkanBindlessTable::Initialize(VkDevice vLogicalDevice, const VkPhysicalDeviceDescriptorIndexingProperties& vProperties, UI32 frameCount)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+			this->mFrameCount = frameCount;
+
+			// Every array counts towards the per stage limit as well.
+			const UI32 stageLimit = vProperties.maxPerStageUpdateAfterBindResources / 2;
+			mArrays[static_cast<UI8>(VulkanBindlessResourceType::TEXTURE)].mCapacity = std::min({ static_cast<UI32>(VULKAN_BINDLESS_MAX_TEXTURES),
+				vProperties.maxDescriptorSetUpdateAfterBindSampledImages, vProperties.maxDescriptorSetUpdateAfterBindSamplers,
+				vProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, vProperties.maxPerStageDescriptorUpdateAfterBindSamplers, stageLimit });
+			mArrays[static_cast<UI8>(VulkanBindlessResourceType::BUFFER)].mCapacity = std::min({ static_cast<UI32>(VULKAN_BINDLESS_MAX_BUFFERS),
+				vProperties.maxDescriptorSetUpdateAfterBindStorageBuffers, vProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, stageLimit / 2 });
+			mArrays[static_cast<UI8>(VulkanBindlessResourceType::STORAGE_IMAGE)].mCapacity = std::min({ static_cast<UI32>(VULKAN_BINDLESS_MAX_STORAGE_IMAGES),
+				vProperties.maxDescriptorSetUpdateAfterBindStorageImages, vProperties.maxPerStageDescriptorUpdateAfterBindStorageImages, stageLimit / 4 });
+
+			std::vector<VkDescriptorSetLayoutBinding> vBindings;
+			std::vector<VkDescriptorBindingFlags> vBindingFlags;
+			std::vector<VkDescriptorPoolSize> vPoolSizes;
+			for (UI8 i = 0; i < static_cast<UI8>(VulkanBindlessResourceType::MAX); i++)
+			{
+				VkDescriptorSetLayoutBinding vBinding = {};
+				vBinding.binding = i;
+				vBinding.descriptorType = _Helpers::BindlessDescriptorTypes[i];
+				vBinding.descriptorCount = mArrays[i].mCapacity;
+				vBinding.stageFlags = VK_SHADER_STAGE_ALL;
+				vBinding.pImmutableSamplers = VK_NULL_HANDLE;
+				INSERT_INTO_VECTOR(vBindings, vBinding);
+
+				// Partially bound, so unused elements never need a valid descriptor.
+				INSERT_INTO_VECTOR(vBindingFlags, VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+
+				VkDescriptorPoolSize vSize = {};
+				vSize.type = vBinding.descriptorType;
+				vSize.descriptorCount = vBinding.descriptorCount;
+				INSERT_INTO_VECTOR(vPoolSizes, vSize);
+			}
+
+			VkDescriptorSetLayoutBindingFlagsCreateInfo vFlagsCI = {};
+			vFlagsCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+			vFlagsCI.pNext = VK_NULL_HANDLE;
+			vFlagsCI.bindingCount = static_cast<UI32>(vBindingFlags.size());
+			vFlagsCI.pBindingFlags = vBindingFlags.data();
+
+			VkDescriptorSetLayoutCreateInfo vLayoutCI = {};
+			vLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			vLayoutCI.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+			vLayoutCI.pNext = &vFlagsCI;
+			vLayoutCI.bindingCount = static_cast<UI32>(vBindings.size());
+			vLayoutCI.pBindings = vBindings.data();
+
+			VK_ASSERT(vkCreateDescriptorSetLayout(vLogicalDevice, &vLayoutCI, nullptr, &vSetLayout), "Failed to create the bindless descriptor set layout!");
+			vSetLayoutBindings = vBindings;
+
+			VkPipelineLayoutCreateInfo vPipelineLayoutCI = {};
+			vPipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			vPipelineLayoutCI.flags = VK_NULL_HANDLE;
+			vPipelineLayoutCI.pNext = VK_NULL_HANDLE;
+			vPipelineLayoutCI.setLayoutCount = 1;
+			vPipelineLayoutCI.pSetLayouts = &vSetLayout;
+			vPipelineLayoutCI.pushConstantRangeCount = 0;
+			vPipelineLayoutCI.pPushConstantRanges = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkCreatePipelineLayout(vLogicalDevice, &vPipelineLayoutCI, nullptr, &vPipelineLayout), "Failed to create the bindless pipeline layout!");
+
+			VkDescriptorPoolCreateInfo vPoolCI = {};
+			vPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			vPoolCI.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+			vPoolCI.pNext = VK_NULL_HANDLE;
+			vPoolCI.maxSets = 1;
+			vPoolCI.poolSizeCount = static_cast<UI32>(vPoolSizes.size());
+			vPoolCI.pPoolSizes = vPoolSizes.data();
+
+			VK_ASSERT(vkCreateDescriptorPool(vLogicalDevice, &vPoolCI, nullptr, &vPool), "Failed to create the bindless descriptor pool!");
+
+			VkDescriptorSetAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			vAI.pNext = VK_NULL_HANDLE;
+			vAI.descriptorPool = vPool;
+			vAI.descriptorSetCount = 1;
+			vAI.pSetLayouts = &vSetLayout;
+
+			VK_ASSERT(vkAllocateDescriptorSets(vLogicalDevice, &vAI, &vDescriptorSet), "Failed to allocate the bindless descriptor set!");
+		}
+
+		void VulkanBindlessTable::Terminate()
+		{
+			// Destroying the pool frees the set.
+			vkDestroyDescriptorPool(vLogicalDevice, vPool, nullptr);
+			vkDestroyPipelineLayout(vLogicalDevice, vPipelineLayout, nullptr);
+			vkDestroyDescriptorSetLayout(vLogicalDevice, vSetLayout, nullptr);
+
+			for (ResourceArray& array : mArrays)
+				array = ResourceArray();
+
+			vPool = VK_NULL_HANDLE;
+			vSetLayout = VK_NULL_HANDLE;
+			vPipelineLayout = VK_NULL_HANDLE;
+			vSetLayoutBindings.clear();
+			vDescriptorSet = VK_NULL_HANDLE;
+		}
+
+		void VulkanBindlessTable::BeginFrame()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFrameNumber++;
+
+			for (ResourceArray& array : mArrays)
+			{
+				// Retired in order, so the ones old enough are at the front.
+				auto itr = array.mRetiredHandles.begin();
+				while (itr != array.mRetiredHandles.end() && itr->first + mFrameCount <= mFrameNumber)
+				{
+					INSERT_INTO_VECTOR(array.mFreeHandles, itr->second);
+					itr++;
+				}
+
+				array.mRetiredHandles.erase(array.mRetiredHandles.begin(), itr);
+			}
+		}
+
+		UI32 VulkanBindlessTable::AddTexture(VkImageView vImageView, VkSampler vSampler, VkImageLayout vLayout)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			UI32 handle = AcquireHandle(VulkanBindlessResourceType::TEXTURE);
+			if (handle == VULKAN_BINDLESS_INVALID_HANDLE)
+				return handle;
+
+			VkDescriptorImageInfo vImageInfo = {};
+			vImageInfo.imageView = vImageView;
+			vImageInfo.sampler = vSampler;
+			vImageInfo.imageLayout = vLayout;
+
+			Write(VulkanBindlessResourceType::TEXTURE, handle, &vImageInfo, nullptr);
+			return handle;
+		}
+
+		UI32 VulkanBindlessTable::AddBuffer(VkBuffer vBuffer, VkDeviceSize offset, VkDeviceSize range)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			UI32 handle = AcquireHandle(VulkanBindlessResourceType::BUFFER);
+			if (handle == VULKAN_BINDLESS_INVALID_HANDLE)
+				return handle;
+
+			VkDescriptorBufferInfo vBufferInfo = {};
+			vBufferInfo.buffer = vBuffer;
+			vBufferInfo.offset = offset;
+			vBufferInfo.range = range;
+
+			Write(VulkanBindlessResourceType::BUFFER, handle, nullptr, &vBufferInfo);
+			return handle;
+		}
+
+		UI32 VulkanBindlessTable::AddStorageImage(VkImageView vImageView)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			UI32 handle = AcquireHandle(VulkanBindlessResourceType::STORAGE_IMAGE);
+			if (handle == VULKAN_BINDLESS_INVALID_HANDLE)
+				return handle;
+
+			VkDescriptorImageInfo vImageInfo = {};
+			vImageInfo.imageView = vImageView;
+			vImageInfo.sampler = VK_NULL_HANDLE;
+			vImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			Write(VulkanBindlessResourceType::STORAGE_IMAGE, handle, &vImageInfo, nullptr);
+			return handle;
+		}
+
+		void VulkanBindlessTable::Remove(VulkanBindlessResourceType type, UI32 handle)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			// The descriptor is left as is. Partially bound arrays never read it unless a shader indexes it.
+			INSERT_INTO_VECTOR(mArrays[static_cast<UI8>(type)].mRetiredHandles, std::make_pair(mFrameNumber, handle));
+		}
+
+		void VulkanBindlessTable::Bind(VkCommandBuffer vCommandBuffer, VkPipelineBindPoint vBindPoint, VkPipelineLayout vLayout) const
+		{
+			vkCmdBindDescriptorSets(vCommandBuffer, vBindPoint, vLayout != VK_NULL_HANDLE ? vLayout : vPipelineLayout, VULKAN_BINDLESS_SET, 1, &vDescriptorSet, 0, nullptr);
+		}
+
+		UI32 VulkanBindlessTable::AcquireHandle(VulkanBindlessResourceType type)
+		{
+			ResourceArray& array = mArrays[static_cast<UI8>(type)];
+			if (!array.mFreeHandles.empty())
+			{
+				UI32 handle = array.mFreeHandles.back();
+				array.mFreeHandles.pop_back();
+				return handle;
+			}
+
+			if (array.mNextHandle < array.mCapacity)
+				return array.mNextHandle++;
+
+			Logger::LogError(TEXT("The bindless resource array is full!"));
+			return VULKAN_BINDLESS_INVALID_HANDLE;
+		}
+
+		void VulkanBindlessTable::Write(VulkanBindlessResourceType type, UI32 handle, const VkDescriptorImageInfo* pImageInfo, const VkDescriptorBufferInfo* pBufferInfo)
+		{
+			VkWriteDescriptorSet vWrite = {};
+			vWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			vWrite.pNext = VK_NULL_HANDLE;
+			vWrite.dstSet = vDescriptorSet;
+			vWrite.dstBinding = static_cast<UI32>(type);
+			vWrite.dstArrayElement = handle;
+			vWrite.descriptorCount = 1;
+			vWrite.descriptorType = _Helpers::BindlessDescriptorTypes[static_cast<UI8>(type)];
+			vWrite.pImageInfo = pImageInfo;
+			vWrite.pBufferInfo = pBufferInfo;
+
+			// Update after bind allows writing while command buffers using the set are pending.
+			vkUpdateDescriptorSets(vLogicalDevice, 1, &vWrite, 0, nullptr);
+		}
+	}
+}
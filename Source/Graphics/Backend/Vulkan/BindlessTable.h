@@ -0,0 +1,164 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+/**
+ * The descriptor set shaders declare the bindless arrays in:
+ *	layout(set = 0, binding = 0) uniform sampler2D uTextures[];
+ *	layout(set = 0, binding = 1) buffer Buffers { ... } uBuffers[];
+ *	layout(set = 0, binding = 2, rgba8) uniform image2D uImages[];
+ * It is the first set, so every pipeline layout starting with it is compatible for it whatever its other sets are,
+ * and binding another pipeline never disturbs it.
+ */
+#define VULKAN_BINDLESS_SET					0
+
+/**
+ * The maximum capacity of each bindless array. Devices with lower limits get smaller arrays.
+ */
+#define VULKAN_BINDLESS_MAX_TEXTURES		(1 << 16)
+#define VULKAN_BINDLESS_MAX_BUFFERS			(1 << 16)
+#define VULKAN_BINDLESS_MAX_STORAGE_IMAGES	(1 << 12)
+
+#define VULKAN_BINDLESS_INVALID_HANDLE		UINT32_MAX
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Bindless Resource Type enum.
+		 * The binding of each array in the bindless set.
+		 */
+		enum class VulkanBindlessResourceType : UI8 {
+			TEXTURE,
+			BUFFER,
+			STORAGE_IMAGE,
+			MAX
+		};
+
+		/**
+		 * Vulkan Bindless Table object.
+		 * Keeps every texture, storage buffer and storage image in large update after bind, partially bound arrays of a
+		 * single descriptor set. The set is bound once per command buffer and shaders index the arrays with the handles
+		 * returned by the table, so draws never rebind descriptors.
+		 * Removed handles are reused only once every frame in flight which could still index them has completed.
+		 */
+		class VulkanBindlessTable {
+			/**
+			 * Resource array structure.
+			 */
+			struct ResourceArray {
+				std::vector<UI32> mFreeHandles;
+				std::vector<std::pair<UI64, UI32>> mRetiredHandles;	// Frame number and handle.
+				UI32 mCapacity = 0;
+				UI32 mNextHandle = 0;
+			};
+
+		public:
+			VulkanBindlessTable() {}
+			~VulkanBindlessTable() {}
+
+			/**
+			 * Initialize the table.
+			 *
+			 * @param vLogicalDevice: The logical device. Must have been created with the descriptor indexing features.
+			 * @param vProperties: The descriptor indexing properties of the physical device.
+			 * @param frameCount: The number of frames in flight.
+			 */
+			void Initialize(VkDevice vLogicalDevice, const VkPhysicalDeviceDescriptorIndexingProperties& vProperties, UI32 frameCount);
+
+			/**
+			 * Terminate the table.
+			 */
+			void Terminate();
+
+			/**
+			 * Begin a frame.
+			 * Handles removed long enough ago become available again.
+			 */
+			void BeginFrame();
+
+			void SetFrameCount(UI32 frameCount) { mFrameCount = frameCount; }
+
+			/**
+			 * Add a sampled texture.
+			 *
+			 * @param vImageView: The image view.
+			 * @param vSampler: The sampler.
+			 * @param vLayout: The layout the image is in when the shaders read it.
+			 * @return The handle. VULKAN_BINDLESS_INVALID_HANDLE if the array is full.
+			 */
+			UI32 AddTexture(VkImageView vImageView, VkSampler vSampler, VkImageLayout vLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+			/**
+			 * Add a storage buffer.
+			 *
+			 * @param vBuffer: The buffer.
+			 * @param offset: The offset of the range.
+			 * @param range: The size of the range.
+			 * @return The handle. VULKAN_BINDLESS_INVALID_HANDLE if the array is full.
+			 */
+			UI32 AddBuffer(VkBuffer vBuffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+			/**
+			 * Add a storage image.
+			 *
+			 * @param vImageView: The image view. The image must be in the general layout when the shaders access it.
+			 * @return The handle. VULKAN_BINDLESS_INVALID_HANDLE if the array is full.
+			 */
+			UI32 AddStorageImage(VkImageView vImageView);
+
+			/**
+			 * Remove a resource.
+			 * The resource itself may be destroyed once the frames in flight completed.
+			 *
+			 * @param type: The type of the resource.
+			 * @param handle: The handle returned when the resource was added.
+			 */
+			void Remove(VulkanBindlessResourceType type, UI32 handle);
+
+			/**
+			 * Bind the bindless set.
+			 * Pipeline layouts are only compatible for a set when their push constant ranges match too, so pipelines
+			 * with push constants bind the set again with their own layout.
+			 *
+			 * @param vCommandBuffer: The command buffer.
+			 * @param vBindPoint: The pipeline bind point.
+			 * @param vLayout: The pipeline layout. Must have been created with the layout of the table at VULKAN_BINDLESS_SET.
+			 * VK_NULL_HANDLE uses the layout of the table alone, which suits every pipeline without push constants.
+			 */
+			void Bind(VkCommandBuffer vCommandBuffer, VkPipelineBindPoint vBindPoint, VkPipelineLayout vLayout = VK_NULL_HANDLE) const;
+
+			VkDescriptorSetLayout GetSetLayout() const { return vSetLayout; }
+			const std::vector<VkDescriptorSetLayoutBinding>& GetSetLayoutBindings() const { return vSetLayoutBindings; }
+			VkPipelineLayout GetPipelineLayout() const { return vPipelineLayout; }
+			VkDescriptorSet GetDescriptorSet() const { return vDescriptorSet; }
+			UI32 GetCapacity(VulkanBindlessResourceType type) const { return mArrays[static_cast<UI8>(type)].mCapacity; }
+
+		private:
+			UI32 AcquireHandle(VulkanBindlessResourceType type);
+			void Write(VulkanBindlessResourceType type, UI32 handle, const VkDescriptorImageInfo* pImageInfo, const VkDescriptorBufferInfo* pBufferInfo);
+
+		private:
+			ResourceArray mArrays[static_cast<UI8>(VulkanBindlessResourceType::MAX)] = {};
+			std::mutex mMutex;
+
+			std::vector<VkDescriptorSetLayoutBinding> vSetLayoutBindings;
+			VkDescriptorSetLayout vSetLayout = VK_NULL_HANDLE;
+			VkPipelineLayout vPipelineLayout = VK_NULL_HANDLE;
+			VkDescriptorPool vPool = VK_NULL_HANDLE;
+			VkDescriptorSet vDescriptorSet = VK_NULL_HANDLE;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+			UI64 mFrameNumber = 0;
+			UI32 mFrameCount = 0;
+		};
+	}
+}
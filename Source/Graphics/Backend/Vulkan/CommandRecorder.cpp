@@ -0,0 +1,177 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CommandRecorder.h"
+#include "Macros.h"
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		void VulkanCommandRecorder::Initialize(VkDevice vLogicalDevice, UI32 queueFamily, UI32 frameCount, UI32 threadCount)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+			this->mQueueFamily = queueFamily;
+			this->mFrameCount = frameCount;
+
+			mThreadPool.Initialize(threadCount);
+		}
+
+		void VulkanCommandRecorder::Terminate()
+		{
+			mThreadPool.Wait();
+			mThreadPool.Terminate();
+
+			for (auto& pContext : pThreadContexts)
+				for (FramePool& pool : pContext->mFramePools)
+					DestroyFramePool(&pool);
+
+			pThreadContexts.clear();
+			mThreadIndexes.clear();
+			vRecordedCommandBuffers.clear();
+		}
+
+		void VulkanCommandRecorder::SetFrameCount(UI32 frameCount)
+		{
+			mThreadPool.Wait();
+
+			for (auto& pContext : pThreadContexts)
+			{
+				for (FramePool& pool : pContext->mFramePools)
+					DestroyFramePool(&pool);
+
+				pContext->mFramePools.clear();
+				for (UI32 i = 0; i < frameCount; i++)
+					INSERT_INTO_VECTOR(pContext->mFramePools, CreateFramePool());
+			}
+
+			vRecordedCommandBuffers.clear();
+			mFrameCount = frameCount;
+			mFrameIndex = 0;
+		}
+
+		void VulkanCommandRecorder::BeginFrame(UI32 frameIndex)
+		{
+			// Recordings of the previous frame which were never executed are dropped.
+			mThreadPool.Wait();
+			vRecordedCommandBuffers.clear();
+
+			mFrameIndex = frameIndex;
+			for (auto& pContext : pThreadContexts)
+			{
+				FramePool& pool = pContext->mFramePools[frameIndex];
+				if (pool.mUsedCount == 0)
+					continue;
+
+				vkResetCommandPool(vLogicalDevice, pool.vCommandPool, VK_NULL_HANDLE);
+				pool.mUsedCount = 0;
+			}
+		}
+
+		void VulkanCommandRecorder::Record(VkRenderPass vRenderPass, UI32 subpass, VkFramebuffer vFrameBuffer, std::function<void(VkCommandBuffer)>&& function)
+		{
+			vRecordedCommandBuffers.push_back(VK_NULL_HANDLE);
+			VkCommandBuffer* pCommandBuffer = &vRecordedCommandBuffers.back();
+
+			mThreadPool.Submit([this, pCommandBuffer, vRenderPass, subpass, vFrameBuffer, function = std::move(function)]
+				{
+					VkCommandBuffer vCommandBuffer = GetCommandBuffer(GetThreadContext());
+
+					VkCommandBufferInheritanceInfo vInheritanceInfo = {};
+					vInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+					vInheritanceInfo.pNext = VK_NULL_HANDLE;
+					vInheritanceInfo.renderPass = vRenderPass;
+					vInheritanceInfo.subpass = subpass;
+					vInheritanceInfo.framebuffer = vFrameBuffer;
+
+					VkCommandBufferBeginInfo vBeginInfo = {};
+					vBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+					vBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+					vBeginInfo.pNext = VK_NULL_HANDLE;
+					vBeginInfo.pInheritanceInfo = &vInheritanceInfo;
+
+					if (vRenderPass != VK_NULL_HANDLE)
+						vBeginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+					VK_ASSERT(vkBeginCommandBuffer(vCommandBuffer, &vBeginInfo), "Failed to begin the secondary command buffer!");
+					function(vCommandBuffer);
+					VK_ASSERT(vkEndCommandBuffer(vCommandBuffer), "Failed to end the secondary command buffer!");
+
+					*pCommandBuffer = vCommandBuffer;
+				});
+		}
+
+		void VulkanCommandRecorder::Execute(VkCommandBuffer vPrimaryCommandBuffer)
+		{
+			mThreadPool.Wait();
+
+			vExecuteCommandBuffers.assign(vRecordedCommandBuffers.begin(), vRecordedCommandBuffers.end());
+			vRecordedCommandBuffers.clear();
+
+			if (vExecuteCommandBuffers.empty())
+				return;
+
+			vkCmdExecuteCommands(vPrimaryCommandBuffer, static_cast<UI32>(vExecuteCommandBuffers.size()), vExecuteCommandBuffers.data());
+		}
+
+		VulkanCommandRecorder::ThreadContext* VulkanCommandRecorder::GetThreadContext()
+		{
+			std::lock_guard<std::mutex> lock(mContextMutex);
+
+			auto itr = mThreadIndexes.find(std::this_thread::get_id());
+			if (itr != mThreadIndexes.end())
+				return pThreadContexts[itr->second].get();
+
+			// First recording of this thread. The render thread gets a context too, as it executes tasks while waiting.
+			auto pContext = std::make_unique<ThreadContext>();
+			for (UI32 i = 0; i < mFrameCount; i++)
+				INSERT_INTO_VECTOR(pContext->mFramePools, CreateFramePool());
+
+			mThreadIndexes[std::this_thread::get_id()] = static_cast<UI32>(pThreadContexts.size());
+			INSERT_INTO_VECTOR(pThreadContexts, std::move(pContext));
+			return pThreadContexts.back().get();
+		}
+
+		VkCommandBuffer VulkanCommandRecorder::GetCommandBuffer(ThreadContext* pContext)
+		{
+			FramePool& pool = pContext->mFramePools[mFrameIndex];
+			if (pool.mUsedCount < pool.vCommandBuffers.size())
+				return pool.vCommandBuffers[pool.mUsedCount++];
+
+			VkCommandBufferAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			vAI.pNext = VK_NULL_HANDLE;
+			vAI.commandPool = pool.vCommandPool;
+			vAI.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			vAI.commandBufferCount = 1;
+
+			VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE;
+			VK_ASSERT(vkAllocateCommandBuffers(vLogicalDevice, &vAI, &vCommandBuffer), "Failed to allocate the secondary command buffer!");
+
+			INSERT_INTO_VECTOR(pool.vCommandBuffers, vCommandBuffer);
+			pool.mUsedCount++;
+			return vCommandBuffer;
+		}
+
+		VulkanCommandRecorder::FramePool VulkanCommandRecorder::CreateFramePool()
+		{
+			FramePool pool = {};
+
+			VkCommandPoolCreateInfo vPoolCI = {};
+			vPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			vPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			vPoolCI.pNext = VK_NULL_HANDLE;
+			vPoolCI.queueFamilyIndex = mQueueFamily;
+
+			VK_ASSERT(vkCreateCommandPool(vLogicalDevice, &vPoolCI, nullptr, &pool.vCommandPool), "Failed to create the recording command pool!");
+			return pool;
+		}
+
+		void VulkanCommandRecorder::DestroyFramePool(FramePool* pPool)
+		{
+			// Destroying the pool frees its command buffers.
+			vkDestroyCommandPool(vLogicalDevice, pPool->vCommandPool, nullptr);
+			*pPool = FramePool();
+		}
+	}
+}
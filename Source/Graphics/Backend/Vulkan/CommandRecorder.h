@@ -0,0 +1,122 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Threading/ThreadPool.h"
+
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Command Recorder object.
+		 * Records secondary command buffers on worker threads. Every thread which records owns one command pool per
+		 * frame in flight, so recording never contends on a pool, and the pools of a frame are reset wholesale when the
+		 * frame begins instead of freeing command buffers one by one.
+		 * Recordings are executed in the order they were submitted, regardless of which thread finished first.
+		 */
+		class VulkanCommandRecorder {
+			/**
+			 * Frame pool structure.
+			 * The command pool of a single thread for a single frame, with the secondary buffers allocated from it.
+			 */
+			struct FramePool {
+				VkCommandPool vCommandPool = VK_NULL_HANDLE;
+				std::vector<VkCommandBuffer> vCommandBuffers;
+				UI32 mUsedCount = 0;
+			};
+
+			/**
+			 * Thread context structure.
+			 */
+			struct ThreadContext {
+				std::vector<FramePool> mFramePools;
+			};
+
+		public:
+			VulkanCommandRecorder() {}
+			~VulkanCommandRecorder() {}
+
+			/**
+			 * Initialize the recorder.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 * @param queueFamily: The queue family the primary command buffers are submitted to.
+			 * @param frameCount: The number of frames in flight.
+			 * @param threadCount: The number of recording threads. 0 uses the hardware concurrency.
+			 */
+			void Initialize(VkDevice vLogicalDevice, UI32 queueFamily, UI32 frameCount, UI32 threadCount = 0);
+
+			/**
+			 * Terminate the recorder.
+			 * Waits for the recordings. The command buffers must not be in use by the GPU.
+			 */
+			void Terminate();
+
+			/**
+			 * Set the number of frames in flight.
+			 * Recreates the command pools. The command buffers must not be in use by the GPU.
+			 *
+			 * @param frameCount: The frame count.
+			 */
+			void SetFrameCount(UI32 frameCount);
+
+			/**
+			 * Begin a frame.
+			 * Resets every command pool of the frame. The GPU must be done with the frame's previous submission.
+			 *
+			 * @param frameIndex: The index of the frame in flight.
+			 */
+			void BeginFrame(UI32 frameIndex);
+
+			/**
+			 * Record a secondary command buffer on a worker thread.
+			 * Must be called from the render thread. The command buffer is begun and ended by the recorder.
+			 *
+			 * @param vRenderPass: The render pass the commands are executed in. VK_NULL_HANDLE for commands executed
+			 * outside of a render pass.
+			 * @param subpass: The subpass the commands are executed in.
+			 * @param vFrameBuffer: The frame buffer the commands are executed with. Optional.
+			 * @param function: The function recording the commands.
+			 */
+			void Record(VkRenderPass vRenderPass, UI32 subpass, VkFramebuffer vFrameBuffer, std::function<void(VkCommandBuffer)>&& function);
+
+			/**
+			 * Execute the recordings submitted since the last call in a primary command buffer.
+			 * Waits for the recordings and executes them in submission order. Recordings made for a render pass must be
+			 * executed in a subpass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+			 *
+			 * @param vPrimaryCommandBuffer: The primary command buffer being recorded.
+			 */
+			void Execute(VkCommandBuffer vPrimaryCommandBuffer);
+
+			UI32 GetThreadCount() const { return mThreadPool.GetThreadCount(); }
+
+		private:
+			ThreadContext* GetThreadContext();
+			VkCommandBuffer GetCommandBuffer(ThreadContext* pContext);
+
+			FramePool CreateFramePool();
+			void DestroyFramePool(FramePool* pPool);
+
+		private:
+			ThreadPool mThreadPool = {};
+
+			std::unordered_map<std::thread::id, UI32> mThreadIndexes;
+			std::vector<std::unique_ptr<ThreadContext>> pThreadContexts;
+			std::mutex mContextMutex;
+
+			std::deque<VkCommandBuffer> vRecordedCommandBuffers;		// Submission order. Elements are written by the workers.
+			std::vector<VkCommandBuffer> vExecuteCommandBuffers;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+			UI32 mQueueFamily = 0;
+			UI32 mFrameCount = 0;
+			UI32 mFrameIndex = 0;
+		};
+	}
+}
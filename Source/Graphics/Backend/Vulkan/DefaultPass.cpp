@@ -0,0 +1,310 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DefaultPass.h"
+#include "VulkanDevice.h"
+#include "Macros.h"
+#include "RenderTarget/VulkanRenderTarget.h"
+#include "Core/Types/Utilities.h"
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Copy shader code into owned memory.
+			 * Compiling moves the shaders into the pipeline specification, and a stage which did not change is
+			 * compiled again along with the one that did.
+			 *
+			 * @param shaderCode: The shader code.
+			 * @return The copy.
+			 */
+			ShaderCode CopyShaderCode(const ShaderCode& shaderCode)
+			{
+				ShaderCode copy = {};
+				copy.SetCode(std::vector<UI32>(shaderCode.GetCode(), shaderCode.GetCode() + shaderCode.GetWordCount()), shaderCode.GetType(), shaderCode.GetStage());
+
+				ShaderReflection reflection = shaderCode.GetReflection();
+				copy.SetReflection(std::move(reflection));
+				return copy;
+			}
+		}
+
+		void VulkanDefaultPass::Initialize(VulkanDevice* pDevice)
+		{
+			this->pDevice = pDevice;
+			mGraph.Initialize(pDevice);
+			mIsDirty = true;
+
+			pPipeline = pDevice->mPipelineCompiler.CreatePipeline();
+		}
+
+		void VulkanDefaultPass::Terminate()
+		{
+			// Retired to the compiler, which destroys it when it terminates.
+			pDevice->mPipelineCompiler.DestroyPipeline(pPipeline);
+			pPipeline = nullptr;
+			vPipelineRenderPass = VK_NULL_HANDLE;
+			mShaders.clear();
+
+			ReleaseFramebuffers();
+
+			for (const auto& renderPass : vRenderPasses)
+				vkDestroyRenderPass(pDevice->vLogicalDevice, renderPass.second, nullptr);
+
+			vRenderPasses.clear();
+			mGraph.Terminate();
+			pDevice = nullptr;
+		}
+
+		void VulkanDefaultPass::ReleaseFramebuffers()
+		{
+			for (const auto& framebuffer : vFramebuffers)
+				vkDestroyFramebuffer(pDevice->vLogicalDevice, framebuffer.second, nullptr);
+
+			vFramebuffers.clear();
+		}
+
+		void VulkanDefaultPass::SetShader(ShaderCode&& shaderCode)
+		{
+			if (shaderCode.GetStage() != ShaderStage::VERTEX && shaderCode.GetStage() != ShaderStage::FRAGMENT)
+			{
+				Logger::LogError(TEXT("The display shader only has a vertex and a fragment stage!"));
+				return;
+			}
+
+			if (!shaderCode.HasReflection())
+			{
+				Logger::LogError(TEXT("The display shader must be reflected to derive its pipeline layout!"));
+				return;
+			}
+
+			// Nothing allocates descriptor sets for the display shader, it can only read what the device binds.
+			for (const ShaderDescriptorBinding& binding : shaderCode.GetReflection().mDescriptorBindings)
+			{
+				if (!pDevice->mPipelineLayoutCache.IsFixedSet(binding.mSet))
+				{
+					Logger::LogError((TEXT("The display shader can only bind resources in the fixed sets! Unsupported binding: ") + StringToWString(binding.mName)).c_str());
+					return;
+				}
+			}
+
+			mShaders[shaderCode.GetStage()] = std::move(shaderCode);
+			CompilePipeline();
+		}
+
+		void VulkanDefaultPass::Record(VkCommandBuffer vCommandBuffer, VulkanGpuProfiler* pProfiler)
+		{
+			// The swap chain image may be missing for a frame, and an imported image which no pass uses would never be
+			// transitioned.
+			if (mIsDirty || mHasSwapChainImage != pDevice->mHasSwapChainImage)
+			{
+				if (!Build())
+					return;
+			}
+
+			if (mHasSwapChainImage)
+			{
+				SwapChain& swapChain = pDevice->pScreenTarget->GetSwapChain();
+				mGraph.SetImportedImage(mSwapChainImage, swapChain.GetImages()[pDevice->GetImageIndex()], swapChain.GetImageViews()[pDevice->GetImageIndex()]);
+			}
+
+			mGraph.Execute(vCommandBuffer, pProfiler);
+
+			for (VulkanRenderTargetOS* pTarget : pDevice->pOffScreenTargets)
+				pTarget->vColorLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		}
+
+		bool VulkanDefaultPass::Build()
+		{
+			mGraph.Reset();
+			mSwapChainImage = VULKAN_RENDER_GRAPH_INVALID_RESOURCE;
+			mHasSwapChainImage = pDevice->mHasSwapChainImage;
+			mIsDirty = false;
+
+			// Left ready to be read back.
+			for (VulkanRenderTargetOS* pTarget : pDevice->pOffScreenTargets)
+			{
+				const UI32 image = mGraph.ImportImage("Off Screen Color", pTarget->GetColorImage(), pTarget->GetColorImageView(), pTarget->GetColorFormat(), pTarget->GetExtent(),
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+				const VkRenderPass vRenderPass = GetRenderPass(pTarget->GetColorFormat());
+				mGraph.AddPass("Clear Off Screen", [this, vRenderPass, image](VkCommandBuffer vCommandBuffer, const VulkanRenderGraph& graph)
+					{
+						RecordClear(vCommandBuffer, vRenderPass, graph.GetImageView(image), graph.GetExtent(image));
+					}).Write(image, VulkanRenderGraphAccess::COLOR_ATTACHMENT);
+			}
+
+			// The handles are set every frame, once the image was acquired.
+			if (mHasSwapChainImage)
+			{
+				SwapChain& swapChain = pDevice->pScreenTarget->GetSwapChain();
+				mSwapChainImage = mGraph.ImportImage("Swap Chain Image", VK_NULL_HANDLE, VK_NULL_HANDLE, swapChain.GetFormat(), swapChain.GetExtent(),
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+				const VkRenderPass vRenderPass = GetRenderPass(swapChain.GetFormat());
+				const UI32 image = mSwapChainImage;
+				mGraph.AddPass("Clear Swap Chain", [this, vRenderPass, image](VkCommandBuffer vCommandBuffer, const VulkanRenderGraph& graph)
+					{
+						RecordClear(vCommandBuffer, vRenderPass, graph.GetImageView(image), graph.GetExtent(image));
+					}).Write(image, VulkanRenderGraphAccess::COLOR_ATTACHMENT);
+			}
+
+			if (!mGraph.Compile())
+			{
+				Logger::LogError(TEXT("Failed to compile the default pass!"));
+				mIsDirty = true;
+				return false;
+			}
+
+			// The primary target changed format, so the pipeline no longer matches its render pass.
+			const VkFormat vFormat = GetPrimaryFormat();
+			if (vFormat != VK_FORMAT_UNDEFINED && GetRenderPass(vFormat) != vPipelineRenderPass)
+				CompilePipeline();
+
+			return true;
+		}
+
+		void VulkanDefaultPass::CompilePipeline()
+		{
+			const VkFormat vFormat = GetPrimaryFormat();
+			if (vFormat == VK_FORMAT_UNDEFINED || mShaders.find(ShaderStage::VERTEX) == mShaders.end() || mShaders.find(ShaderStage::FRAGMENT) == mShaders.end())
+				return;
+
+			VulkanPipelineSpecification specification = {};
+			for (const auto& shader : mShaders)
+				specification.mShaders.push_back(_Helpers::CopyShaderCode(shader.second));
+
+			// A full screen triangle, generated from the vertex index.
+			specification.vRenderPass = GetRenderPass(vFormat);
+			specification.vCullMode = VK_CULL_MODE_NONE;
+			specification.mEnableDepthTest = false;
+			specification.mEnableDepthWrite = false;
+
+			vPipelineRenderPass = specification.vRenderPass;
+			pDevice->mPipelineCompiler.Compile(pPipeline, std::move(specification));
+		}
+
+		VkFormat VulkanDefaultPass::GetPrimaryFormat() const
+		{
+			if (pDevice->pScreenTarget)
+				return pDevice->pScreenTarget->GetSwapChain().GetFormat();
+
+			if (!pDevice->pOffScreenTargets.empty())
+				return pDevice->pOffScreenTargets.front()->GetColorFormat();
+
+			return VK_FORMAT_UNDEFINED;
+		}
+
+		VkRenderPass VulkanDefaultPass::GetRenderPass(VkFormat vFormat)
+		{
+			auto itr = vRenderPasses.find(vFormat);
+			if (itr != vRenderPasses.end())
+				return itr->second;
+
+			// The graph transitions the attachment before and after the render pass.
+			VkAttachmentDescription vAttachment = {};
+			vAttachment.flags = VK_NULL_HANDLE;
+			vAttachment.format = vFormat;
+			vAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+			vAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			vAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+			vAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			vAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			vAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			vAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+			VkAttachmentReference vReference = {};
+			vReference.attachment = 0;
+			vReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+			VkSubpassDescription vSubpass = {};
+			vSubpass.flags = VK_NULL_HANDLE;
+			vSubpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			vSubpass.colorAttachmentCount = 1;
+			vSubpass.pColorAttachments = &vReference;
+
+			VkRenderPassCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.attachmentCount = 1;
+			vCI.pAttachments = &vAttachment;
+			vCI.subpassCount = 1;
+			vCI.pSubpasses = &vSubpass;
+
+			VkRenderPass vRenderPass = VK_NULL_HANDLE;
+			VK_ASSERT(vkCreateRenderPass(pDevice->vLogicalDevice, &vCI, nullptr, &vRenderPass), "Failed to create the default render pass!");
+
+			vRenderPasses[vFormat] = vRenderPass;
+			return vRenderPass;
+		}
+
+		VkFramebuffer VulkanDefaultPass::GetFramebuffer(VkRenderPass vRenderPass, VkImageView vImageView, VkExtent2D vExtent)
+		{
+			auto itr = vFramebuffers.find(vImageView);
+			if (itr != vFramebuffers.end())
+				return itr->second;
+
+			VkFramebufferCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.renderPass = vRenderPass;
+			vCI.attachmentCount = 1;
+			vCI.pAttachments = &vImageView;
+			vCI.width = vExtent.width;
+			vCI.height = vExtent.height;
+			vCI.layers = 1;
+
+			VkFramebuffer vFramebuffer = VK_NULL_HANDLE;
+			VK_ASSERT(vkCreateFramebuffer(pDevice->vLogicalDevice, &vCI, nullptr, &vFramebuffer), "Failed to create the default framebuffer!");
+
+			vFramebuffers[vImageView] = vFramebuffer;
+			return vFramebuffer;
+		}
+
+		void VulkanDefaultPass::RecordClear(VkCommandBuffer vCommandBuffer, VkRenderPass vRenderPass, VkImageView vImageView, VkExtent2D vExtent)
+		{
+			VkClearValue vClearValue = {};
+			vClearValue.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+			VkRenderPassBeginInfo vBeginInfo = {};
+			vBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			vBeginInfo.pNext = VK_NULL_HANDLE;
+			vBeginInfo.renderPass = vRenderPass;
+			vBeginInfo.framebuffer = GetFramebuffer(vRenderPass, vImageView, vExtent);
+			vBeginInfo.renderArea.extent = vExtent;
+			vBeginInfo.clearValueCount = 1;
+			vBeginInfo.pClearValues = &vClearValue;
+
+			vkCmdBeginRenderPass(vCommandBuffer, &vBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			// Every target of the primary format draws the display shader, the rest are only cleared.
+			if (pPipeline->IsReady() && vRenderPass == vPipelineRenderPass)
+			{
+				vkCmdBindPipeline(vCommandBuffer, pPipeline->GetBindPoint(), pPipeline->GetPipeline());
+
+				// Push constant ranges make the layout incompatible with the one the table was bound with.
+				if (pDevice->mIsBindlessEnabled)
+					pDevice->mBindlessTable.Bind(vCommandBuffer, pPipeline->GetBindPoint(), pPipeline->GetLayout());
+
+				VkViewport vViewport = {};
+				vViewport.width = static_cast<float>(vExtent.width);
+				vViewport.height = static_cast<float>(vExtent.height);
+				vViewport.maxDepth = 1.0f;
+				vkCmdSetViewport(vCommandBuffer, 0, 1, &vViewport);
+
+				VkRect2D vScissor = {};
+				vScissor.extent = vExtent;
+				vkCmdSetScissor(vCommandBuffer, 0, 1, &vScissor);
+
+				vkCmdDraw(vCommandBuffer, 3, 1, 0, 0);
+			}
+
+			vkCmdEndRenderPass(vCommandBuffer);
+		}
+	}
+}
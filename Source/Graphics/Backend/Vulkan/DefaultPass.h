@@ -0,0 +1,97 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "RenderGraph.h"
+#include "PipelineCompiler.h"
+
+#include <map>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Default Pass object.
+		 * The work the device records every frame, declared as a render graph: every off-screen target and the
+		 * acquired swap chain image is cleared in a render pass, and the display shader is drawn as a full screen
+		 * triangle into the primary target. The graph places the layout transitions, leaving off-screen targets ready
+		 * to be read back and the swap chain image ready to be presented.
+		 * The graph only imports resources, so rebuilding it never has to wait for the GPU.
+		 */
+		class VulkanDefaultPass {
+		public:
+			VulkanDefaultPass() {}
+			~VulkanDefaultPass() {}
+
+			/**
+			 * Initialize the pass.
+			 *
+			 * @param pDevice: The device.
+			 */
+			void Initialize(VulkanDevice* pDevice);
+
+			/**
+			 * Terminate the pass.
+			 * The GPU must be done with every frame the pass was recorded in.
+			 */
+			void Terminate();
+
+			/**
+			 * Rebuild the graph before it is recorded next, after render targets were added or removed.
+			 */
+			void Invalidate() { mIsDirty = true; }
+
+			/**
+			 * Destroy the framebuffers, before the image views they use are destroyed.
+			 * The GPU must be done with every frame the pass was recorded in.
+			 */
+			void ReleaseFramebuffers();
+
+			/**
+			 * Set a stage of the display shader.
+			 * The pipeline is compiled in the background once both the vertex and fragment stages are set, and the
+			 * targets are only cleared until it is ready.
+			 *
+			 * @param shaderCode: The reflected SPIR-V shader code, moved in.
+			 */
+			void SetShader(ShaderCode&& shaderCode);
+
+			/**
+			 * Record the pass.
+			 *
+			 * @param vCommandBuffer: The command buffer of the frame.
+			 * @param pProfiler: The profiler timing the passes. Optional.
+			 */
+			void Record(VkCommandBuffer vCommandBuffer, VulkanGpuProfiler* pProfiler = nullptr);
+
+			const VulkanRenderGraph& GetRenderGraph() const { return mGraph; }
+
+		private:
+			bool Build();
+			void CompilePipeline();
+
+			VkFormat GetPrimaryFormat() const;
+
+			VkRenderPass GetRenderPass(VkFormat vFormat);
+			VkFramebuffer GetFramebuffer(VkRenderPass vRenderPass, VkImageView vImageView, VkExtent2D vExtent);
+
+			void RecordClear(VkCommandBuffer vCommandBuffer, VkRenderPass vRenderPass, VkImageView vImageView, VkExtent2D vExtent);
+
+		private:
+			VulkanRenderGraph mGraph = {};
+			std::map<VkFormat, VkRenderPass> vRenderPasses;
+			std::map<VkImageView, VkFramebuffer> vFramebuffers;
+
+			std::map<ShaderStage, ShaderCode> mShaders;
+			VulkanPipelineHandle* pPipeline = nullptr;
+			VkRenderPass vPipelineRenderPass = VK_NULL_HANDLE;	// The render pass the pipeline was compiled for.
+
+			VulkanDevice* pDevice = nullptr;
+			UI32 mSwapChainImage = VULKAN_RENDER_GRAPH_INVALID_RESOURCE;
+			bool mHasSwapChainImage = false;		// Whether the graph was built with the swap chain image.
+			bool mIsDirty = true;
+		};
+	}
+}
@@ -0,0 +1,229 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DescriptorAllocator.h"
+#include "ShaderModule.h"
+#include "Macros.h"
+
+#include <algorithm>
+#include <map>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Descriptors per set used until a shader is registered.
+			 */
+			constexpr std::pair<VkDescriptorType, UI32> DefaultDescriptorRatios[] = {
+				{ VK_DESCRIPTOR_TYPE_SAMPLER, 1 },
+				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+				{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2 },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+				{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1 },
+			};
+		}
+
+		void VulkanDescriptorAllocator::Initialize(VkDevice vLogicalDevice, UI32 frameCount)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+			mTransientChains.resize(frameCount);
+		}
+
+		void VulkanDescriptorAllocator::Terminate()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			DestroyChain(&mPersistentChain);
+			for (PoolChain& chain : mTransientChains)
+				DestroyChain(&chain);
+
+			mTransientChains.clear();
+		}
+
+		void VulkanDescriptorAllocator::SetFrameCount(UI32 frameCount)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			for (PoolChain& chain : mTransientChains)
+				DestroyChain(&chain);
+
+			mTransientChains.clear();
+			mTransientChains.resize(frameCount);
+			mFrameIndex = 0;
+		}
+
+		void VulkanDescriptorAllocator::RegisterShaders(const std::vector<const ShaderCode*>& shaders)
+		{
+			// Set -> binding -> type and count. Bindings shared by several stages are counted once.
+			std::map<UI32, std::map<UI32, std::pair<VkDescriptorType, UI32>>> sets;
+			for (const ShaderCode* pShaderCode : shaders)
+			{
+				if (!pShaderCode->HasReflection())
+					continue;
+
+				for (const ShaderDescriptorBinding& binding : pShaderCode->GetReflection().mDescriptorBindings)
+				{
+					auto& entry = sets[binding.mSet][binding.mBinding];
+					entry.first = GetDescriptorType(binding.mType);
+					entry.second = std::max(entry.second, std::max(binding.mCount, 1U));
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (const auto& set : sets)
+			{
+				UI32 counts[VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT + 1] = {};
+				for (const auto& binding : set.second)
+					if (binding.second.first <= VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
+						counts[binding.second.first] += binding.second.second;
+
+				for (UI32 type = 0; type <= VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT; type++)
+				{
+					mDescriptorCounts[type] += counts[type];
+					mMaxDescriptorCounts[type] = std::max(mMaxDescriptorCounts[type], counts[type]);
+				}
+
+				mSetCount++;
+			}
+		}
+
+		void VulkanDescriptorAllocator::BeginFrame(UI32 frameIndex)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			mFrameIndex = frameIndex;
+			ResetChain(&mTransientChains[frameIndex]);
+		}
+
+		bool VulkanDescriptorAllocator::Allocate(VkDescriptorSetLayout vLayout, VkDescriptorSet* pDescriptorSet)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return Allocate(&mPersistentChain, vLayout, pDescriptorSet);
+		}
+
+		bool VulkanDescriptorAllocator::AllocateTransient(VkDescriptorSetLayout vLayout, VkDescriptorSet* pDescriptorSet)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return Allocate(&mTransientChains[mFrameIndex], vLayout, pDescriptorSet);
+		}
+
+		UI32 VulkanDescriptorAllocator::GetPoolCount() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			UI64 count = mPersistentChain.vPools.size();
+			for (const PoolChain& chain : mTransientChains)
+				count += chain.vPools.size();
+
+			return static_cast<UI32>(count);
+		}
+
+		bool VulkanDescriptorAllocator::Allocate(PoolChain* pChain, VkDescriptorSetLayout vLayout, VkDescriptorSet* pDescriptorSet)
+		{
+			VkDescriptorSetAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			vAI.pNext = VK_NULL_HANDLE;
+			vAI.descriptorSetCount = 1;
+			vAI.pSetLayouts = &vLayout;
+
+			while (true)
+			{
+				// The chain is exhausted, grow it.
+				bool isNewPool = false;
+				if (pChain->mCurrent == pChain->vPools.size())
+				{
+					UI32 setCount = std::min(VULKAN_DESCRIPTOR_SETS_PER_POOL << std::min(pChain->mCurrent, 16U), VULKAN_DESCRIPTOR_MAX_SETS_PER_POOL);
+					INSERT_INTO_VECTOR(pChain->vPools, CreatePool(setCount));
+					isNewPool = true;
+				}
+
+				vAI.descriptorPool = pChain->vPools[pChain->mCurrent];
+				VkResult vResult = vkAllocateDescriptorSets(vLogicalDevice, &vAI, pDescriptorSet);
+				if (vResult == VK_SUCCESS)
+					return true;
+
+				if (vResult != VK_ERROR_OUT_OF_POOL_MEMORY && vResult != VK_ERROR_FRAGMENTED_POOL)
+				{
+					Logger::LogError(TEXT("Failed to allocate the descriptor set!"));
+					return false;
+				}
+
+				// An empty pool which can not hold the set means the layout was never registered.
+				if (isNewPool)
+				{
+					Logger::LogError(TEXT("The descriptor set does not fit in an empty pool! Register the shaders of its layout with the allocator."));
+					return false;
+				}
+
+				pChain->mCurrent++;
+			}
+		}
+
+		VkDescriptorPool VulkanDescriptorAllocator::CreatePool(UI32 setCount)
+		{
+			std::vector<VkDescriptorPoolSize> vPoolSizes;
+			if (mSetCount == 0)
+			{
+				for (const auto& ratio : _Helpers::DefaultDescriptorRatios)
+				{
+					VkDescriptorPoolSize vSize = {};
+					vSize.type = ratio.first;
+					vSize.descriptorCount = ratio.second * setCount;
+					INSERT_INTO_VECTOR(vPoolSizes, vSize);
+				}
+			}
+			else
+			{
+				for (UI32 type = 0; type <= VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT; type++)
+				{
+					if (mDescriptorCounts[type] == 0)
+						continue;
+
+					// The average registered set, but always enough for the largest one.
+					UI64 count = (mDescriptorCounts[type] * setCount + mSetCount - 1) / mSetCount;
+
+					VkDescriptorPoolSize vSize = {};
+					vSize.type = static_cast<VkDescriptorType>(type);
+					vSize.descriptorCount = static_cast<UI32>(std::max<UI64>(count, mMaxDescriptorCounts[type]));
+					INSERT_INTO_VECTOR(vPoolSizes, vSize);
+				}
+			}
+
+			VkDescriptorPoolCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.maxSets = setCount;
+			vCI.poolSizeCount = static_cast<UI32>(vPoolSizes.size());
+			vCI.pPoolSizes = vPoolSizes.data();
+
+			VkDescriptorPool vPool = VK_NULL_HANDLE;
+			VK_ASSERT(vkCreateDescriptorPool(vLogicalDevice, &vCI, nullptr, &vPool), "Failed to create the descriptor pool!");
+
+			return vPool;
+		}
+
+		void VulkanDescriptorAllocator::ResetChain(PoolChain* pChain)
+		{
+			// Pools past the current one were never allocated from.
+			for (UI32 i = 0; i <= pChain->mCurrent && i < pChain->vPools.size(); i++)
+				vkResetDescriptorPool(vLogicalDevice, pChain->vPools[i], VK_NULL_HANDLE);
+
+			pChain->mCurrent = 0;
+		}
+
+		void VulkanDescriptorAllocator::DestroyChain(PoolChain* pChain)
+		{
+			for (VkDescriptorPool vPool : pChain->vPools)
+				vkDestroyDescriptorPool(vLogicalDevice, vPool, nullptr);
+
+			*pChain = PoolChain();
+		}
+	}
+}
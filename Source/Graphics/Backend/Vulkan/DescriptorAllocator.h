@@ -0,0 +1,122 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Objects/ShaderCode.h"
+
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+/**
+ * The number of sets the first pool of a chain holds. Every pool added to a chain holds twice as many as the
+ * previous one, up to the maximum.
+ */
+#define VULKAN_DESCRIPTOR_SETS_PER_POOL			64
+#define VULKAN_DESCRIPTOR_MAX_SETS_PER_POOL		4096
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Descriptor Allocator object.
+		 * Allocates descriptor sets from chains of descriptor pools. When a pool runs out of memory the next one in the
+		 * chain is used, and a larger pool is added when the chain is exhausted. Pools are sized from the reflected
+		 * layouts registered with the allocator, so their descriptor counts follow what the shaders actually bind.
+		 * Sets are never freed individually: persistent sets live until the allocator is terminated, and transient sets
+		 * live for a single frame, after which the pools of the frame are reset as a whole.
+		 */
+		class VulkanDescriptorAllocator {
+			/**
+			 * Pool chain structure.
+			 */
+			struct PoolChain {
+				std::vector<VkDescriptorPool> vPools;
+				UI32 mCurrent = 0;						// The pool allocated from. Earlier pools are full.
+			};
+
+		public:
+			VulkanDescriptorAllocator() {}
+			~VulkanDescriptorAllocator() {}
+
+			/**
+			 * Initialize the allocator.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 * @param frameCount: The number of frames in flight.
+			 */
+			void Initialize(VkDevice vLogicalDevice, UI32 frameCount);
+
+			/**
+			 * Terminate the allocator.
+			 * Every pool is destroyed, which frees every set allocated from it.
+			 */
+			void Terminate();
+
+			/**
+			 * Set the number of frames in flight.
+			 * Destroys the transient pools. The GPU must be done with every transient set.
+			 *
+			 * @param frameCount: The frame count.
+			 */
+			void SetFrameCount(UI32 frameCount);
+
+			/**
+			 * Register the descriptor bindings of a set of shaders.
+			 * Pools created afterwards are sized for the average set of every registered shader.
+			 *
+			 * @param shaders: The reflected shaders.
+			 */
+			void RegisterShaders(const std::vector<const ShaderCode*>& shaders);
+
+			/**
+			 * Begin a frame.
+			 * Resets the transient pools of the frame. The GPU must be done with the frame's previous submission.
+			 *
+			 * @param frameIndex: The index of the frame in flight.
+			 */
+			void BeginFrame(UI32 frameIndex);
+
+			/**
+			 * Allocate a descriptor set which lives until the allocator is terminated.
+			 *
+			 * @param vLayout: The layout of the set.
+			 * @param pDescriptorSet: The descriptor set to be set.
+			 * @return Boolean value.
+			 */
+			bool Allocate(VkDescriptorSetLayout vLayout, VkDescriptorSet* pDescriptorSet);
+
+			/**
+			 * Allocate a descriptor set which lives till the current frame begins again.
+			 *
+			 * @param vLayout: The layout of the set.
+			 * @param pDescriptorSet: The descriptor set to be set.
+			 * @return Boolean value.
+			 */
+			bool AllocateTransient(VkDescriptorSetLayout vLayout, VkDescriptorSet* pDescriptorSet);
+
+			UI32 GetPoolCount() const;
+
+		private:
+			bool Allocate(PoolChain* pChain, VkDescriptorSetLayout vLayout, VkDescriptorSet* pDescriptorSet);
+			VkDescriptorPool CreatePool(UI32 setCount);
+
+			void ResetChain(PoolChain* pChain);
+			void DestroyChain(PoolChain* pChain);
+
+		private:
+			PoolChain mPersistentChain = {};
+			std::vector<PoolChain> mTransientChains;
+
+			UI64 mDescriptorCounts[VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT + 1] = {};		// Registered descriptors per type.
+			UI32 mMaxDescriptorCounts[VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT + 1] = {};	// The largest count of a single set per type.
+			UI64 mSetCount = 0;															// Registered sets.
+
+			mutable std::mutex mMutex;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+			UI32 mFrameIndex = 0;
+		};
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Frame.h"
+#include "Macros.h"
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		VulkanFrame CreateFrame(VkDevice vLogicalDevice, UI32 queueFamily)
+		{
+			VulkanFrame frame = {};
+
+			VkCommandPoolCreateInfo vPoolCI = {};
+			vPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			vPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			vPoolCI.pNext = VK_NULL_HANDLE;
+			vPoolCI.queueFamilyIndex = queueFamily;
+
+			VK_ASSERT(vkCreateCommandPool(vLogicalDevice, &vPoolCI, nullptr, &frame.vCommandPool), "Failed to create the frame command pool!");
+
+			VkCommandBufferAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			vAI.pNext = VK_NULL_HANDLE;
+			vAI.commandPool = frame.vCommandPool;
+			vAI.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			vAI.commandBufferCount = 1;
+
+			VK_ASSERT(vkAllocateCommandBuffers(vLogicalDevice, &vAI, &frame.vCommandBuffer), "Failed to allocate the frame command buffer!");
+
+			VkFenceCreateInfo vFenceCI = {};
+			vFenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			vFenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+			vFenceCI.pNext = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkCreateFence(vLogicalDevice, &vFenceCI, nullptr, &frame.vInFlightFence), "Failed to create the frame fence!");
+
+			VkSemaphoreCreateInfo vSemaphoreCI = {};
+			vSemaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			vSemaphoreCI.flags = VK_NULL_HANDLE;
+			vSemaphoreCI.pNext = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkCreateSemaphore(vLogicalDevice, &vSemaphoreCI, nullptr, &frame.vImageAvailable), "Failed to create the image available semaphore!");
+			VK_ASSERT(vkCreateSemaphore(vLogicalDevice, &vSemaphoreCI, nullptr, &frame.vRenderFinished), "Failed to create the render finished semaphore!");
+
+			return frame;
+		}
+
+		void DestroyFrame(VkDevice vLogicalDevice, VulkanFrame* pFrame)
+		{
+			vkDestroySemaphore(vLogicalDevice, pFrame->vRenderFinished, nullptr);
+			vkDestroySemaphore(vLogicalDevice, pFrame->vImageAvailable, nullptr);
+			vkDestroyFence(vLogicalDevice, pFrame->vInFlightFence, nullptr);
+
+			// Destroying the pool frees its command buffers.
+			vkDestroyCommandPool(vLogicalDevice, pFrame->vCommandPool, nullptr);
+
+			*pFrame = VulkanFrame();
+		}
+	}
+}
@@ -0,0 +1,50 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Frame structure.
+		 * The resources of a single frame in flight. The CPU records into a frame only after its fence has signaled,
+		 * so the command pool is reset wholesale instead of freeing command buffers one by one.
+		 */
+		struct VulkanFrame {
+			VkCommandPool vCommandPool = VK_NULL_HANDLE;
+			VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE;
+
+			VkFence vInFlightFence = VK_NULL_HANDLE;				// Signaled when the GPU finished the frame.
+			VkSemaphore vImageAvailable = VK_NULL_HANDLE;			// Signaled when the swap chain image can be rendered to.
+			VkSemaphore vRenderFinished = VK_NULL_HANDLE;			// Signaled when the frame can be presented.
+
+			std::vector<VkSemaphore> vUploadSemaphores;				// Upload batches the frame submission waited on.
+		};
+
+		/**
+		 * Create the resources of a frame.
+		 * The fence is created signaled so that the first wait on it returns immediately.
+		 *
+		 * @param vLogicalDevice: The logical device.
+		 * @param queueFamily: The queue family the command buffer is submitted to.
+		 * @return The frame.
+		 */
+		VulkanFrame CreateFrame(VkDevice vLogicalDevice, UI32 queueFamily);
+
+		/**
+		 * Destroy the resources of a frame.
+		 * The frame must not be in use by the GPU.
+		 *
+		 * @param vLogicalDevice: The logical device.
+		 * @param pFrame: The frame.
+		 */
+		void DestroyFrame(VkDevice vLogicalDevice, VulkanFrame* pFrame);
+	}
+}
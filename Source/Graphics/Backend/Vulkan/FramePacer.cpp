@@ -0,0 +1,80 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		VkPresentModeKHR VulkanFramePacer::ChoosePresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) const
+		{
+			auto isAvailable = [&availablePresentModes](VkPresentModeKHR vMode)
+			{
+				return std::find(availablePresentModes.begin(), availablePresentModes.end(), vMode) != availablePresentModes.end();
+			};
+
+			if (mPolicy == VulkanPresentPolicy::UNCAPPED)
+			{
+				if (isAvailable(VK_PRESENT_MODE_IMMEDIATE_KHR))
+					return VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+				if (isAvailable(VK_PRESENT_MODE_MAILBOX_KHR))
+					return VK_PRESENT_MODE_MAILBOX_KHR;
+			}
+
+			// FIFO is the only mode every surface supports.
+			return VK_PRESENT_MODE_FIFO_KHR;
+		}
+
+		UI32 VulkanFramePacer::ChooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities, UI32 defaultCount) const
+		{
+			// Every image past the minimum is another frame the presentation engine may queue.
+			if (mPolicy == VulkanPresentPolicy::LOW_LATENCY)
+				return capabilities.minImageCount;
+
+			return defaultCount;
+		}
+
+		void VulkanFramePacer::Pace()
+		{
+			const float frameRate = GetEffectiveFrameRate();
+			if (frameRate == 0.0f)
+			{
+				mNextFrame = {};
+				return;
+			}
+
+			const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frameRate));
+			const Clock::duration spinTime = std::chrono::microseconds(VULKAN_FRAME_PACER_SPIN_TIME);
+
+			Clock::time_point now = Clock::now();
+			if (mNextFrame > now)
+			{
+				if (mNextFrame - now > spinTime)
+					std::this_thread::sleep_until(mNextFrame - spinTime);
+
+				while (Clock::now() < mNextFrame)
+					std::this_thread::yield();
+
+				mNextFrame += period;
+			}
+			else
+				mNextFrame = now + period;
+		}
+
+		float VulkanFramePacer::GetEffectiveFrameRate() const
+		{
+			if (mPolicy == VulkanPresentPolicy::UNCAPPED)
+				return 0.0f;
+
+			if (mPolicy == VulkanPresentPolicy::POWER_SAVING && mFrameRateLimit == 0.0f)
+				return VULKAN_POWER_SAVING_FRAME_RATE;
+
+			return mFrameRateLimit;
+		}
+	}
+}
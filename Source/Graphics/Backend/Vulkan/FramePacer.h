@@ -0,0 +1,104 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <chrono>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+/**
+ * The frame rate the power saving policy limits to when no limit was set.
+ */
+#define VULKAN_POWER_SAVING_FRAME_RATE		30.0f
+
+/**
+ * The time before the next frame slot the limiter stops sleeping and starts yielding, in microseconds.
+ * Sleeping is only accurate to the scheduler granularity, which is around a millisecond.
+ */
+#define VULKAN_FRAME_PACER_SPIN_TIME		1500
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Present Policy enum.
+		 */
+		enum class VulkanPresentPolicy : UI8 {
+			VSYNC,				// FIFO. Tear free, capped to the refresh rate.
+			LOW_LATENCY,		// FIFO with the fewest swap chain images, and the CPU never records ahead of the GPU.
+			UNCAPPED,			// IMMEDIATE, or MAILBOX if not supported. Ignores the frame rate limit, meant for benchmarks.
+			POWER_SAVING,		// FIFO limited to VULKAN_POWER_SAVING_FRAME_RATE unless another limit was set.
+		};
+
+		/**
+		 * Vulkan Frame Pacer object.
+		 * Maps the present policy to a present mode and swap chain image count, and limits the frame rate on the CPU.
+		 * The device paces right before it samples the inputs, so the time spent waiting never adds to the age of the
+		 * inputs a frame is recorded with.
+		 */
+		class VulkanFramePacer {
+			using Clock = std::chrono::steady_clock;
+
+		public:
+			VulkanFramePacer() {}
+			~VulkanFramePacer() {}
+
+			/**
+			 * Choose the present mode of the policy.
+			 *
+			 * @param availablePresentModes: The present modes the surface supports.
+			 * @return The present mode. FIFO if the preferred modes are not supported.
+			 */
+			VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) const;
+
+			/**
+			 * Choose the minimum number of swap chain images.
+			 *
+			 * @param capabilities: The surface capabilities.
+			 * @param defaultCount: The image count used by the policies which do not limit queuing.
+			 * @return The image count.
+			 */
+			UI32 ChooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities, UI32 defaultCount) const;
+
+			/**
+			 * Wait till the next frame slot of the frame rate limit.
+			 * Frames which are late do not shorten the following ones, so a hitch never results in a burst.
+			 */
+			void Pace();
+
+			/**
+			 * Get the frame rate the limiter currently paces to.
+			 *
+			 * @return The frame rate. 0 if the frame rate is not limited.
+			 */
+			float GetEffectiveFrameRate() const;
+
+			/**
+			 * Set the frame rate limit.
+			 *
+			 * @param frameRate: The frame rate in frames per second. 0 removes the limit.
+			 */
+			void SetFrameRateLimit(float frameRate) { mFrameRateLimit = frameRate > 0.0f ? frameRate : 0.0f; }
+			float GetFrameRateLimit() const { return mFrameRateLimit; }
+
+			void SetPolicy(VulkanPresentPolicy policy) { mPolicy = policy; }
+			VulkanPresentPolicy GetPolicy() const { return mPolicy; }
+
+			/**
+			 * Check if the CPU must wait for the previous frame before recording the next one.
+			 *
+			 * @return Boolean value.
+			 */
+			bool WaitsForPreviousFrame() const { return mPolicy == VulkanPresentPolicy::LOW_LATENCY; }
+
+		private:
+			Clock::time_point mNextFrame = {};
+			float mFrameRateLimit = 0.0f;
+			VulkanPresentPolicy mPolicy = VulkanPresentPolicy::VSYNC;
+		};
+	}
+}
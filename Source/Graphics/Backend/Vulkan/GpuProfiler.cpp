@@ -0,0 +1,295 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "GpuProfiler.h"
+#include "Macros.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Escape a string for a JSON string literal.
+			 *
+			 * @param string: The string.
+			 * @return The escaped string.
+			 */
+			String EscapeJSON(const String& string)
+			{
+				std::stringstream stream;
+				for (char character : string)
+				{
+					if (character == '"' || character == '\\')
+						stream << '\\' << character;
+					else if (static_cast<unsigned char>(character) < 0x20)
+						stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<I32>(character) << std::dec;
+					else
+						stream << character;
+				}
+
+				return stream.str();
+			}
+		}
+
+		void VulkanGpuProfiler::Initialize(VkDevice vLogicalDevice, VkPhysicalDevice vPhysicalDevice, UI32 queueFamily, UI32 frameCount)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+
+			VkPhysicalDeviceProperties vProperties = {};
+			vkGetPhysicalDeviceProperties(vPhysicalDevice, &vProperties);
+
+			UI32 queueFamilyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(vPhysicalDevice, &queueFamilyCount, nullptr);
+
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(vPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+
+			const UI32 validBits = queueFamilies[queueFamily].timestampValidBits;
+			mIsSupported = validBits > 0 && vProperties.limits.timestampPeriod > 0.0f;
+			mTimestampPeriod = vProperties.limits.timestampPeriod;
+			mTimestampMask = validBits >= 64 ? ~0ULL : (1ULL << validBits) - 1;
+
+			if (!mIsSupported)
+			{
+				Logger::LogInfo(TEXT("The graphics queue does not support timestamps. GPU profiling is disabled."));
+				return;
+			}
+
+			for (UI32 i = 0; i < frameCount; i++)
+				INSERT_INTO_VECTOR(mFrames, CreateFrameQueries());
+		}
+
+		void VulkanGpuProfiler::Terminate()
+		{
+			for (FrameQueries& queries : mFrames)
+				DestroyFrameQueries(&queries);
+
+			mFrames.clear();
+			mHistory.clear();
+			mAverages.clear();
+		}
+
+		void VulkanGpuProfiler::SetFrameCount(UI32 frameCount)
+		{
+			if (!mIsSupported)
+				return;
+
+			for (FrameQueries& queries : mFrames)
+				DestroyFrameQueries(&queries);
+
+			mFrames.clear();
+			for (UI32 i = 0; i < frameCount; i++)
+				INSERT_INTO_VECTOR(mFrames, CreateFrameQueries());
+
+			mIsFrameActive = false;
+		}
+
+		void VulkanGpuProfiler::BeginFrame(UI32 frameIndex, VkCommandBuffer vCommandBuffer)
+		{
+			mIsFrameActive = false;
+			if (!mIsSupported)
+				return;
+
+			FrameQueries& queries = mFrames[frameIndex];
+			if (queries.mQueryCount > 0)
+				Resolve(&queries);
+
+			queries.mScopes.clear();
+			queries.mQueryCount = 0;
+			queries.mFrameNumber = ++mFrameNumber;
+
+			mScopeStack.clear();
+			mFrameIndex = frameIndex;
+
+			if (!mIsEnabled)
+				return;
+
+			vkCmdResetQueryPool(vCommandBuffer, queries.vQueryPool, 0, VULKAN_PROFILER_MAX_SCOPES * 2);
+			mIsFrameActive = true;
+		}
+
+		void VulkanGpuProfiler::BeginScope(VkCommandBuffer vCommandBuffer, const char* pName)
+		{
+			if (!mIsFrameActive)
+				return;
+
+			FrameQueries& queries = mFrames[mFrameIndex];
+			if (queries.mScopes.size() >= VULKAN_PROFILER_MAX_SCOPES)
+			{
+				INSERT_INTO_VECTOR(mScopeStack, UINT32_MAX);
+				return;
+			}
+
+			Scope scope = {};
+			scope.mName = pName;
+			scope.mBeginQuery = queries.mQueryCount++;
+			scope.mDepth = static_cast<UI32>(mScopeStack.size());
+
+			vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queries.vQueryPool, scope.mBeginQuery);
+
+			INSERT_INTO_VECTOR(mScopeStack, static_cast<UI32>(queries.mScopes.size()));
+			INSERT_INTO_VECTOR(queries.mScopes, scope);
+		}
+
+		void VulkanGpuProfiler::EndScope(VkCommandBuffer vCommandBuffer)
+		{
+			if (!mIsFrameActive || mScopeStack.empty())
+				return;
+
+			UI32 index = mScopeStack.back();
+			mScopeStack.pop_back();
+
+			// The scope was past the limit.
+			if (index == UINT32_MAX)
+				return;
+
+			FrameQueries& queries = mFrames[mFrameIndex];
+			Scope& scope = queries.mScopes[index];
+			scope.mEndQuery = queries.mQueryCount++;
+
+			vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queries.vQueryPool, scope.mEndQuery);
+		}
+
+		String VulkanGpuProfiler::GetSummary(UI32 maxPasses) const
+		{
+			std::vector<const VulkanPassTiming*> passes;
+			for (const VulkanPassTiming& pass : mLastFrame.mPasses)
+				INSERT_INTO_VECTOR(passes, &pass);
+
+			std::sort(passes.begin(), passes.end(), [](const VulkanPassTiming* lhs, const VulkanPassTiming* rhs) { return lhs->mAverageDuration > rhs->mAverageDuration; });
+
+			std::stringstream summary;
+			summary << std::fixed << std::setprecision(2) << "GPU " << mLastFrame.mDuration << " ms";
+
+			for (UI32 i = 0; i < passes.size() && i < maxPasses; i++)
+				summary << " | " << passes[i]->mName << " " << passes[i]->mAverageDuration << " ms";
+
+			return summary.str();
+		}
+
+		bool VulkanGpuProfiler::ExportTrace(const char* pFile) const
+		{
+			std::ofstream file(pFile, std::ios::trunc);
+			if (!file.is_open())
+			{
+				Logger::LogError(TEXT("Failed to open the GPU trace file!"));
+				return false;
+			}
+
+			// Complete events with microsecond timestamps. Frames enclose their passes on the same track.
+			file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+			bool isFirst = true;
+			for (const VulkanFrameTiming& frame : mHistory)
+			{
+				file << (isFirst ? "" : ",") << "\n{\"name\":\"Frame " << frame.mFrameNumber << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":"
+					<< frame.mStart * 1000.0 << ",\"dur\":" << frame.mDuration * 1000.0 << "}";
+				isFirst = false;
+
+				for (const VulkanPassTiming& pass : frame.mPasses)
+				{
+					file << ",\n{\"name\":\"" << _Helpers::EscapeJSON(pass.mName) << "\",\"cat\":\"pass\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":"
+						<< (frame.mStart + pass.mStart) * 1000.0 << ",\"dur\":" << pass.mDuration * 1000.0
+						<< ",\"args\":{\"depth\":" << pass.mDepth << ",\"average_ms\":" << pass.mAverageDuration << "}}";
+				}
+			}
+
+			file << "\n]}\n";
+			return static_cast<bool>(file);
+		}
+
+		VulkanGpuProfiler::FrameQueries VulkanGpuProfiler::CreateFrameQueries()
+		{
+			FrameQueries queries = {};
+
+			VkQueryPoolCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			vCI.queryCount = VULKAN_PROFILER_MAX_SCOPES * 2;
+
+			VK_ASSERT(vkCreateQueryPool(vLogicalDevice, &vCI, nullptr, &queries.vQueryPool), "Failed to create the timestamp query pool!");
+			return queries;
+		}
+
+		void VulkanGpuProfiler::DestroyFrameQueries(FrameQueries* pQueries)
+		{
+			vkDestroyQueryPool(vLogicalDevice, pQueries->vQueryPool, nullptr);
+			*pQueries = FrameQueries();
+		}
+
+		void VulkanGpuProfiler::Resolve(FrameQueries* pQueries)
+		{
+			mTimestamps.resize(pQueries->mQueryCount);
+
+			// The frame's fence has signaled, so this only fails if the frame was never submitted.
+			VkResult vResult = vkGetQueryPoolResults(vLogicalDevice, pQueries->vQueryPool, 0, pQueries->mQueryCount,
+				mTimestamps.size() * sizeof(UI64), mTimestamps.data(), sizeof(UI64), VK_QUERY_RESULT_64_BIT);
+
+			if (vResult != VK_SUCCESS)
+				return;
+
+			const double ticksToMilliseconds = mTimestampPeriod / 1000000.0;
+
+			UI64 frameBegin = UINT64_MAX;
+			UI64 frameEnd = 0;
+			for (const Scope& scope : pQueries->mScopes)
+			{
+				// Scopes which never ended are dropped.
+				if (scope.mEndQuery == 0)
+					continue;
+
+				frameBegin = std::min(frameBegin, mTimestamps[scope.mBeginQuery] & mTimestampMask);
+				frameEnd = std::max(frameEnd, mTimestamps[scope.mEndQuery] & mTimestampMask);
+			}
+
+			if (frameBegin > frameEnd)
+				return;
+
+			if (mFirstTimestamp == 0)
+				mFirstTimestamp = frameBegin;
+
+			VulkanFrameTiming frame = {};
+			frame.mFrameNumber = pQueries->mFrameNumber;
+			frame.mStart = static_cast<double>(frameBegin - std::min(frameBegin, mFirstTimestamp)) * ticksToMilliseconds;
+			frame.mDuration = static_cast<double>(frameEnd - frameBegin) * ticksToMilliseconds;
+
+			for (const Scope& scope : pQueries->mScopes)
+			{
+				if (scope.mEndQuery == 0)
+					continue;
+
+				const UI64 begin = mTimestamps[scope.mBeginQuery] & mTimestampMask;
+				const UI64 end = mTimestamps[scope.mEndQuery] & mTimestampMask;
+
+				VulkanPassTiming pass = {};
+				pass.mName = scope.mName;
+				pass.mDepth = scope.mDepth;
+				pass.mStart = static_cast<double>(begin - frameBegin) * ticksToMilliseconds;
+				pass.mDuration = static_cast<double>(end > begin ? end - begin : 0) * ticksToMilliseconds;
+
+				auto itr = mAverages.find(pass.mName);
+				if (itr == mAverages.end())
+					itr = mAverages.insert({ pass.mName, pass.mDuration }).first;
+				else
+					itr->second += (pass.mDuration - itr->second) * VULKAN_PROFILER_AVERAGE_WEIGHT;
+
+				pass.mAverageDuration = itr->second;
+				INSERT_INTO_VECTOR(frame.mPasses, std::move(pass));
+			}
+
+			mLastFrame = frame;
+			mHistory.push_back(std::move(frame));
+			if (mHistory.size() > VULKAN_PROFILER_TRACE_FRAMES)
+				mHistory.pop_front();
+		}
+	}
+}
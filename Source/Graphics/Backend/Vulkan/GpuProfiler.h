@@ -0,0 +1,205 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+/**
+ * The maximum number of scopes a single frame can time. Scopes past this are not timed.
+ */
+#define VULKAN_PROFILER_MAX_SCOPES		256
+
+/**
+ * The number of resolved frames kept for the trace export.
+ */
+#define VULKAN_PROFILER_TRACE_FRAMES	240
+
+/**
+ * The weight of the latest frame in the running average of each pass.
+ */
+#define VULKAN_PROFILER_AVERAGE_WEIGHT	0.05
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Pass Timing structure.
+		 */
+		struct VulkanPassTiming {
+			String mName = "";
+			double mStart = 0.0;					// Milliseconds since the first timestamp of the frame.
+			double mDuration = 0.0;					// Milliseconds.
+			double mAverageDuration = 0.0;			// Running average of the passes with the same name, in milliseconds.
+			UI32 mDepth = 0;						// Nesting depth of the scope.
+		};
+
+		/**
+		 * Vulkan Frame Timing structure.
+		 */
+		struct VulkanFrameTiming {
+			std::vector<VulkanPassTiming> mPasses;	// In the order the scopes began.
+			UI64 mFrameNumber = 0;
+			double mStart = 0.0;					// Milliseconds since the first resolved frame.
+			double mDuration = 0.0;					// Milliseconds between the first and the last timestamp.
+		};
+
+		/**
+		 * Vulkan GPU Profiler object.
+		 * Times scopes of GPU work with timestamp queries. Every frame in flight owns a query pool, which is read back
+		 * when the frame comes around again: its fence has signaled by then, so reading the results never stalls.
+		 * The timings are therefore as old as the number of frames in flight.
+		 */
+		class VulkanGpuProfiler {
+			/**
+			 * Scope structure.
+			 */
+			struct Scope {
+				String mName = "";
+				UI32 mBeginQuery = 0;
+				UI32 mEndQuery = 0;
+				UI32 mDepth = 0;
+			};
+
+			/**
+			 * Frame queries structure.
+			 */
+			struct FrameQueries {
+				std::vector<Scope> mScopes;
+				VkQueryPool vQueryPool = VK_NULL_HANDLE;
+				UI64 mFrameNumber = 0;
+				UI32 mQueryCount = 0;
+			};
+
+		public:
+			VulkanGpuProfiler() {}
+			~VulkanGpuProfiler() {}
+
+			/**
+			 * Initialize the profiler.
+			 * The profiler does nothing if the queue does not support timestamps.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 * @param vPhysicalDevice: The physical device.
+			 * @param queueFamily: The queue family the timed command buffers are submitted to.
+			 * @param frameCount: The number of frames in flight.
+			 */
+			void Initialize(VkDevice vLogicalDevice, VkPhysicalDevice vPhysicalDevice, UI32 queueFamily, UI32 frameCount);
+
+			/**
+			 * Terminate the profiler.
+			 */
+			void Terminate();
+
+			/**
+			 * Set the number of frames in flight.
+			 * The GPU must be done with every frame.
+			 *
+			 * @param frameCount: The frame count.
+			 */
+			void SetFrameCount(UI32 frameCount);
+
+			/**
+			 * Begin a frame.
+			 * Resolves the timings of the previous use of the frame and resets its queries. Must be called right after
+			 * the command buffer was begun, after the frame's fence was waited on.
+			 *
+			 * @param frameIndex: The index of the frame in flight.
+			 * @param vCommandBuffer: The frame command buffer.
+			 */
+			void BeginFrame(UI32 frameIndex, VkCommandBuffer vCommandBuffer);
+
+			/**
+			 * Begin a timed scope.
+			 * Scopes may nest, but must end in the reverse order they began, in the same command buffer.
+			 *
+			 * @param vCommandBuffer: The command buffer.
+			 * @param pName: The name of the scope.
+			 */
+			void BeginScope(VkCommandBuffer vCommandBuffer, const char* pName);
+
+			/**
+			 * End the last timed scope.
+			 *
+			 * @param vCommandBuffer: The command buffer.
+			 */
+			void EndScope(VkCommandBuffer vCommandBuffer);
+
+			/**
+			 * Get the timings of the last resolved frame.
+			 *
+			 * @return The frame timing.
+			 */
+			const VulkanFrameTiming& GetLastFrame() const { return mLastFrame; }
+
+			/**
+			 * Get a one line summary of the last resolved frame.
+			 *
+			 * @param maxPasses: The maximum number of passes to list, most expensive first.
+			 * @return The summary.
+			 */
+			String GetSummary(UI32 maxPasses = 4) const;
+
+			/**
+			 * Export the recent frames as a Chrome trace (chrome://tracing, Perfetto).
+			 *
+			 * @param pFile: The file to write.
+			 * @return Boolean value.
+			 */
+			bool ExportTrace(const char* pFile) const;
+
+			UI64 GetFrameNumber() const { return mFrameNumber; }
+			bool IsSupported() const { return mIsSupported; }
+			void SetEnabled(bool isEnabled) { mIsEnabled = isEnabled; }
+			bool IsEnabled() const { return mIsEnabled; }
+
+		private:
+			FrameQueries CreateFrameQueries();
+			void DestroyFrameQueries(FrameQueries* pQueries);
+			void Resolve(FrameQueries* pQueries);
+
+		private:
+			std::vector<FrameQueries> mFrames;
+			std::vector<UI32> mScopeStack;							// Indexes into the scopes of the current frame.
+			std::vector<UI64> mTimestamps;
+
+			VulkanFrameTiming mLastFrame = {};
+			std::deque<VulkanFrameTiming> mHistory;
+			std::unordered_map<String, double> mAverages;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+			double mTimestampPeriod = 1.0;							// Nanoseconds per tick.
+			UI64 mTimestampMask = ~0ULL;
+			UI64 mFirstTimestamp = 0;
+			UI64 mFrameNumber = 0;
+			UI32 mFrameIndex = 0;
+			bool mIsSupported = false;
+			bool mIsEnabled = true;
+			bool mIsFrameActive = false;
+		};
+
+		/**
+		 * Vulkan Profiler Scope object.
+		 * Times the scope it lives in.
+		 */
+		class VulkanProfilerScope {
+		public:
+			VulkanProfilerScope(VulkanGpuProfiler* pProfiler, VkCommandBuffer vCommandBuffer, const char* pName)
+				: pProfiler(pProfiler), vCommandBuffer(vCommandBuffer)
+			{
+				pProfiler->BeginScope(vCommandBuffer, pName);
+			}
+
+			~VulkanProfilerScope() { pProfiler->EndScope(vCommandBuffer); }
+
+		private:
+			VulkanGpuProfiler* pProfiler = nullptr;
+			VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE;
+		};
+	}
+}
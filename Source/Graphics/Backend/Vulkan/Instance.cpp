@@ -53,15 +53,24 @@ namespace Graphics
 		/**
 		 * Get the requires instance extensions from GLFW.
 		 *
+		 * @param enableSurface: Whether the surface extensions are needed. GLFW is not queried if false.
+		 * @param enableValidation: Whether the debug utils extension is needed.
 		 * @return std::vector<const char*> containing the required extensions.
 		 */
-		std::vector<const char*> GetRequiredInstanceExtensions()
+		std::vector<const char*> GetRequiredInstanceExtensions(bool enableSurface, bool enableValidation)
 		{
-			UI32 glfwExtentionCount = 0;
-			const char** glfwExtensions = nullptr;
-			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtentionCount);
-			std::vector<const char*> extentions(glfwExtensions, glfwExtensions + glfwExtentionCount);
-			extentions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			std::vector<const char*> extentions;
+			if (enableSurface)
+			{
+				UI32 glfwExtentionCount = 0;
+				const char** glfwExtensions = nullptr;
+				glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtentionCount);
+				extentions.insert(extentions.end(), glfwExtensions, glfwExtensions + glfwExtentionCount);
+			}
+
+			// Software drivers may not expose debug utils without the validation layers.
+			if (enableValidation || enableSurface)
+				extentions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
 			//if (pushDescriptorsSupported)
 			//	extentions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
@@ -148,7 +157,7 @@ namespace Graphics
 			return createInfo;
 		}
 
-		VkInstance CreateInstance(bool enableValidation, std::vector<const char*> validationLayers)
+		VkInstance CreateInstance(bool enableValidation, std::vector<const char*> validationLayers, bool enableSurface)
 		{
 			// Check if the validation layers are supported.
 			if (enableValidation && !CheckValidationLayerSupport(validationLayers))
@@ -169,7 +178,7 @@ namespace Graphics
 			createInfo.pApplicationInfo = &appInfo;
 
 			// Get and insert the required instance extensions.
-			auto requiredExtensions = GetRequiredInstanceExtensions();
+			auto requiredExtensions = GetRequiredInstanceExtensions(enableSurface, enableValidation);
 			createInfo.enabledExtensionCount = static_cast<UI32>(requiredExtensions.size());
 			createInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
@@ -15,9 +15,10 @@ namespace Graphics
 		 *
 		 * @param enableValidation: Whether or not to enable API validation.
 		 * @param validationLayers: The validation layers to use.
+		 * @param enableSurface: Whether the window surface extensions are needed. False for headless devices.
 		 * @return The vulkan instance handle.
 		 */
-		VkInstance CreateInstance(bool enableValidation, std::vector<const char*> validationLayers);
+		VkInstance CreateInstance(bool enableValidation, std::vector<const char*> validationLayers, bool enableSurface = true);
 
 		/**
 		 * Destroy instance.
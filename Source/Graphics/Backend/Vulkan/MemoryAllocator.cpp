@@ -0,0 +1,764 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MemoryAllocator.h"
+#include "Macros.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+#endif	// _MSC_VER
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Get the index of the most significant set bit.
+			 *
+			 * @param value: The value. Must not be 0.
+			 * @return The bit index.
+			 */
+			inline UI32 GetMostSignificantBit(UI64 value)
+			{
+#ifdef _MSC_VER
+				unsigned long index = 0;
+				_BitScanReverse64(&index, value);
+				return static_cast<UI32>(index);
+
+#else
+				return 63 - static_cast<UI32>(__builtin_clzll(value));
+
+#endif	// _MSC_VER
+			}
+
+			/**
+			 * Get the index of the least significant set bit.
+			 *
+			 * @param value: The value. Must not be 0.
+			 * @return The bit index.
+			 */
+			inline UI32 GetLeastSignificantBit(UI64 value)
+			{
+#ifdef _MSC_VER
+				unsigned long index = 0;
+				_BitScanForward64(&index, value);
+				return static_cast<UI32>(index);
+
+#else
+				return static_cast<UI32>(__builtin_ctzll(value));
+
+#endif	// _MSC_VER
+			}
+
+			/**
+			 * Map a size to its first and second level indexes.
+			 *
+			 * @param size: The size.
+			 * @param pFirstLevel: The first level index to be set.
+			 * @param pSecondLevel: The second level index to be set.
+			 */
+			inline void MapTLSFSize(UI64 size, UI32* pFirstLevel, UI32* pSecondLevel)
+			{
+				if (size < TLSF_SMALL_BLOCK_SIZE)
+				{
+					*pFirstLevel = 0;
+					*pSecondLevel = static_cast<UI32>(size / (TLSF_SMALL_BLOCK_SIZE / TLSF_SL_COUNT));
+					return;
+				}
+
+				UI32 mostSignificantBit = GetMostSignificantBit(size);
+				*pFirstLevel = mostSignificantBit - TLSF_SMALL_BLOCK_LOG2 + 1;
+				*pSecondLevel = static_cast<UI32>(size >> (mostSignificantBit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+			}
+
+			/**
+			 * Round a size up to the first size of the next free list, so that every block in that list is large enough.
+			 *
+			 * @param size: The size.
+			 * @return The rounded size.
+			 */
+			inline UI64 RoundUpTLSFSize(UI64 size)
+			{
+				if (size >= TLSF_SMALL_BLOCK_SIZE)
+					return size + (1ULL << (GetMostSignificantBit(size) - TLSF_SL_LOG2)) - 1;
+
+				return size + TLSF_SMALL_BLOCK_SIZE / TLSF_SL_COUNT - 1;
+			}
+
+			inline UI64 AlignUp(UI64 value, UI64 alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+
+			/**
+			 * Get the number of bits set.
+			 *
+			 * @param value: The value.
+			 * @return The bit count.
+			 */
+			inline UI32 GetSetBitCount(UI32 value)
+			{
+				UI32 count = 0;
+				for (; value; value &= value - 1)
+					count++;
+
+				return count;
+			}
+
+			/**
+			 * Format a byte count in mebibytes.
+			 *
+			 * @param bytes: The byte count.
+			 * @return The formatted string.
+			 */
+			String FormatMegabytes(UI64 bytes)
+			{
+				char buffer[32] = {};
+				snprintf(buffer, sizeof(buffer), "%.2f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+				return buffer;
+			}
+		}
+
+		void TLSFAllocator::Initialize(UI64 size)
+		{
+			mNodes.clear();
+			mFreeNodeIndexes.clear();
+
+			for (UI32 firstLevel = 0; firstLevel < TLSF_FL_COUNT; firstLevel++)
+			{
+				for (UI32 secondLevel = 0; secondLevel < TLSF_SL_COUNT; secondLevel++)
+					mFreeLists[firstLevel][secondLevel] = TLSF_INVALID_NODE;
+
+				mSecondLevelBitmaps[firstLevel] = 0;
+			}
+
+			mFirstLevelBitmap = 0;
+			mSize = size;
+			mUsedSize = 0;
+			mAllocationCount = 0;
+
+			UI32 node = CreateNode();
+			mNodes[node].mSize = size;
+			InsertFree(node);
+		}
+
+		UI32 TLSFAllocator::Allocate(UI64 size, UI64 alignment, UI64* pOffset)
+		{
+			size = std::max<UI64>(size, 1);
+			alignment = std::max<UI64>(alignment, 1);
+
+			// Any block of the searched size fits the request after aligning its offset.
+			UI32 node = FindFree(size + alignment - 1);
+			if (node == TLSF_INVALID_NODE)
+				return TLSF_INVALID_NODE;
+
+			RemoveFree(node);
+
+			// The padding in front stays free. Its previous neighbour is used, otherwise they would have been merged.
+			UI64 padding = _Helpers::AlignUp(mNodes[node].mOffset, alignment) - mNodes[node].mOffset;
+			if (padding > 0)
+			{
+				UI32 front = node;
+				node = Split(front, padding);
+				InsertFree(front);
+			}
+
+			if (mNodes[node].mSize - size >= TLSF_SMALL_BLOCK_SIZE / TLSF_SL_COUNT)
+				InsertFree(Split(node, size));
+
+			mNodes[node].mIsFree = false;
+			mUsedSize += mNodes[node].mSize;
+			mAllocationCount++;
+
+			*pOffset = mNodes[node].mOffset;
+			return node;
+		}
+
+		UI64 TLSFAllocator::GetRequiredSize(UI64 size, UI64 alignment)
+		{
+			// Mirrors the search of Allocate.
+			return _Helpers::RoundUpTLSFSize(std::max<UI64>(size, 1) + std::max<UI64>(alignment, 1) - 1);
+		}
+
+		void TLSFAllocator::Free(UI32 node)
+		{
+			mNodes[node].mIsFree = true;
+			mUsedSize -= mNodes[node].mSize;
+			mAllocationCount--;
+
+			UI32 next = mNodes[node].mNextPhysical;
+			if (next != TLSF_INVALID_NODE && mNodes[next].mIsFree)
+			{
+				RemoveFree(next);
+				node = Merge(node, next);
+			}
+
+			UI32 previous = mNodes[node].mPrevPhysical;
+			if (previous != TLSF_INVALID_NODE && mNodes[previous].mIsFree)
+			{
+				RemoveFree(previous);
+				node = Merge(previous, node);
+			}
+
+			InsertFree(node);
+		}
+
+		UI64 TLSFAllocator::GetLargestFreeSize() const
+		{
+			UI64 largest = 0;
+			for (const Node& node : mNodes)
+				if (node.mIsFree)
+					largest = std::max(largest, node.mSize);
+
+			return largest;
+		}
+
+		UI32 TLSFAllocator::CreateNode()
+		{
+			if (!mFreeNodeIndexes.empty())
+			{
+				UI32 node = mFreeNodeIndexes.back();
+				mFreeNodeIndexes.pop_back();
+
+				mNodes[node] = Node();
+				return node;
+			}
+
+			mNodes.push_back(Node());
+			return static_cast<UI32>(mNodes.size() - 1);
+		}
+
+		void TLSFAllocator::ReleaseNode(UI32 node)
+		{
+			mNodes[node] = Node();
+			mFreeNodeIndexes.push_back(node);
+		}
+
+		void TLSFAllocator::InsertFree(UI32 node)
+		{
+			UI32 firstLevel = 0, secondLevel = 0;
+			_Helpers::MapTLSFSize(mNodes[node].mSize, &firstLevel, &secondLevel);
+
+			UI32 head = mFreeLists[firstLevel][secondLevel];
+			mNodes[node].mIsFree = true;
+			mNodes[node].mPrevFree = TLSF_INVALID_NODE;
+			mNodes[node].mNextFree = head;
+
+			if (head != TLSF_INVALID_NODE)
+				mNodes[head].mPrevFree = node;
+
+			mFreeLists[firstLevel][secondLevel] = node;
+			mSecondLevelBitmaps[firstLevel] |= 1U << secondLevel;
+			mFirstLevelBitmap |= 1ULL << firstLevel;
+		}
+
+		void TLSFAllocator::RemoveFree(UI32 node)
+		{
+			UI32 previous = mNodes[node].mPrevFree;
+			UI32 next = mNodes[node].mNextFree;
+
+			if (previous != TLSF_INVALID_NODE)
+				mNodes[previous].mNextFree = next;
+
+			if (next != TLSF_INVALID_NODE)
+				mNodes[next].mPrevFree = previous;
+
+			UI32 firstLevel = 0, secondLevel = 0;
+			_Helpers::MapTLSFSize(mNodes[node].mSize, &firstLevel, &secondLevel);
+
+			if (mFreeLists[firstLevel][secondLevel] == node)
+			{
+				mFreeLists[firstLevel][secondLevel] = next;
+
+				if (next == TLSF_INVALID_NODE)
+				{
+					mSecondLevelBitmaps[firstLevel] &= ~(1U << secondLevel);
+
+					if (mSecondLevelBitmaps[firstLevel] == 0)
+						mFirstLevelBitmap &= ~(1ULL << firstLevel);
+				}
+			}
+
+			mNodes[node].mIsFree = false;
+			mNodes[node].mPrevFree = TLSF_INVALID_NODE;
+			mNodes[node].mNextFree = TLSF_INVALID_NODE;
+		}
+
+		UI32 TLSFAllocator::FindFree(UI64 size) const
+		{
+			size = _Helpers::RoundUpTLSFSize(size);
+
+			UI32 firstLevel = 0, secondLevel = 0;
+			_Helpers::MapTLSFSize(size, &firstLevel, &secondLevel);
+
+			if (firstLevel >= TLSF_FL_COUNT)
+				return TLSF_INVALID_NODE;
+
+			UI32 secondLevelMap = secondLevel < TLSF_SL_COUNT ? mSecondLevelBitmaps[firstLevel] & (~0U << secondLevel) : 0;
+			if (secondLevelMap == 0)
+			{
+				UI64 firstLevelMap = firstLevel + 1 < TLSF_FL_COUNT ? mFirstLevelBitmap & (~0ULL << (firstLevel + 1)) : 0;
+				if (firstLevelMap == 0)
+					return TLSF_INVALID_NODE;
+
+				firstLevel = _Helpers::GetLeastSignificantBit(firstLevelMap);
+				secondLevelMap = mSecondLevelBitmaps[firstLevel];
+			}
+
+			return mFreeLists[firstLevel][_Helpers::GetLeastSignificantBit(secondLevelMap)];
+		}
+
+		UI32 TLSFAllocator::Split(UI32 node, UI64 size)
+		{
+			UI32 remainder = CreateNode();
+
+			mNodes[remainder].mOffset = mNodes[node].mOffset + size;
+			mNodes[remainder].mSize = mNodes[node].mSize - size;
+			mNodes[remainder].mPrevPhysical = node;
+			mNodes[remainder].mNextPhysical = mNodes[node].mNextPhysical;
+
+			if (mNodes[node].mNextPhysical != TLSF_INVALID_NODE)
+				mNodes[mNodes[node].mNextPhysical].mPrevPhysical = remainder;
+
+			mNodes[node].mSize = size;
+			mNodes[node].mNextPhysical = remainder;
+
+			return remainder;
+		}
+
+		UI32 TLSFAllocator::Merge(UI32 node, UI32 next)
+		{
+			mNodes[node].mSize += mNodes[next].mSize;
+			mNodes[node].mNextPhysical = mNodes[next].mNextPhysical;
+
+			if (mNodes[next].mNextPhysical != TLSF_INVALID_NODE)
+				mNodes[mNodes[next].mNextPhysical].mPrevPhysical = node;
+
+			ReleaseNode(next);
+			return node;
+		}
+
+		void VulkanMemoryAllocator::Initialize(VkDevice vLogicalDevice, VkPhysicalDevice vPhysicalDevice)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+
+			VkPhysicalDeviceProperties vProperties = {};
+			vkGetPhysicalDeviceProperties(vPhysicalDevice, &vProperties);
+			vkGetPhysicalDeviceMemoryProperties(vPhysicalDevice, &vMemoryProperties);
+
+			vBufferImageGranularity = std::max<VkDeviceSize>(vProperties.limits.bufferImageGranularity, 1);
+			mMaxAllocationCount = vProperties.limits.maxMemoryAllocationCount;
+
+			// Dedicated allocation queries are core since Vulkan 1.1.
+			mSupportsDedicated = vProperties.apiVersion >= VK_API_VERSION_1_1;
+		}
+
+		void VulkanMemoryAllocator::Terminate()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			UI32 leakCount = 0;
+			for (std::unique_ptr<Block>& pBlock : pBlocks)
+			{
+				if (!pBlock)
+					continue;
+
+				leakCount += pBlock->mAllocator.GetAllocationCount();
+				FreeMemory(pBlock->vMemory);
+			}
+
+			for (UI32 i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+				leakCount += mDedicatedAllocationCounts[i];
+
+			if (leakCount)
+				Logger::LogWarn((TEXT("Vulkan memory allocator terminated with ") + std::to_wstring(leakCount) + TEXT(" live allocations!")).c_str());
+
+			pBlocks.clear();
+			vLogicalDevice = VK_NULL_HANDLE;
+		}
+
+		bool VulkanMemoryAllocator::AllocateBuffer(VkBuffer vBuffer, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation)
+		{
+			VkMemoryDedicatedRequirements vDedicated = {};
+			vDedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+			VkMemoryRequirements2 vRequirements = {};
+			vRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+			vRequirements.pNext = &vDedicated;
+
+			if (mSupportsDedicated)
+			{
+				VkBufferMemoryRequirementsInfo2 vInfo = {};
+				vInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+				vInfo.buffer = vBuffer;
+				vkGetBufferMemoryRequirements2(vLogicalDevice, &vInfo, &vRequirements);
+			}
+			else
+				vkGetBufferMemoryRequirements(vLogicalDevice, vBuffer, &vRequirements.memoryRequirements);
+
+			if (!Allocate(vRequirements.memoryRequirements, vDedicated.requiresDedicatedAllocation, vDedicated.prefersDedicatedAllocation, true, vBuffer, VK_NULL_HANDLE, vRequired, vPreferred, pAllocation))
+				return false;
+
+			if (vkBindBufferMemory(vLogicalDevice, vBuffer, pAllocation->vMemory, pAllocation->mOffset) != VK_SUCCESS)
+			{
+				Logger::LogError(TEXT("Failed to bind the buffer memory!"));
+				Free(pAllocation);
+				return false;
+			}
+
+			return true;
+		}
+
+		bool VulkanMemoryAllocator::AllocateImage(VkImage vImage, VkImageTiling vTiling, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation)
+		{
+			VkMemoryDedicatedRequirements vDedicated = {};
+			vDedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+			VkMemoryRequirements2 vRequirements = {};
+			vRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+			vRequirements.pNext = &vDedicated;
+
+			if (mSupportsDedicated)
+			{
+				VkImageMemoryRequirementsInfo2 vInfo = {};
+				vInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+				vInfo.image = vImage;
+				vkGetImageMemoryRequirements2(vLogicalDevice, &vInfo, &vRequirements);
+			}
+			else
+				vkGetImageMemoryRequirements(vLogicalDevice, vImage, &vRequirements.memoryRequirements);
+
+			bool isLinear = vTiling == VK_IMAGE_TILING_LINEAR;
+			if (!Allocate(vRequirements.memoryRequirements, vDedicated.requiresDedicatedAllocation, vDedicated.prefersDedicatedAllocation, isLinear, VK_NULL_HANDLE, vImage, vRequired, vPreferred, pAllocation))
+				return false;
+
+			if (vkBindImageMemory(vLogicalDevice, vImage, pAllocation->vMemory, pAllocation->mOffset) != VK_SUCCESS)
+			{
+				Logger::LogError(TEXT("Failed to bind the image memory!"));
+				Free(pAllocation);
+				return false;
+			}
+
+			return true;
+		}
+
+		bool VulkanMemoryAllocator::AllocateUnbound(const VkMemoryRequirements& vRequirements, bool isLinear, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation)
+		{
+			return Allocate(vRequirements, false, false, isLinear, VK_NULL_HANDLE, VK_NULL_HANDLE, vRequired, vPreferred, pAllocation);
+		}
+
+		void VulkanMemoryAllocator::Free(VulkanAllocation* pAllocation)
+		{
+			if (!pAllocation->IsValid())
+				return;
+
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if (pAllocation->mBlock == TLSF_INVALID_NODE)
+			{
+				FreeMemory(pAllocation->vMemory);
+				mDedicatedBytes[pAllocation->mMemoryType] -= pAllocation->mSize;
+				mDedicatedAllocationCounts[pAllocation->mMemoryType]--;
+			}
+			else
+			{
+				Block* pBlock = pBlocks[pAllocation->mBlock].get();
+				pBlock->mAllocator.Free(pAllocation->mNode);
+
+				// Keep one empty block of each kind around, so allocation patterns which oscillate around a block boundary
+				// do not reach the driver every frame.
+				if (pBlock->mAllocator.IsEmpty())
+				{
+					for (UI32 i = 0; i < pBlocks.size(); i++)
+					{
+						Block* pOther = pBlocks[i].get();
+						if (i == pAllocation->mBlock || !pOther || !pOther->mAllocator.IsEmpty()
+							|| pOther->mMemoryType != pBlock->mMemoryType || pOther->mIsLinear != pBlock->mIsLinear)
+							continue;
+
+						FreeMemory(pBlock->vMemory);
+						pBlocks[pAllocation->mBlock].reset();
+						break;
+					}
+				}
+			}
+
+			*pAllocation = VulkanAllocation();
+		}
+
+		VulkanMemoryStatistics VulkanMemoryAllocator::GetStatistics(std::vector<VulkanMemoryStatistics>* pPerHeap) const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			std::vector<VulkanMemoryStatistics> perHeap(vMemoryProperties.memoryHeapCount);
+			for (const std::unique_ptr<Block>& pBlock : pBlocks)
+			{
+				if (!pBlock)
+					continue;
+
+				VulkanMemoryStatistics& statistics = perHeap[vMemoryProperties.memoryTypes[pBlock->mMemoryType].heapIndex];
+				statistics.mBlockBytes += pBlock->mAllocator.GetSize();
+				statistics.mUsedBytes += pBlock->mAllocator.GetUsedSize();
+				statistics.mAllocationCount += pBlock->mAllocator.GetAllocationCount();
+				statistics.mBlockCount++;
+			}
+
+			for (UI32 i = 0; i < vMemoryProperties.memoryTypeCount; i++)
+			{
+				VulkanMemoryStatistics& statistics = perHeap[vMemoryProperties.memoryTypes[i].heapIndex];
+				statistics.mDedicatedBytes += mDedicatedBytes[i];
+				statistics.mDedicatedAllocationCount += mDedicatedAllocationCounts[i];
+			}
+
+			VulkanMemoryStatistics total = {};
+			for (const VulkanMemoryStatistics& statistics : perHeap)
+			{
+				total.mBlockBytes += statistics.mBlockBytes;
+				total.mUsedBytes += statistics.mUsedBytes;
+				total.mDedicatedBytes += statistics.mDedicatedBytes;
+				total.mBlockCount += statistics.mBlockCount;
+				total.mAllocationCount += statistics.mAllocationCount;
+				total.mDedicatedAllocationCount += statistics.mDedicatedAllocationCount;
+			}
+
+			if (pPerHeap)
+				*pPerHeap = std::move(perHeap);
+
+			return total;
+		}
+
+		String VulkanMemoryAllocator::DumpStatistics() const
+		{
+			std::vector<VulkanMemoryStatistics> perHeap;
+			VulkanMemoryStatistics total = GetStatistics(&perHeap);
+
+			String dump = "Vulkan memory: " + std::to_string(mDeviceAllocationCount) + " of " + std::to_string(mMaxAllocationCount) + " device allocations\n";
+			dump += "Total: " + _Helpers::FormatMegabytes(total.mUsedBytes) + " used of " + _Helpers::FormatMegabytes(total.mBlockBytes)
+				+ " in " + std::to_string(total.mBlockCount) + " blocks, " + _Helpers::FormatMegabytes(total.mDedicatedBytes) + " dedicated\n";
+
+			for (UI32 heap = 0; heap < perHeap.size(); heap++)
+			{
+				const VulkanMemoryStatistics& statistics = perHeap[heap];
+				bool isDeviceLocal = vMemoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+
+				dump += "Heap " + std::to_string(heap) + (isDeviceLocal ? " (device local, " : " (host, ") + _Helpers::FormatMegabytes(vMemoryProperties.memoryHeaps[heap].size) + "): "
+					+ std::to_string(statistics.mAllocationCount) + " allocations using " + _Helpers::FormatMegabytes(statistics.mUsedBytes)
+					+ " of " + _Helpers::FormatMegabytes(statistics.mBlockBytes) + " in " + std::to_string(statistics.mBlockCount) + " blocks, "
+					+ std::to_string(statistics.mDedicatedAllocationCount) + " dedicated using " + _Helpers::FormatMegabytes(statistics.mDedicatedBytes) + "\n";
+			}
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (UI32 i = 0; i < pBlocks.size(); i++)
+			{
+				const Block* pBlock = pBlocks[i].get();
+				if (!pBlock)
+					continue;
+
+				dump += "\tBlock " + std::to_string(i) + ": type " + std::to_string(pBlock->mMemoryType) + (pBlock->mIsLinear ? " linear, " : " optimal, ")
+					+ std::to_string(pBlock->mAllocator.GetAllocationCount()) + " allocations using " + _Helpers::FormatMegabytes(pBlock->mAllocator.GetUsedSize())
+					+ " of " + _Helpers::FormatMegabytes(pBlock->mAllocator.GetSize()) + ", largest free range " + _Helpers::FormatMegabytes(pBlock->mAllocator.GetLargestFreeSize()) + "\n";
+			}
+
+			return dump;
+		}
+
+		bool VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& vRequirements, bool requiresDedicated, bool prefersDedicated, bool isLinear,
+			VkBuffer vDedicatedBuffer, VkImage vDedicatedImage,
+			VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation)
+		{
+			std::vector<UI32> memoryTypes = GetMemoryTypeCandidates(vRequirements.memoryTypeBits, vRequired, vPreferred);
+
+			// Fall back to the next best memory type when a heap is exhausted.
+			for (UI32 memoryType : memoryTypes)
+			{
+				bool isDedicated = requiresDedicated || prefersDedicated || vRequirements.size >= GetBlockSize(memoryType) / VULKAN_MEMORY_DEDICATED_DIVISOR;
+
+				if (!isDedicated && AllocateFromBlocks(memoryType, vRequirements, isLinear, pAllocation))
+					return true;
+
+				if (AllocateDedicated(memoryType, vRequirements, vDedicatedBuffer, vDedicatedImage, pAllocation))
+					return true;
+
+				if (requiresDedicated)
+					break;
+			}
+
+			Logger::LogError(TEXT("Failed to allocate device memory!"));
+			return false;
+		}
+
+		bool VulkanMemoryAllocator::AllocateFromBlocks(UI32 memoryType, const VkMemoryRequirements& vRequirements, bool isLinear, VulkanAllocation* pAllocation)
+		{
+			// Without a granularity restriction linear and optimal resources can share blocks.
+			if (vBufferImageGranularity <= 1)
+				isLinear = false;
+
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			UI32 freeSlot = static_cast<UI32>(pBlocks.size());
+			for (UI32 i = 0; i < pBlocks.size(); i++)
+			{
+				Block* pBlock = pBlocks[i].get();
+				if (!pBlock)
+				{
+					freeSlot = std::min(freeSlot, i);
+					continue;
+				}
+
+				if (pBlock->mMemoryType != memoryType || pBlock->mIsLinear != isLinear)
+					continue;
+
+				UI64 offset = 0;
+				UI32 node = pBlock->mAllocator.Allocate(vRequirements.size, vRequirements.alignment, &offset);
+				if (node == TLSF_INVALID_NODE)
+					continue;
+
+				pAllocation->vMemory = pBlock->vMemory;
+				pAllocation->mOffset = offset;
+				pAllocation->mSize = vRequirements.size;
+				pAllocation->pMappedData = pBlock->pMappedData ? pBlock->pMappedData + offset : nullptr;
+				pAllocation->mMemoryType = memoryType;
+				pAllocation->mBlock = i;
+				pAllocation->mNode = node;
+				return true;
+			}
+
+			// Create a new block, halving its size while the driver refuses it. Smaller blocks than the request needs
+			// after alignment and rounding would be allocated only to fail.
+			std::unique_ptr<Block> pBlock = std::make_unique<Block>();
+			VkDeviceSize blockSize = GetBlockSize(memoryType);
+			const VkDeviceSize requiredSize = TLSFAllocator::GetRequiredSize(vRequirements.size, vRequirements.alignment);
+
+			while (pBlock->vMemory == VK_NULL_HANDLE && blockSize >= requiredSize)
+			{
+				pBlock->vMemory = AllocateMemory(memoryType, blockSize, VK_NULL_HANDLE, VK_NULL_HANDLE, &pBlock->pMappedData);
+				if (pBlock->vMemory == VK_NULL_HANDLE)
+					blockSize /= 2;
+			}
+
+			if (pBlock->vMemory == VK_NULL_HANDLE)
+				return false;
+
+			pBlock->mAllocator.Initialize(blockSize);
+			pBlock->mMemoryType = memoryType;
+			pBlock->mIsLinear = isLinear;
+
+			UI64 offset = 0;
+			UI32 node = pBlock->mAllocator.Allocate(vRequirements.size, vRequirements.alignment, &offset);
+			if (node == TLSF_INVALID_NODE)
+			{
+				FreeMemory(pBlock->vMemory);
+				return false;
+			}
+
+			pAllocation->vMemory = pBlock->vMemory;
+			pAllocation->mOffset = offset;
+			pAllocation->mSize = vRequirements.size;
+			pAllocation->pMappedData = pBlock->pMappedData ? pBlock->pMappedData + offset : nullptr;
+			pAllocation->mMemoryType = memoryType;
+			pAllocation->mBlock = freeSlot;
+			pAllocation->mNode = node;
+
+			if (freeSlot == pBlocks.size())
+				pBlocks.push_back(std::move(pBlock));
+			else
+				pBlocks[freeSlot] = std::move(pBlock);
+
+			return true;
+		}
+
+		bool VulkanMemoryAllocator::AllocateDedicated(UI32 memoryType, const VkMemoryRequirements& vRequirements, VkBuffer vBuffer, VkImage vImage, VulkanAllocation* pAllocation)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			BYTE* pMappedData = nullptr;
+			VkDeviceMemory vMemory = AllocateMemory(memoryType, vRequirements.size, vBuffer, vImage, &pMappedData);
+			if (vMemory == VK_NULL_HANDLE)
+				return false;
+
+			pAllocation->vMemory = vMemory;
+			pAllocation->mOffset = 0;
+			pAllocation->mSize = vRequirements.size;
+			pAllocation->pMappedData = pMappedData;
+			pAllocation->mMemoryType = memoryType;
+			pAllocation->mBlock = TLSF_INVALID_NODE;
+			pAllocation->mNode = TLSF_INVALID_NODE;
+
+			mDedicatedBytes[memoryType] += vRequirements.size;
+			mDedicatedAllocationCounts[memoryType]++;
+			return true;
+		}
+
+		VkDeviceMemory VulkanMemoryAllocator::AllocateMemory(UI32 memoryType, VkDeviceSize size, VkBuffer vDedicatedBuffer, VkImage vDedicatedImage, BYTE** ppMappedData)
+		{
+			if (mDeviceAllocationCount >= mMaxAllocationCount)
+			{
+				Logger::LogError(TEXT("The device memory allocation limit was reached!"));
+				return VK_NULL_HANDLE;
+			}
+
+			VkMemoryDedicatedAllocateInfo vDedicatedInfo = {};
+			vDedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+			vDedicatedInfo.buffer = vDedicatedBuffer;
+			vDedicatedInfo.image = vDedicatedImage;
+
+			VkMemoryAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			vAI.pNext = mSupportsDedicated && (vDedicatedBuffer || vDedicatedImage) ? &vDedicatedInfo : VK_NULL_HANDLE;
+			vAI.allocationSize = size;
+			vAI.memoryTypeIndex = memoryType;
+
+			VkDeviceMemory vMemory = VK_NULL_HANDLE;
+			if (vkAllocateMemory(vLogicalDevice, &vAI, nullptr, &vMemory) != VK_SUCCESS)
+				return VK_NULL_HANDLE;
+
+			mDeviceAllocationCount++;
+
+			*ppMappedData = nullptr;
+			if (vMemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			{
+				void* pData = nullptr;
+				VK_ASSERT(vkMapMemory(vLogicalDevice, vMemory, 0, VK_WHOLE_SIZE, VK_NULL_HANDLE, &pData), "Failed to map the device memory!");
+				*ppMappedData = static_cast<BYTE*>(pData);
+			}
+
+			return vMemory;
+		}
+
+		void VulkanMemoryAllocator::FreeMemory(VkDeviceMemory vMemory)
+		{
+			// Freeing implicitly unmaps.
+			vkFreeMemory(vLogicalDevice, vMemory, nullptr);
+			mDeviceAllocationCount--;
+		}
+
+		std::vector<UI32> VulkanMemoryAllocator::GetMemoryTypeCandidates(UI32 typeFilter, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred) const
+		{
+			std::vector<UI32> memoryTypes;
+			for (UI32 i = 0; i < vMemoryProperties.memoryTypeCount; i++)
+				if ((typeFilter & (1U << i)) && (vMemoryProperties.memoryTypes[i].propertyFlags & vRequired) == vRequired)
+					memoryTypes.push_back(i);
+
+			// Most preferred properties first, keeping the driver's order otherwise.
+			std::stable_sort(memoryTypes.begin(), memoryTypes.end(), [this, vPreferred](UI32 lhs, UI32 rhs)
+				{
+					return _Helpers::GetSetBitCount(vMemoryProperties.memoryTypes[lhs].propertyFlags & vPreferred)
+						> _Helpers::GetSetBitCount(vMemoryProperties.memoryTypes[rhs].propertyFlags & vPreferred);
+				});
+
+			return memoryTypes;
+		}
+
+		VkDeviceSize VulkanMemoryAllocator::GetBlockSize(UI32 memoryType) const
+		{
+			VkDeviceSize heapSize = vMemoryProperties.memoryHeaps[vMemoryProperties.memoryTypes[memoryType].heapIndex].size;
+			return heapSize < VULKAN_MEMORY_BLOCK_SIZE * 8 ? heapSize / 8 : VULKAN_MEMORY_BLOCK_SIZE;
+		}
+	}
+}
@@ -0,0 +1,291 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <memory>
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+/**
+ * The size of the memory blocks sub allocated from.
+ * Heaps smaller than eight times this use an eighth of the heap instead.
+ */
+#define VULKAN_MEMORY_BLOCK_SIZE		(256ULL * 1024 * 1024)
+
+/**
+ * Allocations at least this fraction of the block size get their own device memory.
+ */
+#define VULKAN_MEMORY_DEDICATED_DIVISOR	2
+
+/**
+ * TLSF first and second level counts. The first level is the power of two of the size, the second level splits
+ * every power of two into 2^TLSF_SL_LOG2 linear ranges.
+ */
+#define TLSF_SL_LOG2					4
+#define TLSF_SL_COUNT					(1 << TLSF_SL_LOG2)
+#define TLSF_FL_COUNT					64
+#define TLSF_SMALL_BLOCK_LOG2			8
+#define TLSF_SMALL_BLOCK_SIZE			(1ULL << TLSF_SMALL_BLOCK_LOG2)
+#define TLSF_INVALID_NODE				UINT32_MAX
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * TLSF Allocator object.
+		 * Two level segregated fit allocator over an abstract range. Allocation and free are O(1): bitmaps locate a free
+		 * list which is guaranteed to fit, and freed ranges are merged with their physical neighbours right away.
+		 * It only deals in offsets, so the same code manages any kind of memory.
+		 */
+		class TLSFAllocator {
+			/**
+			 * Node structure.
+			 * A free or used range. Physical links connect neighbouring ranges, free links connect a free list.
+			 */
+			struct Node {
+				UI64 mOffset = 0;
+				UI64 mSize = 0;
+				UI32 mPrevPhysical = TLSF_INVALID_NODE;
+				UI32 mNextPhysical = TLSF_INVALID_NODE;
+				UI32 mPrevFree = TLSF_INVALID_NODE;
+				UI32 mNextFree = TLSF_INVALID_NODE;
+				bool mIsFree = false;
+			};
+
+		public:
+			TLSFAllocator() {}
+			~TLSFAllocator() {}
+
+			/**
+			 * Initialize the allocator.
+			 *
+			 * @param size: The size of the managed range.
+			 */
+			void Initialize(UI64 size);
+
+			/**
+			 * Allocate a range.
+			 *
+			 * @param size: The size of the range.
+			 * @param alignment: The alignment of the offset. Must be a power of two.
+			 * @param pOffset: The offset to be set.
+			 * @return The node of the allocation. TLSF_INVALID_NODE if nothing fits.
+			 */
+			UI32 Allocate(UI64 size, UI64 alignment, UI64* pOffset);
+
+			/**
+			 * Free a range.
+			 *
+			 * @param node: The node returned by Allocate.
+			 */
+			void Free(UI32 node);
+
+			/**
+			 * Get the smallest managed range in which an allocation is guaranteed to succeed.
+			 * Accounts for the alignment padding and the rounding of the free list search.
+			 *
+			 * @param size: The size of the allocation.
+			 * @param alignment: The alignment of the allocation.
+			 * @return The size.
+			 */
+			static UI64 GetRequiredSize(UI64 size, UI64 alignment);
+
+			UI64 GetSize() const { return mSize; }
+			UI64 GetUsedSize() const { return mUsedSize; }
+			UI32 GetAllocationCount() const { return mAllocationCount; }
+			bool IsEmpty() const { return mAllocationCount == 0; }
+
+			/**
+			 * Get the size of the largest free range.
+			 * Walks the physical list, so it is meant for statistics only.
+			 *
+			 * @return The size.
+			 */
+			UI64 GetLargestFreeSize() const;
+
+		private:
+			UI32 CreateNode();
+			void ReleaseNode(UI32 node);
+
+			void InsertFree(UI32 node);
+			void RemoveFree(UI32 node);
+			UI32 FindFree(UI64 size) const;
+
+			UI32 Split(UI32 node, UI64 size);
+			UI32 Merge(UI32 node, UI32 next);
+
+		private:
+			std::vector<Node> mNodes;
+			std::vector<UI32> mFreeNodeIndexes;
+
+			UI32 mFreeLists[TLSF_FL_COUNT][TLSF_SL_COUNT] = {};
+			UI32 mSecondLevelBitmaps[TLSF_FL_COUNT] = {};
+			UI64 mFirstLevelBitmap = 0;
+
+			UI64 mSize = 0;
+			UI64 mUsedSize = 0;
+			UI32 mAllocationCount = 0;
+		};
+
+		/**
+		 * Vulkan Memory Allocation structure.
+		 */
+		struct VulkanAllocation {
+			VkDeviceMemory vMemory = VK_NULL_HANDLE;
+			VkDeviceSize mOffset = 0;
+			VkDeviceSize mSize = 0;
+			BYTE* pMappedData = nullptr;				// Host pointer to the allocation. nullptr if the memory is not host visible.
+
+			UI32 mMemoryType = 0;
+			UI32 mBlock = TLSF_INVALID_NODE;			// TLSF_INVALID_NODE for dedicated allocations.
+			UI32 mNode = TLSF_INVALID_NODE;
+
+			bool IsValid() const { return vMemory != VK_NULL_HANDLE; }
+		};
+
+		/**
+		 * Vulkan Memory Statistics structure.
+		 */
+		struct VulkanMemoryStatistics {
+			UI64 mBlockBytes = 0;						// Device memory held in blocks.
+			UI64 mUsedBytes = 0;						// Bytes sub allocated from blocks.
+			UI64 mDedicatedBytes = 0;					// Bytes held in dedicated allocations.
+			UI32 mBlockCount = 0;
+			UI32 mAllocationCount = 0;					// Sub allocations.
+			UI32 mDedicatedAllocationCount = 0;
+		};
+
+		/**
+		 * Vulkan Memory Allocator object.
+		 * Takes large blocks of device memory per memory type and sub allocates resources from them with TLSF, so the
+		 * number of vkAllocateMemory calls stays far below maxMemoryAllocationCount. Large resources, and resources the
+		 * driver asks for, get dedicated allocations instead. Host visible blocks stay mapped for their lifetime.
+		 * When bufferImageGranularity is larger than one, linear and optimal resources never share a block.
+		 */
+		class VulkanMemoryAllocator {
+			/**
+			 * Memory block structure.
+			 */
+			struct Block {
+				TLSFAllocator mAllocator = {};
+				VkDeviceMemory vMemory = VK_NULL_HANDLE;
+				BYTE* pMappedData = nullptr;
+				UI32 mMemoryType = 0;
+				bool mIsLinear = false;
+			};
+
+		public:
+			VulkanMemoryAllocator() {}
+			~VulkanMemoryAllocator() {}
+
+			/**
+			 * Initialize the allocator.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 * @param vPhysicalDevice: The physical device.
+			 */
+			void Initialize(VkDevice vLogicalDevice, VkPhysicalDevice vPhysicalDevice);
+
+			/**
+			 * Terminate the allocator.
+			 * Every block is freed. Allocations which are still alive are reported as leaks.
+			 */
+			void Terminate();
+
+			/**
+			 * Allocate and bind memory for a buffer.
+			 *
+			 * @param vBuffer: The buffer.
+			 * @param vRequired: The memory properties the memory must have.
+			 * @param vPreferred: The memory properties the memory should have, if possible.
+			 * @param pAllocation: The allocation to be set.
+			 * @return Boolean value.
+			 */
+			bool AllocateBuffer(VkBuffer vBuffer, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation);
+
+			/**
+			 * Allocate and bind memory for an image.
+			 *
+			 * @param vImage: The image.
+			 * @param vTiling: The tiling the image was created with.
+			 * @param vRequired: The memory properties the memory must have.
+			 * @param vPreferred: The memory properties the memory should have, if possible.
+			 * @param pAllocation: The allocation to be set.
+			 * @return Boolean value.
+			 */
+			bool AllocateImage(VkImage vImage, VkImageTiling vTiling, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation);
+
+			/**
+			 * Allocate memory without binding it to a resource.
+			 * Meant for memory shared by several resources, such as aliased transient attachments. The caller binds the
+			 * resources at offsets within the allocation.
+			 *
+			 * @param vRequirements: The combined memory requirements of the resources.
+			 * @param isLinear: Whether the resources are buffers or linear images.
+			 * @param vRequired: The memory properties the memory must have.
+			 * @param vPreferred: The memory properties the memory should have, if possible.
+			 * @param pAllocation: The allocation to be set.
+			 * @return Boolean value.
+			 */
+			bool AllocateUnbound(const VkMemoryRequirements& vRequirements, bool isLinear, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation);
+
+			/**
+			 * Free an allocation.
+			 * Blocks are kept for reuse; an empty block is released only if another empty block of its kind exists.
+			 *
+			 * @param pAllocation: The allocation. Reset after freeing.
+			 */
+			void Free(VulkanAllocation* pAllocation);
+
+			/**
+			 * Get the memory statistics.
+			 *
+			 * @param pPerHeap: The statistics of each memory heap. Optional.
+			 * @return The total statistics.
+			 */
+			VulkanMemoryStatistics GetStatistics(std::vector<VulkanMemoryStatistics>* pPerHeap = nullptr) const;
+
+			/**
+			 * Dump the statistics of every memory heap and block in a human readable form.
+			 *
+			 * @return The statistics dump.
+			 */
+			String DumpStatistics() const;
+
+			const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return vMemoryProperties; }
+
+		private:
+			bool Allocate(const VkMemoryRequirements& vRequirements, bool requiresDedicated, bool prefersDedicated, bool isLinear,
+				VkBuffer vDedicatedBuffer, VkImage vDedicatedImage,
+				VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VulkanAllocation* pAllocation);
+
+			bool AllocateFromBlocks(UI32 memoryType, const VkMemoryRequirements& vRequirements, bool isLinear, VulkanAllocation* pAllocation);
+			bool AllocateDedicated(UI32 memoryType, const VkMemoryRequirements& vRequirements, VkBuffer vBuffer, VkImage vImage, VulkanAllocation* pAllocation);
+
+			VkDeviceMemory AllocateMemory(UI32 memoryType, VkDeviceSize size, VkBuffer vDedicatedBuffer, VkImage vDedicatedImage, BYTE** ppMappedData);
+			void FreeMemory(VkDeviceMemory vMemory);
+
+			std::vector<UI32> GetMemoryTypeCandidates(UI32 typeFilter, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred) const;
+			VkDeviceSize GetBlockSize(UI32 memoryType) const;
+
+		private:
+			std::vector<std::unique_ptr<Block>> pBlocks;			// nullptr entries are reused.
+			mutable std::mutex mMutex;
+
+			UI64 mDedicatedBytes[VK_MAX_MEMORY_TYPES] = {};
+			UI32 mDedicatedAllocationCounts[VK_MAX_MEMORY_TYPES] = {};
+			UI32 mDeviceAllocationCount = 0;
+
+			VkPhysicalDeviceMemoryProperties vMemoryProperties = {};
+			VkDeviceSize vBufferImageGranularity = 1;
+			UI32 mMaxAllocationCount = 0;
+			bool mSupportsDedicated = false;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+		};
+	}
+}
@@ -0,0 +1,198 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PipelineCache.h"
+#include "Macros.h"
+#include "Core/FileSystem/MappedFile.h"
+#include "Core/Types/Hasher.h"
+#include "Core/Types/Utilities.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#define PIPELINE_CACHE_MAGIC		0x43505353	// "SSPC"
+#define PIPELINE_CACHE_VERSION		1
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Pipeline cache file header structure.
+			 * The driver blob follows the header.
+			 */
+			struct PipelineCacheFileHeader {
+				UI32 mMagic = PIPELINE_CACHE_MAGIC;
+				UI32 mVersion = PIPELINE_CACHE_VERSION;
+				UI32 mVendorID = 0;
+				UI32 mDeviceID = 0;
+				UI32 mDriverVersion = 0;
+				UI32 mReserved = 0;
+				UI8 mPipelineCacheUUID[VK_UUID_SIZE] = {};
+				UI64 mDataSize = 0;
+				UI64 mDataHash = 0;			// Hash of the driver blob, to detect corruption.
+			};
+
+			/**
+			 * Driver pipeline cache header structure.
+			 * The layout the specification mandates for VK_PIPELINE_CACHE_HEADER_VERSION_ONE data.
+			 */
+			struct DriverPipelineCacheHeader {
+				UI32 mHeaderSize = 0;
+				UI32 mHeaderVersion = 0;
+				UI32 mVendorID = 0;
+				UI32 mDeviceID = 0;
+				UI8 mPipelineCacheUUID[VK_UUID_SIZE] = {};
+			};
+
+			/**
+			 * Create a file header for a device.
+			 *
+			 * @param vProperties: The physical device properties.
+			 * @return The header.
+			 */
+			PipelineCacheFileHeader CreateFileHeader(const VkPhysicalDeviceProperties& vProperties)
+			{
+				PipelineCacheFileHeader header = {};
+				header.mVendorID = vProperties.vendorID;
+				header.mDeviceID = vProperties.deviceID;
+				header.mDriverVersion = vProperties.driverVersion;
+				std::memcpy(header.mPipelineCacheUUID, vProperties.pipelineCacheUUID, VK_UUID_SIZE);
+
+				return header;
+			}
+
+			/**
+			 * Hash a block of data.
+			 *
+			 * @param pData: The data.
+			 * @param size: The size of the data in bytes.
+			 * @return The hash.
+			 */
+			UI64 HashData(const void* pData, UI64 size)
+			{
+				Hasher hasher;
+				hasher.Update(pData, size);
+				return hasher.GetHash();
+			}
+		}
+
+		void VulkanPipelineCache::Initialize(VkDevice vLogicalDevice, const VkPhysicalDeviceProperties& vProperties, const char* pFile)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+			this->vProperties = vProperties;
+			mFile = pFile;
+
+			std::vector<BYTE> initialData;
+			if (!Load(&initialData))
+				Logger::LogInfo(TEXT("No usable pipeline cache was found, starting with an empty cache."));
+
+			VkPipelineCacheCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.initialDataSize = static_cast<size_t>(initialData.size());
+			vCI.pInitialData = initialData.data();
+
+			// A driver may still reject data it wrote, so retry empty rather than running without a cache.
+			if (vkCreatePipelineCache(vLogicalDevice, &vCI, nullptr, &vPipelineCache) != VK_SUCCESS && vCI.initialDataSize)
+			{
+				vCI.initialDataSize = 0;
+				vCI.pInitialData = nullptr;
+				VK_ASSERT(vkCreatePipelineCache(vLogicalDevice, &vCI, nullptr, &vPipelineCache), "Failed to create the Vulkan Pipeline Cache!");
+			}
+		}
+
+		void VulkanPipelineCache::Terminate()
+		{
+			if (vPipelineCache == VK_NULL_HANDLE)
+				return;
+
+			if (!Save())
+				Logger::LogWarn((TEXT("Failed to save the pipeline cache: ") + StringToWString(mFile)).c_str());
+
+			vkDestroyPipelineCache(vLogicalDevice, vPipelineCache, nullptr);
+			vPipelineCache = VK_NULL_HANDLE;
+		}
+
+		bool VulkanPipelineCache::Save() const
+		{
+			size_t dataSize = 0;
+			if (vkGetPipelineCacheData(vLogicalDevice, vPipelineCache, &dataSize, nullptr) != VK_SUCCESS || !dataSize)
+				return false;
+
+			std::vector<BYTE> data(dataSize);
+			if (vkGetPipelineCacheData(vLogicalDevice, vPipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+				return false;
+
+			_Helpers::PipelineCacheFileHeader header = _Helpers::CreateFileHeader(vProperties);
+			header.mDataSize = dataSize;
+			header.mDataHash = _Helpers::HashData(data.data(), dataSize);
+
+			std::error_code errorCode;
+			const std::filesystem::path path(mFile);
+			if (path.has_parent_path())
+				std::filesystem::create_directories(path.parent_path(), errorCode);
+
+			const String temporaryPath = mFile + ".tmp";
+			{
+				std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+					return false;
+
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(reinterpret_cast<const char*>(data.data()), dataSize);
+				file.flush();
+
+				if (!file)
+					return false;
+			}
+
+			std::filesystem::rename(temporaryPath, path, errorCode);
+			if (errorCode)
+			{
+				std::filesystem::remove(temporaryPath, errorCode);
+				return false;
+			}
+
+			return true;
+		}
+
+		bool VulkanPipelineCache::Load(std::vector<BYTE>* pData) const
+		{
+			MappedFile file;
+			if (!file.Open(mFile.c_str()) || file.GetSize() < sizeof(_Helpers::PipelineCacheFileHeader))
+				return false;
+
+			_Helpers::PipelineCacheFileHeader header = {};
+			std::memcpy(&header, file.GetData(), sizeof(header));
+
+			const _Helpers::PipelineCacheFileHeader expected = _Helpers::CreateFileHeader(vProperties);
+			if (header.mMagic != expected.mMagic || header.mVersion != expected.mVersion
+				|| header.mVendorID != expected.mVendorID || header.mDeviceID != expected.mDeviceID
+				|| header.mDriverVersion != expected.mDriverVersion
+				|| std::memcmp(header.mPipelineCacheUUID, expected.mPipelineCacheUUID, VK_UUID_SIZE))
+				return false;
+
+			const BYTE* pBlob = file.GetData() + sizeof(header);
+			if (header.mDataSize != file.GetSize() - sizeof(header) || header.mDataHash != _Helpers::HashData(pBlob, header.mDataSize))
+				return false;
+
+			// The driver writes its own header too; check it so a mismatched blob never reaches the driver.
+			_Helpers::DriverPipelineCacheHeader driverHeader = {};
+			if (header.mDataSize < sizeof(driverHeader))
+				return false;
+
+			std::memcpy(&driverHeader, pBlob, sizeof(driverHeader));
+			if (driverHeader.mHeaderVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || driverHeader.mVendorID != vProperties.vendorID
+				|| driverHeader.mDeviceID != vProperties.deviceID || std::memcmp(driverHeader.mPipelineCacheUUID, vProperties.pipelineCacheUUID, VK_UUID_SIZE))
+				return false;
+
+			pData->assign(pBlob, pBlob + header.mDataSize);
+			return true;
+		}
+	}
+}
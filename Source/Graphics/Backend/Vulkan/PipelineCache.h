@@ -0,0 +1,61 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Types/DataTypes.h"
+
+#include <vulkan/vulkan.h>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Pipeline Cache object.
+		 * A VkPipelineCache persisted to disk between runs. The stored data is only handed back to the driver if it was
+		 * written by the same device (vendor, device ID and pipeline cache UUID) and driver version, otherwise the cache
+		 * starts empty and is rewritten on save.
+		 */
+		class VulkanPipelineCache {
+		public:
+			VulkanPipelineCache() {}
+			~VulkanPipelineCache() {}
+
+			/**
+			 * Initialize the pipeline cache.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 * @param vProperties: The physical device properties.
+			 * @param pFile: The file to load the cache from and save it to.
+			 */
+			void Initialize(VkDevice vLogicalDevice, const VkPhysicalDeviceProperties& vProperties, const char* pFile);
+
+			/**
+			 * Terminate the pipeline cache.
+			 * The cache is saved before it is destroyed.
+			 */
+			void Terminate();
+
+			/**
+			 * Save the pipeline cache.
+			 * The data is written to a temporary file and renamed over the previous one, so a crash never leaves a partial cache.
+			 *
+			 * @return Boolean value.
+			 */
+			bool Save() const;
+
+			VkPipelineCache GetHandle() const { return vPipelineCache; }
+
+		private:
+			bool Load(std::vector<BYTE>* pData) const;
+
+		private:
+			String mFile = "";
+			VkPhysicalDeviceProperties vProperties = {};
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+			VkPipelineCache vPipelineCache = VK_NULL_HANDLE;
+		};
+	}
+}
@@ -0,0 +1,398 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PipelineCompiler.h"
+#include "ShaderModule.h"
+#include "Macros.h"
+
+#include <algorithm>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Get the size of a vertex input format in bytes.
+			 *
+			 * @param input: The reflected vertex input.
+			 * @return The size of a single column.
+			 */
+			UI32 GetVertexInputColumnSize(const ShaderVertexInput& input)
+			{
+				switch (input.mType)
+				{
+				case ShaderAttributeType::HALF_FLOAT:
+					return input.mComponentCount * 2;
+
+				case ShaderAttributeType::DOUBLE:
+					return input.mComponentCount * 8;
+
+				default:
+					break;
+				}
+
+				return input.mComponentCount * 4;
+			}
+
+			/**
+			 * Derive a tightly packed vertex binding 0 from the vertex shader reflection.
+			 * Attributes are laid out in location order; matrices take one location per column.
+			 *
+			 * @param reflection: The vertex shader reflection.
+			 * @param pBindings: The binding descriptions to fill.
+			 * @param pAttributes: The attribute descriptions to fill.
+			 */
+			void DeriveVertexInputs(const ShaderReflection& reflection, std::vector<VkVertexInputBindingDescription>* pBindings, std::vector<VkVertexInputAttributeDescription>* pAttributes)
+			{
+				std::vector<ShaderVertexInput> inputs = reflection.mVertexInputs;
+				std::sort(inputs.begin(), inputs.end(), [](const ShaderVertexInput& lhs, const ShaderVertexInput& rhs) { return lhs.mLocation < rhs.mLocation; });
+
+				UI32 offset = 0;
+				for (const ShaderVertexInput& input : inputs)
+				{
+					VkFormat vFormat = GetVertexInputFormat(input);
+					if (vFormat == VK_FORMAT_UNDEFINED)
+						continue;
+
+					for (UI32 column = 0; column < std::max<UI32>(input.mColumnCount, 1); column++)
+					{
+						VkVertexInputAttributeDescription vAttribute = {};
+						vAttribute.location = input.mLocation + column;
+						vAttribute.binding = 0;
+						vAttribute.format = vFormat;
+						vAttribute.offset = offset;
+						pAttributes->push_back(vAttribute);
+
+						offset += GetVertexInputColumnSize(input);
+					}
+				}
+
+				if (pAttributes->empty())
+					return;
+
+				VkVertexInputBindingDescription vBinding = {};
+				vBinding.binding = 0;
+				vBinding.stride = offset;
+				vBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+				pBindings->push_back(vBinding);
+			}
+		}
+
+		void VulkanPipelineCompiler::Initialize(VkDevice vLogicalDevice, VkPipelineCache vPipelineCache, VulkanPipelineLayoutCache* pLayoutCache, UI32 retireFrameCount, UI32 threadCount)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+			this->vPipelineCache = vPipelineCache;
+			this->pLayoutCache = pLayoutCache;
+			this->mRetireFrameCount = retireFrameCount;
+
+			if (threadCount == 0)
+				threadCount = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+
+			mThreadPool.Initialize(threadCount);
+		}
+
+		void VulkanPipelineCompiler::Terminate()
+		{
+			mThreadPool.Wait();
+			mThreadPool.Terminate();
+
+			// Nothing draws anymore, so every pipeline can go right away.
+			for (std::unique_ptr<VulkanPipelineHandle>& pHandle : mHandles)
+			{
+				if (pHandle->vPending != VK_NULL_HANDLE)
+					vkDestroyPipeline(vLogicalDevice, pHandle->vPending, nullptr);
+
+				if (pHandle->vCurrent != VK_NULL_HANDLE)
+					vkDestroyPipeline(vLogicalDevice, pHandle->vCurrent, nullptr);
+			}
+
+			for (RetiredPipeline& retired : mRetiredPipelines)
+				vkDestroyPipeline(vLogicalDevice, retired.vPipeline, nullptr);
+
+			mHandles.clear();
+			mRetiredPipelines.clear();
+			vLogicalDevice = VK_NULL_HANDLE;
+		}
+
+		VulkanPipelineHandle* VulkanPipelineCompiler::CreatePipeline(VkPipeline vPlaceholder)
+		{
+			std::lock_guard<std::mutex> lock(mHandleMutex);
+			mHandles.push_back(std::make_unique<VulkanPipelineHandle>());
+			mHandles.back()->vPlaceholder = vPlaceholder;
+
+			return mHandles.back().get();
+		}
+
+		void VulkanPipelineCompiler::DestroyPipeline(VulkanPipelineHandle* pHandle)
+		{
+			// Results which are still compiling are dropped by the generation check.
+			pHandle->mGeneration++;
+			pHandle->mIsDestroyed = true;
+
+			Retire(pHandle->vCurrent);
+			pHandle->vCurrent = VK_NULL_HANDLE;
+
+			std::lock_guard<std::mutex> lock(pHandle->mPendingMutex);
+			Retire(pHandle->vPending);
+			pHandle->vPending = VK_NULL_HANDLE;
+		}
+
+		void VulkanPipelineCompiler::Compile(VulkanPipelineHandle* pHandle, VulkanPipelineSpecification&& specification)
+		{
+			UI64 generation = ++pHandle->mGeneration;
+			pHandle->mCompilingCount++;
+
+			// std::function must be copyable, the shader codes are not.
+			std::shared_ptr<VulkanPipelineSpecification> pSpecification = std::make_shared<VulkanPipelineSpecification>(std::move(specification));
+			mThreadPool.Submit([this, pHandle, pSpecification, generation]
+				{
+					VkPipelineLayout vLayout = VK_NULL_HANDLE;
+					VkPipelineBindPoint vBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+					VkPipeline vPipeline = VK_NULL_HANDLE;
+
+					// Superseded requests are not worth building.
+					if (pHandle->mGeneration.load() == generation)
+						vPipeline = Build(*pSpecification, &vLayout, &vBindPoint);
+
+					if (vPipeline != VK_NULL_HANDLE)
+					{
+						std::lock_guard<std::mutex> lock(pHandle->mPendingMutex);
+
+						if (pHandle->mGeneration.load() == generation)
+						{
+							// A pending pipeline was never drawn with.
+							if (pHandle->vPending != VK_NULL_HANDLE)
+								vkDestroyPipeline(vLogicalDevice, pHandle->vPending, nullptr);
+
+							pHandle->vPending = vPipeline;
+							pHandle->vPendingLayout = vLayout;
+							pHandle->vPendingBindPoint = vBindPoint;
+						}
+						else
+							vkDestroyPipeline(vLogicalDevice, vPipeline, nullptr);
+					}
+
+					pHandle->mCompilingCount--;
+				});
+		}
+
+		void VulkanPipelineCompiler::SwapPipelines()
+		{
+			{
+				std::lock_guard<std::mutex> handleLock(mHandleMutex);
+
+				for (auto itr = mHandles.begin(); itr != mHandles.end();)
+				{
+					VulkanPipelineHandle* pHandle = itr->get();
+
+					if (pHandle->mIsDestroyed)
+					{
+						if (pHandle->IsCompiling())
+							itr++;
+						else
+							itr = mHandles.erase(itr);
+
+						continue;
+					}
+
+					std::lock_guard<std::mutex> lock(pHandle->mPendingMutex);
+					if (pHandle->vPending != VK_NULL_HANDLE)
+					{
+						Retire(pHandle->vCurrent);
+
+						pHandle->vCurrent = pHandle->vPending;
+						pHandle->vCurrentLayout = pHandle->vPendingLayout;
+						pHandle->vBindPoint = pHandle->vPendingBindPoint;
+						pHandle->vPending = VK_NULL_HANDLE;
+					}
+
+					itr++;
+				}
+			}
+
+			// Destroy the pipelines no frame in flight can be using anymore. Once the frame fence was waited on, only the
+			// last frames in flight minus one submissions may still be executing.
+			auto end = std::remove_if(mRetiredPipelines.begin(), mRetiredPipelines.end(), [this](const RetiredPipeline& retired)
+				{
+					if (retired.mFrameNumber + mRetireFrameCount > mFrameNumber)
+						return false;
+
+					vkDestroyPipeline(vLogicalDevice, retired.vPipeline, nullptr);
+					return true;
+				});
+
+			mRetiredPipelines.erase(end, mRetiredPipelines.end());
+		}
+
+		VkPipeline VulkanPipelineCompiler::Build(VulkanPipelineSpecification& specification, VkPipelineLayout* pLayout, VkPipelineBindPoint* pBindPoint) const
+		{
+			std::vector<const ShaderCode*> pShaders;
+			const ShaderCode* pVertexShader = nullptr;
+			bool isCompute = false;
+
+			for (const ShaderCode& shader : specification.mShaders)
+			{
+				pShaders.push_back(&shader);
+
+				if (shader.GetStage() == ShaderStage::VERTEX)
+					pVertexShader = &shader;
+				else if (shader.GetStage() == ShaderStage::COMPUTE)
+					isCompute = true;
+			}
+
+			if (pShaders.empty() || (isCompute && pShaders.size() > 1))
+			{
+				Logger::LogError(TEXT("A pipeline needs either graphics shaders or a single compute shader!"));
+				return VK_NULL_HANDLE;
+			}
+
+			VkPipelineLayout vLayout = specification.vLayout;
+			if (vLayout == VK_NULL_HANDLE)
+				vLayout = pLayoutCache->GetPipelineLayout(pShaders);
+
+			if (vLayout == VK_NULL_HANDLE)
+				return VK_NULL_HANDLE;
+
+			std::vector<VkPipelineShaderStageCreateInfo> vStages;
+			for (const ShaderCode* pShader : pShaders)
+			{
+				VkPipelineShaderStageCreateInfo vStage = {};
+				vStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+				vStage.stage = GetShaderStageFlag(pShader->GetStage());
+				vStage.module = CreateShaderModule(vLogicalDevice, *pShader);
+				vStage.pName = "main";
+
+				if (vStage.module == VK_NULL_HANDLE)
+				{
+					for (VkPipelineShaderStageCreateInfo& vCreated : vStages)
+						DestroyShaderModule(vLogicalDevice, vCreated.module);
+
+					return VK_NULL_HANDLE;
+				}
+
+				vStages.push_back(vStage);
+			}
+
+			VkPipeline vPipeline = VK_NULL_HANDLE;
+			VkResult vResult = VK_SUCCESS;
+
+			if (isCompute)
+			{
+				VkComputePipelineCreateInfo vCI = {};
+				vCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+				vCI.stage = vStages.front();
+				vCI.layout = vLayout;
+
+				vResult = vkCreateComputePipelines(vLogicalDevice, vPipelineCache, 1, &vCI, nullptr, &vPipeline);
+				*pBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+			}
+			else
+			{
+				if (specification.mVertexBindings.empty() && pVertexShader && pVertexShader->HasReflection())
+					_Helpers::DeriveVertexInputs(pVertexShader->GetReflection(), &specification.mVertexBindings, &specification.mVertexAttributes);
+
+				VkPipelineVertexInputStateCreateInfo vVertexInputState = {};
+				vVertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+				vVertexInputState.vertexBindingDescriptionCount = static_cast<UI32>(specification.mVertexBindings.size());
+				vVertexInputState.pVertexBindingDescriptions = specification.mVertexBindings.data();
+				vVertexInputState.vertexAttributeDescriptionCount = static_cast<UI32>(specification.mVertexAttributes.size());
+				vVertexInputState.pVertexAttributeDescriptions = specification.mVertexAttributes.data();
+
+				VkPipelineInputAssemblyStateCreateInfo vInputAssemblyState = {};
+				vInputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+				vInputAssemblyState.topology = specification.vTopology;
+				vInputAssemblyState.primitiveRestartEnable = VK_FALSE;
+
+				VkPipelineViewportStateCreateInfo vViewportState = {};
+				vViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+				vViewportState.viewportCount = 1;
+				vViewportState.scissorCount = 1;
+
+				VkPipelineRasterizationStateCreateInfo vRasterizationState = {};
+				vRasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+				vRasterizationState.polygonMode = specification.vPolygonMode;
+				vRasterizationState.cullMode = specification.vCullMode;
+				vRasterizationState.frontFace = specification.vFrontFace;
+				vRasterizationState.lineWidth = 1.0f;
+
+				VkPipelineMultisampleStateCreateInfo vMultisampleState = {};
+				vMultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+				vMultisampleState.rasterizationSamples = specification.vSampleCount;
+
+				VkPipelineDepthStencilStateCreateInfo vDepthStencilState = {};
+				vDepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+				vDepthStencilState.depthTestEnable = GET_VK_BOOL(specification.mEnableDepthTest);
+				vDepthStencilState.depthWriteEnable = GET_VK_BOOL(specification.mEnableDepthWrite);
+				vDepthStencilState.depthCompareOp = specification.vDepthCompareOp;
+
+				VkPipelineColorBlendAttachmentState vBlendAttachment = {};
+				vBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+				vBlendAttachment.blendEnable = GET_VK_BOOL(specification.mEnableBlending);
+				vBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+				vBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+				vBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+				vBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				vBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+				vBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+				std::vector<VkPipelineColorBlendAttachmentState> vBlendAttachments(specification.mColorAttachmentCount, vBlendAttachment);
+
+				VkPipelineColorBlendStateCreateInfo vColorBlendState = {};
+				vColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+				vColorBlendState.attachmentCount = static_cast<UI32>(vBlendAttachments.size());
+				vColorBlendState.pAttachments = vBlendAttachments.data();
+
+				VkDynamicState vDynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+				VkPipelineDynamicStateCreateInfo vDynamicState = {};
+				vDynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+				vDynamicState.dynamicStateCount = 2;
+				vDynamicState.pDynamicStates = vDynamicStates;
+
+				VkGraphicsPipelineCreateInfo vCI = {};
+				vCI.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+				vCI.stageCount = static_cast<UI32>(vStages.size());
+				vCI.pStages = vStages.data();
+				vCI.pVertexInputState = &vVertexInputState;
+				vCI.pInputAssemblyState = &vInputAssemblyState;
+				vCI.pViewportState = &vViewportState;
+				vCI.pRasterizationState = &vRasterizationState;
+				vCI.pMultisampleState = &vMultisampleState;
+				vCI.pDepthStencilState = &vDepthStencilState;
+				vCI.pColorBlendState = &vColorBlendState;
+				vCI.pDynamicState = &vDynamicState;
+				vCI.layout = vLayout;
+				vCI.renderPass = specification.vRenderPass;
+				vCI.subpass = specification.mSubpass;
+
+				vResult = vkCreateGraphicsPipelines(vLogicalDevice, vPipelineCache, 1, &vCI, nullptr, &vPipeline);
+				*pBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			}
+
+			for (VkPipelineShaderStageCreateInfo& vStage : vStages)
+				DestroyShaderModule(vLogicalDevice, vStage.module);
+
+			if (vResult != VK_SUCCESS)
+			{
+				Logger::LogError(TEXT("Failed to create the Vulkan Pipeline!"));
+				return VK_NULL_HANDLE;
+			}
+
+			*pLayout = vLayout;
+			return vPipeline;
+		}
+
+		void VulkanPipelineCompiler::Retire(VkPipeline vPipeline)
+		{
+			if (vPipeline == VK_NULL_HANDLE)
+				return;
+
+			RetiredPipeline retired = {};
+			retired.vPipeline = vPipeline;
+			retired.mFrameNumber = mFrameNumber;
+			mRetiredPipelines.push_back(retired);
+		}
+	}
+}
@@ -0,0 +1,181 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PipelineLayoutCache.h"
+#include "Core/Threading/ThreadPool.h"
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Pipeline Specification structure.
+		 * Everything needed to build a graphics pipeline, or a compute pipeline if the only shader is a compute shader.
+		 * Viewport and scissor are always dynamic.
+		 */
+		struct VulkanPipelineSpecification {
+			std::vector<ShaderCode> mShaders;											// Reflected SPIR-V shaders, moved in.
+			std::vector<VkVertexInputBindingDescription> mVertexBindings;				// Empty to derive a packed binding 0 from the vertex shader.
+			std::vector<VkVertexInputAttributeDescription> mVertexAttributes;
+
+			VkRenderPass vRenderPass = VK_NULL_HANDLE;
+			UI32 mSubpass = 0;
+			VkPipelineLayout vLayout = VK_NULL_HANDLE;									// VK_NULL_HANDLE to derive it from the shader reflection.
+
+			VkPrimitiveTopology vTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			VkPolygonMode vPolygonMode = VK_POLYGON_MODE_FILL;
+			VkCullModeFlags vCullMode = VK_CULL_MODE_BACK_BIT;
+			VkFrontFace vFrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+			VkSampleCountFlagBits vSampleCount = VK_SAMPLE_COUNT_1_BIT;
+			VkCompareOp vDepthCompareOp = VK_COMPARE_OP_LESS;
+
+			UI32 mColorAttachmentCount = 1;
+			bool mEnableBlending = false;
+			bool mEnableDepthTest = true;
+			bool mEnableDepthWrite = true;
+		};
+
+		/**
+		 * Vulkan Pipeline Handle object.
+		 * The pipeline drawn with. The render thread always sees a complete pipeline: the last one that finished
+		 * compiling, or the placeholder until the first one does.
+		 */
+		class VulkanPipelineHandle {
+			friend class VulkanPipelineCompiler;
+
+		public:
+			VulkanPipelineHandle() {}
+			~VulkanPipelineHandle() {}
+
+			/**
+			 * Get the pipeline to draw with.
+			 * Only valid on the render thread.
+			 *
+			 * @return The pipeline. The placeholder if nothing finished compiling yet.
+			 */
+			VkPipeline GetPipeline() const { return vCurrent != VK_NULL_HANDLE ? vCurrent : vPlaceholder; }
+			VkPipelineLayout GetLayout() const { return vCurrentLayout; }
+			VkPipelineBindPoint GetBindPoint() const { return vBindPoint; }
+
+			bool IsCompiling() const { return mCompilingCount.load() > 0; }
+			bool IsReady() const { return vCurrent != VK_NULL_HANDLE; }
+
+		private:
+			std::mutex mPendingMutex;
+			VkPipeline vPending = VK_NULL_HANDLE;				// Finished but not swapped in yet. Guarded by the pending mutex.
+			VkPipelineLayout vPendingLayout = VK_NULL_HANDLE;
+			VkPipelineBindPoint vPendingBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+			VkPipeline vCurrent = VK_NULL_HANDLE;
+			VkPipelineLayout vCurrentLayout = VK_NULL_HANDLE;
+			VkPipelineBindPoint vBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			VkPipeline vPlaceholder = VK_NULL_HANDLE;
+
+			std::atomic<UI64> mGeneration = 0;					// Latest request; older results are dropped.
+			std::atomic<UI32> mCompilingCount = 0;
+			bool mIsDestroyed = false;
+		};
+
+		/**
+		 * Vulkan Pipeline Compiler object.
+		 * Builds pipelines on worker threads through the persistent pipeline cache. Finished pipelines are swapped in
+		 * by SwapPipelines at a frame boundary, and the pipelines they replace are destroyed once the frames which may
+		 * still use them are complete.
+		 */
+		class VulkanPipelineCompiler {
+		public:
+			VulkanPipelineCompiler() {}
+			~VulkanPipelineCompiler() {}
+
+			/**
+			 * Initialize the compiler.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 * @param vPipelineCache: The pipeline cache to build the pipelines with.
+			 * @param pLayoutCache: The layout cache to derive pipeline layouts from.
+			 * @param retireFrameCount: The number of frames a replaced pipeline may still be in use for.
+			 * @param threadCount: The number of worker threads. 0 leaves one core for the render thread.
+			 */
+			void Initialize(VkDevice vLogicalDevice, VkPipelineCache vPipelineCache, VulkanPipelineLayoutCache* pLayoutCache, UI32 retireFrameCount, UI32 threadCount = 0);
+
+			/**
+			 * Terminate the compiler.
+			 * Waits for the pipelines which are still compiling and destroys every pipeline.
+			 */
+			void Terminate();
+
+			/**
+			 * Create a pipeline handle.
+			 *
+			 * @param vPlaceholder: The pipeline to draw with until the first compile finishes. Not owned.
+			 * @return The handle, owned by the compiler.
+			 */
+			VulkanPipelineHandle* CreatePipeline(VkPipeline vPlaceholder = VK_NULL_HANDLE);
+
+			/**
+			 * Destroy a pipeline handle.
+			 * Its pipelines are retired like replaced ones.
+			 *
+			 * @param pHandle: The handle.
+			 */
+			void DestroyPipeline(VulkanPipelineHandle* pHandle);
+
+			/**
+			 * Compile a pipeline in the background.
+			 * A newer request for the same handle supersedes an older one which has not been swapped in yet.
+			 *
+			 * @param pHandle: The handle to compile for.
+			 * @param specification: The pipeline specification.
+			 */
+			void Compile(VulkanPipelineHandle* pHandle, VulkanPipelineSpecification&& specification);
+
+			/**
+			 * Swap in the pipelines which finished compiling.
+			 * Call once per frame, on the render thread, after waiting for the fence of the frame and before recording.
+			 */
+			void SwapPipelines();
+
+			/**
+			 * Count a submitted frame.
+			 * Retirement is measured in submitted frames, so frames which were skipped without a submission do not
+			 * release pipelines a frame in flight may still use.
+			 */
+			void EndFrame() { mFrameNumber++; }
+
+			/**
+			 * Set the number of frames a replaced pipeline may still be in use for.
+			 *
+			 * @param retireFrameCount: The frame count.
+			 */
+			void SetRetireFrameCount(UI32 retireFrameCount) { mRetireFrameCount = retireFrameCount; }
+
+		private:
+			VkPipeline Build(VulkanPipelineSpecification& specification, VkPipelineLayout* pLayout, VkPipelineBindPoint* pBindPoint) const;
+			void Retire(VkPipeline vPipeline);
+
+		private:
+			/**
+			 * Retired pipeline structure.
+			 */
+			struct RetiredPipeline {
+				VkPipeline vPipeline = VK_NULL_HANDLE;
+				UI64 mFrameNumber = 0;
+			};
+
+			std::vector<std::unique_ptr<VulkanPipelineHandle>> mHandles;
+			std::mutex mHandleMutex;
+
+			std::vector<RetiredPipeline> mRetiredPipelines;
+			UI64 mFrameNumber = 0;								// The number of submitted frames.
+			UI32 mRetireFrameCount = 2;
+
+			ThreadPool mThreadPool = {};
+			VulkanPipelineLayoutCache* pLayoutCache = nullptr;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+			VkPipelineCache vPipelineCache = VK_NULL_HANDLE;
+		};
+	}
+}
@@ -0,0 +1,267 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PipelineLayoutCache.h"
+#include "ShaderModule.h"
+#include "Macros.h"
+#include "Core/Types/Hasher.h"
+
+#include <algorithm>
+#include <map>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			bool IsEqual(const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs)
+			{
+				return lhs.binding == rhs.binding && lhs.descriptorType == rhs.descriptorType && lhs.descriptorCount == rhs.descriptorCount
+					&& lhs.stageFlags == rhs.stageFlags && lhs.pImmutableSamplers == rhs.pImmutableSamplers;
+			}
+
+			bool IsEqual(const VkPushConstantRange& lhs, const VkPushConstantRange& rhs)
+			{
+				return lhs.stageFlags == rhs.stageFlags && lhs.offset == rhs.offset && lhs.size == rhs.size;
+			}
+
+			template<class Type>
+			bool IsEqual(const std::vector<Type>& lhs, const std::vector<Type>& rhs)
+			{
+				return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const Type& a, const Type& b) { return IsEqual(a, b); });
+			}
+		}
+
+		void VulkanPipelineLayoutCache::Initialize(VkDevice vLogicalDevice)
+		{
+			this->vLogicalDevice = vLogicalDevice;
+		}
+
+		void VulkanPipelineLayoutCache::Terminate()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			for (auto& bucket : mPipelineLayouts)
+				for (PipelineLayoutEntry& entry : bucket.second)
+					vkDestroyPipelineLayout(vLogicalDevice, entry.vLayout, nullptr);
+
+			for (auto& bucket : mDescriptorSetLayouts)
+				for (DescriptorSetLayoutEntry& entry : bucket.second)
+					vkDestroyDescriptorSetLayout(vLogicalDevice, entry.vLayout, nullptr);
+
+			mPipelineLayouts.clear();
+			mDescriptorSetLayouts.clear();
+			vLogicalDevice = VK_NULL_HANDLE;
+		}
+
+		void VulkanPipelineLayoutCache::SetFixedSetLayout(UI32 set, VkDescriptorSetLayout vLayout, const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFixedSetLayouts[set] = { bindings, vLayout };
+		}
+
+		bool VulkanPipelineLayoutCache::IsFixedSet(UI32 set)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mFixedSetLayouts.find(set) != mFixedSetLayouts.end();
+		}
+
+		VkDescriptorSetLayout VulkanPipelineLayoutCache::GetDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+		{
+			Hasher hasher;
+			for (const VkDescriptorSetLayoutBinding& binding : bindings)
+			{
+				hasher.UpdateValue(binding.binding);
+				hasher.UpdateValue(binding.descriptorType);
+				hasher.UpdateValue(binding.descriptorCount);
+				hasher.UpdateValue(binding.stageFlags);
+			}
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			std::vector<DescriptorSetLayoutEntry>& bucket = mDescriptorSetLayouts[hasher.GetHash()];
+
+			for (const DescriptorSetLayoutEntry& entry : bucket)
+				if (_Helpers::IsEqual(entry.mBindings, bindings))
+					return entry.vLayout;
+
+			VkDescriptorSetLayoutCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.bindingCount = static_cast<UI32>(bindings.size());
+			vCI.pBindings = bindings.data();
+
+			DescriptorSetLayoutEntry entry = {};
+			VK_ASSERT(vkCreateDescriptorSetLayout(vLogicalDevice, &vCI, nullptr, &entry.vLayout), "Failed to create the Vulkan Descriptor Set Layout!");
+
+			entry.mBindings = bindings;
+			bucket.push_back(entry);
+			return entry.vLayout;
+		}
+
+		VkPipelineLayout VulkanPipelineLayoutCache::GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+		{
+			Hasher hasher;
+			for (const VkDescriptorSetLayout& vLayout : setLayouts)
+				hasher.UpdateValue(vLayout);
+
+			for (const VkPushConstantRange& range : pushConstantRanges)
+			{
+				hasher.UpdateValue(range.stageFlags);
+				hasher.UpdateValue(range.offset);
+				hasher.UpdateValue(range.size);
+			}
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			std::vector<PipelineLayoutEntry>& bucket = mPipelineLayouts[hasher.GetHash()];
+
+			for (const PipelineLayoutEntry& entry : bucket)
+				if (entry.mSetLayouts == setLayouts && _Helpers::IsEqual(entry.mPushConstantRanges, pushConstantRanges))
+					return entry.vLayout;
+
+			VkPipelineLayoutCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.setLayoutCount = static_cast<UI32>(setLayouts.size());
+			vCI.pSetLayouts = setLayouts.data();
+			vCI.pushConstantRangeCount = static_cast<UI32>(pushConstantRanges.size());
+			vCI.pPushConstantRanges = pushConstantRanges.data();
+
+			PipelineLayoutEntry entry = {};
+			VK_ASSERT(vkCreatePipelineLayout(vLogicalDevice, &vCI, nullptr, &entry.vLayout), "Failed to create the Vulkan Pipeline Layout!");
+
+			entry.mSetLayouts = setLayouts;
+			entry.mPushConstantRanges = pushConstantRanges;
+			bucket.push_back(entry);
+			return entry.vLayout;
+		}
+
+		VkPipelineLayout VulkanPipelineLayoutCache::GetPipelineLayout(const std::vector<const ShaderCode*>& shaders, std::vector<VkDescriptorSetLayout>* pSetLayouts)
+		{
+			// Set -> binding -> merged binding. Ordered so that the layouts come out sorted.
+			std::map<UI32, std::map<UI32, VkDescriptorSetLayoutBinding>> sets;
+			std::vector<VkPushConstantRange> pushConstantRanges;
+
+			for (const ShaderCode* pShaderCode : shaders)
+			{
+				if (!pShaderCode->HasReflection())
+				{
+					Logger::LogError(TEXT("Pipeline layouts can only be created from reflected shaders!"));
+					return VK_NULL_HANDLE;
+				}
+
+				const VkShaderStageFlagBits vStage = GetShaderStageFlag(pShaderCode->GetStage());
+				const ShaderReflection& reflection = pShaderCode->GetReflection();
+
+				for (const ShaderDescriptorBinding& binding : reflection.mDescriptorBindings)
+				{
+					const VkDescriptorType vType = GetDescriptorType(binding.mType);
+
+					// Runtime sized arrays need descriptor indexing, without it they are bound as a single descriptor.
+					const UI32 count = std::max(binding.mCount, 1U);
+
+					auto& bindings = sets[binding.mSet];
+					auto itr = bindings.find(binding.mBinding);
+					if (itr == bindings.end())
+					{
+						VkDescriptorSetLayoutBinding vBinding = {};
+						vBinding.binding = binding.mBinding;
+						vBinding.descriptorType = vType;
+						vBinding.descriptorCount = count;
+						vBinding.stageFlags = vStage;
+						vBinding.pImmutableSamplers = VK_NULL_HANDLE;
+						bindings[binding.mBinding] = vBinding;
+						continue;
+					}
+
+					if (itr->second.descriptorType != vType)
+					{
+						Logger::LogError((TEXT("Conflicting descriptor types at set ") + std::to_wstring(binding.mSet) + TEXT(", binding ") + std::to_wstring(binding.mBinding) + TEXT("!")).c_str());
+						return VK_NULL_HANDLE;
+					}
+
+					itr->second.descriptorCount = std::max(itr->second.descriptorCount, count);
+					itr->second.stageFlags |= vStage;
+				}
+
+				// Vulkan allows a stage in only one range, so each stage gets a range spanning all of its blocks.
+				if (!reflection.mPushConstantRanges.empty())
+				{
+					VkPushConstantRange vRange = {};
+					vRange.stageFlags = vStage;
+					vRange.offset = reflection.mPushConstantRanges.front().mOffset;
+
+					UI32 end = 0;
+					for (const ShaderPushConstantRange& range : reflection.mPushConstantRanges)
+					{
+						vRange.offset = std::min(vRange.offset, range.mOffset);
+						end = std::max(end, range.mOffset + range.mSize);
+					}
+
+					vRange.size = end - vRange.offset;
+					pushConstantRanges.push_back(vRange);
+				}
+			}
+
+			std::map<UI32, FixedSetLayout> fixedSets;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				fixedSets = mFixedSetLayouts;
+			}
+
+			// A shader binding in a fixed set must be one the fixed layout provides, it is never silently replaced.
+			for (const auto& fixed : fixedSets)
+			{
+				auto itr = sets.find(fixed.first);
+				if (itr == sets.end())
+					continue;
+
+				for (const auto& binding : itr->second)
+				{
+					auto match = std::find_if(fixed.second.mBindings.begin(), fixed.second.mBindings.end(), [&binding](const VkDescriptorSetLayoutBinding& vBinding) { return vBinding.binding == binding.first; });
+					if (match == fixed.second.mBindings.end() || match->descriptorType != binding.second.descriptorType || match->descriptorCount < binding.second.descriptorCount)
+					{
+						Logger::LogError((TEXT("Binding ") + std::to_wstring(binding.first) + TEXT(" conflicts with the fixed layout of set ") + std::to_wstring(fixed.first) + TEXT("!")).c_str());
+						return VK_NULL_HANDLE;
+					}
+				}
+			}
+
+			// Fixed sets are always part of the layout, so every derived layout is compatible for them.
+			UI64 setCount = 0;
+			if (!sets.empty())
+				setCount = static_cast<UI64>(sets.rbegin()->first) + 1;
+
+			if (!fixedSets.empty())
+				setCount = std::max(setCount, static_cast<UI64>(fixedSets.rbegin()->first) + 1);
+
+			std::vector<VkDescriptorSetLayout> setLayouts(setCount);
+
+			// Unused sets in between still need a (empty) layout.
+			for (UI32 set = 0; set < setLayouts.size(); set++)
+			{
+				auto fixed = fixedSets.find(set);
+				if (fixed != fixedSets.end())
+				{
+					setLayouts[set] = fixed->second.vLayout;
+					continue;
+				}
+
+				std::vector<VkDescriptorSetLayoutBinding> bindings;
+				auto itr = sets.find(set);
+				if (itr != sets.end())
+					for (const auto& binding : itr->second)
+						bindings.push_back(binding.second);
+
+				setLayouts[set] = GetDescriptorSetLayout(bindings);
+			}
+
+			if (pSetLayouts)
+				*pSetLayouts = setLayouts;
+
+			return GetPipelineLayout(setLayouts, pushConstantRanges);
+		}
+	}
+}
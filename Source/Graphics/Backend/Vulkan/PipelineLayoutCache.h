@@ -0,0 +1,123 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Objects/ShaderCode.h"
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Vulkan Pipeline Layout Cache object.
+		 * Builds descriptor set layouts and pipeline layouts from shader reflection and shares identical layouts,
+		 * so pipelines that use the same resource interface end up with the same (compatible) handles.
+		 * Every handle is owned by the cache and lives until it is terminated.
+		 */
+		class VulkanPipelineLayoutCache {
+		public:
+			VulkanPipelineLayoutCache() {}
+			~VulkanPipelineLayoutCache() {}
+
+			/**
+			 * Initialize the cache.
+			 *
+			 * @param vLogicalDevice: The logical device.
+			 */
+			void Initialize(VkDevice vLogicalDevice);
+
+			/**
+			 * Terminate the cache.
+			 * Every layout created by the cache is destroyed.
+			 */
+			void Terminate();
+
+			/**
+			 * Get a descriptor set layout.
+			 *
+			 * @param bindings: The bindings of the layout, sorted by binding.
+			 * @return The Vulkan descriptor set layout handle.
+			 */
+			VkDescriptorSetLayout GetDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+			/**
+			 * Get a pipeline layout.
+			 *
+			 * @param setLayouts: The descriptor set layouts, indexed by set.
+			 * @param pushConstantRanges: The push constant ranges.
+			 * @return The Vulkan pipeline layout handle.
+			 */
+			VkPipelineLayout GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges);
+
+			/**
+			 * Get the pipeline layout of a set of shaders.
+			 * The bindings of all the stages are merged. Sets which no stage uses get an empty layout.
+			 *
+			 * @param shaders: The reflected shaders of the pipeline.
+			 * @param pSetLayouts: The vector to store the descriptor set layouts in, indexed by set. Optional.
+			 * @return The Vulkan pipeline layout handle. VK_NULL_HANDLE if the shaders are not reflected or their bindings conflict.
+			 */
+			VkPipelineLayout GetPipelineLayout(const std::vector<const ShaderCode*>& shaders, std::vector<VkDescriptorSetLayout>* pSetLayouts = nullptr);
+
+			/**
+			 * Set the layout used for a set instead of the one reflected from the shaders.
+			 * Used for the bindless set, whose runtime sized arrays can not be derived from reflection. Every pipeline
+			 * layout derived from shaders contains the fixed sets, whether the shaders use them or not, and shader
+			 * bindings in a fixed set must match its layout.
+			 *
+			 * @param set: The set index.
+			 * @param vLayout: The descriptor set layout. Not owned by the cache.
+			 * @param bindings: The bindings the layout was created with.
+			 */
+			void SetFixedSetLayout(UI32 set, VkDescriptorSetLayout vLayout, const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+			/**
+			 * Check if a set uses a fixed layout.
+			 * Descriptor sets of fixed sets are owned by whoever set the layout, not allocated per pipeline.
+			 *
+			 * @param set: The set index.
+			 * @return Boolean value.
+			 */
+			bool IsFixedSet(UI32 set);
+
+		private:
+			/**
+			 * Descriptor set layout entry structure.
+			 */
+			struct DescriptorSetLayoutEntry {
+				std::vector<VkDescriptorSetLayoutBinding> mBindings;
+				VkDescriptorSetLayout vLayout = VK_NULL_HANDLE;
+			};
+
+			/**
+			 * Fixed set layout structure.
+			 */
+			struct FixedSetLayout {
+				std::vector<VkDescriptorSetLayoutBinding> mBindings;
+				VkDescriptorSetLayout vLayout = VK_NULL_HANDLE;
+			};
+
+			/**
+			 * Pipeline layout entry structure.
+			 */
+			struct PipelineLayoutEntry {
+				std::vector<VkDescriptorSetLayout> mSetLayouts;
+				std::vector<VkPushConstantRange> mPushConstantRanges;
+				VkPipelineLayout vLayout = VK_NULL_HANDLE;
+			};
+
+			std::unordered_map<UI64, std::vector<DescriptorSetLayoutEntry>> mDescriptorSetLayouts;
+			std::unordered_map<UI64, std::vector<PipelineLayoutEntry>> mPipelineLayouts;
+			std::map<UI32, FixedSetLayout> mFixedSetLayouts;
+			std::mutex mMutex;
+
+			VkDevice vLogicalDevice = VK_NULL_HANDLE;
+		};
+	}
+}
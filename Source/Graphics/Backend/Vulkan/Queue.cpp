@@ -12,7 +12,7 @@ namespace Graphics
 			return mGraphicsFamily.has_value() && mComputeFamily.has_value() && mTransferFamily.has_value();
 		}
 
-		VulkanQueue CreateQueue(VkPhysicalDevice vPhysicalDevice)
+		VulkanQueue CreateQueue(VkPhysicalDevice vPhysicalDevice, VkSurfaceKHR vSurface)
 		{
 			VulkanQueue queue = {};
 			UI32 queueFamilyCount = 0;
@@ -21,29 +21,63 @@ namespace Graphics
 			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
 			vkGetPhysicalDeviceQueueFamilyProperties(vPhysicalDevice, &queueFamilyCount, queueFamilies.data());
 
-			I32 i = 0;
-			for (auto itr = queueFamilies.begin(); itr != queueFamilies.end(); itr++, i++)
+			// Families ordered by preference for each queue. Graphics and compute families support transfers even if
+			// they do not report it.
+			std::optional<UI32> asyncComputeFamily, anyComputeFamily;
+			std::optional<UI32> transferOnlyFamily, nonGraphicsTransferFamily;
+
+			for (UI32 i = 0; i < queueFamilyCount; i++)
 			{
-				if (itr->queueCount > 0)
+				const VkQueueFamilyProperties& family = queueFamilies[i];
+				if (family.queueCount == 0)
+					continue;
+
+				const bool hasGraphics = family.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+				const bool hasCompute = family.queueFlags & VK_QUEUE_COMPUTE_BIT;
+				const bool hasTransfer = hasGraphics || hasCompute || (family.queueFlags & VK_QUEUE_TRANSFER_BIT);
+
+				if (hasGraphics && !queue.mGraphicsFamily.has_value())
 				{
-					// Set graphics family.
-					if (itr->queueFlags & VK_QUEUE_GRAPHICS_BIT)
+					VkBool32 presentSupport = VK_TRUE;
+					if (vSurface != VK_NULL_HANDLE)
+						vkGetPhysicalDeviceSurfaceSupportKHR(vPhysicalDevice, i, vSurface, &presentSupport);
+
+					if (presentSupport)
 						queue.mGraphicsFamily = i;
+				}
 
-					// Set compute family.
-					if (itr->queueFlags & VK_QUEUE_COMPUTE_BIT)
-						queue.mComputeFamily = i;
+				if (hasCompute && !hasGraphics && !asyncComputeFamily.has_value())
+					asyncComputeFamily = i;
 
-					// Set transfer family.
-					if (itr->queueFlags & VK_QUEUE_TRANSFER_BIT)
-						queue.mTransferFamily = i;
+				if (hasCompute && !anyComputeFamily.has_value())
+					anyComputeFamily = i;
 
-					// Escape from the loop if the queues were found.
-					if (queue.IsComplete())
-						break;
-				}
+				if (hasTransfer && !hasGraphics && !hasCompute && !transferOnlyFamily.has_value())
+					transferOnlyFamily = i;
+
+				if (hasTransfer && !hasGraphics && !nonGraphicsTransferFamily.has_value())
+					nonGraphicsTransferFamily = i;
 			}
 
+			if (!queue.mGraphicsFamily.has_value())
+				return queue;
+
+			const bool graphicsHasCompute = queueFamilies[queue.mGraphicsFamily.value()].queueFlags & VK_QUEUE_COMPUTE_BIT;
+
+			if (asyncComputeFamily.has_value())
+				queue.mComputeFamily = asyncComputeFamily;
+			else if (graphicsHasCompute)
+				queue.mComputeFamily = queue.mGraphicsFamily;
+			else
+				queue.mComputeFamily = anyComputeFamily;
+
+			if (transferOnlyFamily.has_value())
+				queue.mTransferFamily = transferOnlyFamily;
+			else if (nonGraphicsTransferFamily.has_value())
+				queue.mTransferFamily = nonGraphicsTransferFamily;
+			else
+				queue.mTransferFamily = queue.mGraphicsFamily;
+
 			return queue;
 		}
 
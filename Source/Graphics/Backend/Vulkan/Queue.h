@@ -22,15 +22,20 @@ namespace Graphics
 			VkQueue vTransferQueue = VK_NULL_HANDLE;
 
 			bool IsComplete() const;
+			bool HasAsyncCompute() const { return IsComplete() && mComputeFamily != mGraphicsFamily; }
+			bool HasDedicatedTransfer() const { return IsComplete() && mTransferFamily != mGraphicsFamily && mTransferFamily != mComputeFamily; }
 		};
 
 		/**
 		 * Create a Vulkan queue.
+		 * Compute prefers a family without graphics support, so compute work can run asynchronously. Transfer prefers
+		 * a transfer only family, which is usually backed by the copy engines. Both fall back to the graphics family.
 		 * 
 		 * @param vPhysicalDevice: The physical device to create the queue.
+		 * @param vSurface: The surface the graphics family must be able to present to. VK_NULL_HANDLE if headless.
 		 * @return The Vulkan Queue struct.
 		 */
-		VulkanQueue CreateQueue(VkPhysicalDevice vPhysicalDevice);
+		VulkanQueue CreateQueue(VkPhysicalDevice vPhysicalDevice, VkSurfaceKHR vSurface = VK_NULL_HANDLE);
 
 		/**
 		 * Get the queues from the logical device.
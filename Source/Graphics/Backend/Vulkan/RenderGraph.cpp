@@ -0,0 +1,800 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "RenderGraph.h"
+#include "VulkanDevice.h"
+#include "Macros.h"
+
+#include "Core/Types/Utilities.h"
+
+#include <algorithm>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Access info structure.
+			 */
+			struct AccessInfo {
+				VkPipelineStageFlags vStages = VK_NULL_HANDLE;
+				VkAccessFlags vAccess = VK_NULL_HANDLE;
+				VkImageLayout vLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkImageUsageFlags vImageUsage = VK_NULL_HANDLE;
+				VkBufferUsageFlags vBufferUsage = VK_NULL_HANDLE;
+				bool mIsWrite = false;
+			};
+
+			constexpr VkPipelineStageFlags ShaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			constexpr VkPipelineStageFlags FragmentTestStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+			constexpr VkAccessFlags WriteAccess = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+				| VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+			/**
+			 * The info of every VulkanRenderGraphAccess, in declaration order.
+			 */
+			const AccessInfo AccessInfos[] = {
+				{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+					VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_NULL_HANDLE, true },
+				{ FragmentTestStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_NULL_HANDLE, true },
+				{ FragmentTestStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+					VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_NULL_HANDLE, false },
+				{ ShaderStages, VK_ACCESS_SHADER_READ_BIT,
+					VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_NULL_HANDLE, false },
+				{ ShaderStages, VK_ACCESS_SHADER_READ_BIT,
+					VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false },
+				{ ShaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+					VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true },
+				{ ShaderStages, VK_ACCESS_UNIFORM_READ_BIT,
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_NULL_HANDLE, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, false },
+				{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_NULL_HANDLE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, false },
+				{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT,
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_NULL_HANDLE, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, false },
+				{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_NULL_HANDLE, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, false },
+				{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+					VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, false },
+				{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true },
+			};
+
+			static_assert(sizeof(AccessInfos) / sizeof(AccessInfo) == static_cast<UI8>(VulkanRenderGraphAccess::MAX), "Every render graph access needs its info!");
+
+			/**
+			 * Get the aspect of an image format.
+			 *
+			 * @param vFormat: The format.
+			 * @return The aspect flags.
+			 */
+			VkImageAspectFlags GetImageAspect(VkFormat vFormat)
+			{
+				switch (vFormat)
+				{
+				case VK_FORMAT_D16_UNORM:
+				case VK_FORMAT_X8_D24_UNORM_PACK32:
+				case VK_FORMAT_D32_SFLOAT:
+					return VK_IMAGE_ASPECT_DEPTH_BIT;
+
+				case VK_FORMAT_S8_UINT:
+					return VK_IMAGE_ASPECT_STENCIL_BIT;
+
+				case VK_FORMAT_D16_UNORM_S8_UINT:
+				case VK_FORMAT_D24_UNORM_S8_UINT:
+				case VK_FORMAT_D32_SFLOAT_S8_UINT:
+					return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+				default:
+					return VK_IMAGE_ASPECT_COLOR_BIT;
+				}
+			}
+
+			/**
+			 * Align an offset up.
+			 *
+			 * @param offset: The offset.
+			 * @param alignment: The alignment. Must be a power of two.
+			 * @return The aligned offset.
+			 */
+			inline VkDeviceSize AlignOffset(VkDeviceSize offset, VkDeviceSize alignment)
+			{
+				return (offset + alignment - 1) & ~(alignment - 1);
+			}
+		}
+
+		VulkanRenderGraphPass& VulkanRenderGraphPass::Read(UI32 resource, VulkanRenderGraphAccess access)
+		{
+			AddAccess(resource, access, false);
+			return *this;
+		}
+
+		VulkanRenderGraphPass& VulkanRenderGraphPass::Write(UI32 resource, VulkanRenderGraphAccess access)
+		{
+			if (!_Helpers::AccessInfos[static_cast<UI8>(access)].mIsWrite)
+			{
+				Logger::LogError(TEXT("The render graph access is read only and can not be declared as a write!"));
+				return *this;
+			}
+
+			AddAccess(resource, access, true);
+			return *this;
+		}
+
+		void VulkanRenderGraphPass::AddAccess(UI32 resource, VulkanRenderGraphAccess access, bool isWrite)
+		{
+			const _Helpers::AccessInfo& info = _Helpers::AccessInfos[static_cast<UI8>(access)];
+
+			auto itr = std::find_if(mUses.begin(), mUses.end(), [resource](const Use& use) { return use.mResource == resource; });
+			if (itr == mUses.end())
+			{
+				Use use = {};
+				use.mResource = resource;
+				use.vLayout = info.vLayout;
+				itr = mUses.insert(mUses.end(), use);
+			}
+
+			// An image can only be in one layout for the whole pass. Checked when compiling, since buffers have none.
+			if (itr->vLayout != info.vLayout)
+				itr->mHasLayoutConflict = true;
+
+			itr->vStages |= info.vStages;
+			itr->vAccess |= info.vAccess;
+			itr->vImageUsage |= info.vImageUsage;
+			itr->vBufferUsage |= info.vBufferUsage;
+			itr->mIsRead |= !isWrite;
+			itr->mIsWrite |= isWrite;
+			itr->mHasImageOnlyAccess |= info.vBufferUsage == VK_NULL_HANDLE;
+			itr->mHasBufferOnlyAccess |= info.vImageUsage == VK_NULL_HANDLE;
+		}
+
+		void VulkanRenderGraph::Initialize(VulkanDevice* pDevice)
+		{
+			this->pDevice = pDevice;
+		}
+
+		void VulkanRenderGraph::Terminate()
+		{
+			Reset();
+			pDevice = nullptr;
+		}
+
+		void VulkanRenderGraph::Reset()
+		{
+			ReleaseTransientResources();
+
+			pPasses.clear();
+			mResources.clear();
+			mPassBarriers.clear();
+			mFinalBarriers.clear();
+
+			mCulledPassCount = 0;
+			mBarrierCount = 0;
+			mIsCompiled = false;
+		}
+
+		UI32 VulkanRenderGraph::CreateImage(const char* pName, const VulkanRenderGraphImageDesc& desc)
+		{
+			Resource resource = {};
+			resource.mName = pName;
+			resource.mImageDesc = desc;
+			resource.mIsImage = true;
+
+			INSERT_INTO_VECTOR(mResources, resource);
+			mIsCompiled = false;
+			return static_cast<UI32>(mResources.size() - 1);
+		}
+
+		UI32 VulkanRenderGraph::CreateBuffer(const char* pName, VkDeviceSize size)
+		{
+			Resource resource = {};
+			resource.mName = pName;
+			resource.mSize = size;
+
+			INSERT_INTO_VECTOR(mResources, resource);
+			mIsCompiled = false;
+			return static_cast<UI32>(mResources.size() - 1);
+		}
+
+		UI32 VulkanRenderGraph::ImportImage(const char* pName, VkImage vImage, VkImageView vImageView, VkFormat vFormat, VkExtent2D vExtent, VkImageLayout vInitialLayout, VkImageLayout vFinalLayout)
+		{
+			Resource resource = {};
+			resource.mName = pName;
+			resource.vImage = vImage;
+			resource.vImageView = vImageView;
+			resource.mImageDesc.vFormat = vFormat;
+			resource.mImageDesc.vExtent = vExtent;
+			resource.vInitialLayout = vInitialLayout;
+			resource.vFinalLayout = vFinalLayout;
+			resource.mIsImage = true;
+			resource.mIsImported = true;
+
+			INSERT_INTO_VECTOR(mResources, resource);
+			mIsCompiled = false;
+			return static_cast<UI32>(mResources.size() - 1);
+		}
+
+		UI32 VulkanRenderGraph::ImportBuffer(const char* pName, VkBuffer vBuffer, VkDeviceSize size)
+		{
+			Resource resource = {};
+			resource.mName = pName;
+			resource.vBuffer = vBuffer;
+			resource.mSize = size;
+			resource.mIsImported = true;
+
+			INSERT_INTO_VECTOR(mResources, resource);
+			mIsCompiled = false;
+			return static_cast<UI32>(mResources.size() - 1);
+		}
+
+		void VulkanRenderGraph::SetImportedImage(UI32 resource, VkImage vImage, VkImageView vImageView)
+		{
+			if (resource >= mResources.size() || !mResources[resource].mIsImported || !mResources[resource].mIsImage)
+			{
+				Logger::LogError(TEXT("The render graph resource is not an imported image!"));
+				return;
+			}
+
+			mResources[resource].vImage = vImage;
+			mResources[resource].vImageView = vImageView;
+		}
+
+		VulkanRenderGraphPass& VulkanRenderGraph::AddPass(const char* pName, VulkanRenderGraphPass::ExecuteFunction&& function)
+		{
+			INSERT_INTO_VECTOR(pPasses, std::make_unique<VulkanRenderGraphPass>(pName, std::move(function)));
+			mIsCompiled = false;
+			return *pPasses.back();
+		}
+
+		bool VulkanRenderGraph::Compile()
+		{
+			ReleaseTransientResources();
+			mIsCompiled = false;
+
+			if (!Validate())
+				return false;
+
+			CullPasses();
+			ComputeLifetimes();
+
+			if (!CreateTransientResources())
+			{
+				ReleaseTransientResources();
+				return false;
+			}
+
+			ComputeBarriers();
+
+			mIsCompiled = true;
+			return true;
+		}
+
+		void VulkanRenderGraph::Execute(VkCommandBuffer vCommandBuffer, VulkanGpuProfiler* pProfiler)
+		{
+			if (!mIsCompiled)
+			{
+				Logger::LogError(TEXT("The render graph must be compiled before it is executed!"));
+				return;
+			}
+
+			for (UI32 i = 0; i < pPasses.size(); i++)
+			{
+				const VulkanRenderGraphPass& pass = *pPasses[i];
+				if (pass.mIsCulled)
+					continue;
+
+				RecordBarriers(vCommandBuffer, mPassBarriers[i]);
+
+				if (pProfiler)
+					pProfiler->BeginScope(vCommandBuffer, pass.mName.c_str());
+
+				pass.mFunction(vCommandBuffer, *this);
+
+				if (pProfiler)
+					pProfiler->EndScope(vCommandBuffer);
+			}
+
+			RecordBarriers(vCommandBuffer, mFinalBarriers);
+		}
+
+		VkDeviceSize VulkanRenderGraph::GetTransientMemorySize() const
+		{
+			VkDeviceSize size = 0;
+			for (const Heap& heap : mHeaps)
+				size += heap.mSize;
+
+			return size;
+		}
+
+		bool VulkanRenderGraph::Validate() const
+		{
+			for (const auto& pPass : pPasses)
+			{
+				for (const VulkanRenderGraphPass::Use& use : pPass->mUses)
+				{
+					if (use.mResource >= mResources.size())
+					{
+						Logger::LogError((TEXT("The render graph pass \"") + StringToWString(pPass->mName) + TEXT("\" uses a resource which does not exist!")).c_str());
+						return false;
+					}
+
+					// Buffer accesses on images and image accesses on buffers have no usage flags to create them with.
+					const Resource& resource = mResources[use.mResource];
+					if ((resource.mIsImage && use.mHasBufferOnlyAccess) || (!resource.mIsImage && use.mHasImageOnlyAccess))
+					{
+						Logger::LogError((TEXT("The render graph pass \"") + StringToWString(pPass->mName) + TEXT("\" uses the ") + (resource.mIsImage ? TEXT("image \"") : TEXT("buffer \""))
+							+ StringToWString(resource.mName) + TEXT("\" with an access it does not support!")).c_str());
+						return false;
+					}
+
+					if (use.mHasLayoutConflict && resource.mIsImage)
+					{
+						Logger::LogError((TEXT("The render graph pass \"") + StringToWString(pPass->mName) + TEXT("\" uses the image \"")
+							+ StringToWString(mResources[use.mResource].mName) + TEXT("\" in two different layouts!")).c_str());
+						return false;
+					}
+				}
+			}
+
+			for (const Resource& resource : mResources)
+			{
+				if (resource.mIsImported)
+					continue;
+
+				if ((resource.mIsImage && (resource.mImageDesc.vExtent.width == 0 || resource.mImageDesc.vExtent.height == 0)) || (!resource.mIsImage && resource.mSize == 0))
+				{
+					Logger::LogError((TEXT("The render graph resource \"") + StringToWString(resource.mName) + TEXT("\" is empty!")).c_str());
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void VulkanRenderGraph::CullPasses()
+		{
+			// Walk back from the outputs. A resource is needed if a pass which is kept reads it before it is overwritten.
+			std::vector<bool> isNeeded(mResources.size(), false);
+			mCulledPassCount = 0;
+
+			for (UI32 i = static_cast<UI32>(pPasses.size()); i > 0; i--)
+			{
+				VulkanRenderGraphPass& pass = *pPasses[i - 1];
+
+				bool isKept = pass.mHasSideEffects;
+				for (const VulkanRenderGraphPass::Use& use : pass.mUses)
+					if (use.mIsWrite && (mResources[use.mResource].mIsImported || isNeeded[use.mResource]))
+						isKept = true;
+
+				pass.mIsCulled = !isKept;
+				if (!isKept)
+				{
+					mCulledPassCount++;
+					continue;
+				}
+
+				for (const VulkanRenderGraphPass::Use& use : pass.mUses)
+					if (use.mIsWrite && !use.mIsRead)
+						isNeeded[use.mResource] = false;
+
+				for (const VulkanRenderGraphPass::Use& use : pass.mUses)
+					if (use.mIsRead)
+						isNeeded[use.mResource] = true;
+			}
+		}
+
+		void VulkanRenderGraph::ComputeLifetimes()
+		{
+			for (Resource& resource : mResources)
+			{
+				resource.mFirstPass = UINT32_MAX;
+				resource.mLastPass = 0;
+				resource.vImageUsage = VK_NULL_HANDLE;
+				resource.vBufferUsage = VK_NULL_HANDLE;
+			}
+
+			for (UI32 i = 0; i < pPasses.size(); i++)
+			{
+				if (pPasses[i]->mIsCulled)
+					continue;
+
+				for (const VulkanRenderGraphPass::Use& use : pPasses[i]->mUses)
+				{
+					Resource& resource = mResources[use.mResource];
+					resource.mFirstPass = std::min(resource.mFirstPass, i);
+					resource.mLastPass = std::max(resource.mLastPass, i);
+					resource.vImageUsage |= use.vImageUsage;
+					resource.vBufferUsage |= use.vBufferUsage;
+				}
+			}
+		}
+
+		bool VulkanRenderGraph::CreateTransientResources()
+		{
+			VkDevice vLogicalDevice = pDevice->vLogicalDevice;
+
+			std::vector<UI32> transients;
+			for (UI32 i = 0; i < mResources.size(); i++)
+			{
+				Resource& resource = mResources[i];
+				if (resource.mIsImported || resource.mFirstPass == UINT32_MAX)
+					continue;
+
+				if (resource.mIsImage)
+				{
+					VkImageCreateInfo vCI = {};
+					vCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+					vCI.flags = VK_NULL_HANDLE;
+					vCI.pNext = VK_NULL_HANDLE;
+					vCI.imageType = VK_IMAGE_TYPE_2D;
+					vCI.format = resource.mImageDesc.vFormat;
+					vCI.extent = { resource.mImageDesc.vExtent.width, resource.mImageDesc.vExtent.height, 1 };
+					vCI.mipLevels = 1;
+					vCI.arrayLayers = 1;
+					vCI.samples = resource.mImageDesc.vSamples;
+					vCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+					vCI.usage = resource.vImageUsage;
+					vCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+					vCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+					VK_ASSERT(vkCreateImage(vLogicalDevice, &vCI, nullptr, &resource.vImage), "Failed to create the render graph image!");
+					vkGetImageMemoryRequirements(vLogicalDevice, resource.vImage, &resource.vRequirements);
+				}
+				else
+				{
+					VkBufferCreateInfo vCI = {};
+					vCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+					vCI.flags = VK_NULL_HANDLE;
+					vCI.pNext = VK_NULL_HANDLE;
+					vCI.size = resource.mSize;
+					vCI.usage = resource.vBufferUsage;
+					vCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+					VK_ASSERT(vkCreateBuffer(vLogicalDevice, &vCI, nullptr, &resource.vBuffer), "Failed to create the render graph buffer!");
+					vkGetBufferMemoryRequirements(vLogicalDevice, resource.vBuffer, &resource.vRequirements);
+				}
+
+				mUnaliasedSize += resource.vRequirements.size;
+				INSERT_INTO_VECTOR(transients, i);
+			}
+
+			// Largest first, so the smaller resources fill the gaps between them.
+			std::sort(transients.begin(), transients.end(), [this](UI32 lhs, UI32 rhs) { return mResources[lhs].vRequirements.size > mResources[rhs].vRequirements.size; });
+
+			for (UI32 i = 0; i < transients.size(); i++)
+			{
+				Resource& resource = mResources[transients[i]];
+
+				// Buffers and optimal images never share a heap, so bufferImageGranularity never applies.
+				UI32 heapIndex = 0;
+				for (; heapIndex < mHeaps.size(); heapIndex++)
+					if (mHeaps[heapIndex].mIsLinear != resource.mIsImage && mHeaps[heapIndex].mMemoryTypeBits == resource.vRequirements.memoryTypeBits)
+						break;
+
+				if (heapIndex == mHeaps.size())
+				{
+					Heap heap = {};
+					heap.mMemoryTypeBits = resource.vRequirements.memoryTypeBits;
+					heap.mIsLinear = !resource.mIsImage;
+					INSERT_INTO_VECTOR(mHeaps, heap);
+				}
+
+				// Only the resources alive at the same time as this one can not share its memory.
+				std::vector<std::pair<VkDeviceSize, VkDeviceSize>> occupiedRanges;
+				for (UI32 j = 0; j < i; j++)
+				{
+					const Resource& other = mResources[transients[j]];
+					if (other.mHeap == heapIndex && other.mFirstPass <= resource.mLastPass && resource.mFirstPass <= other.mLastPass)
+						INSERT_INTO_VECTOR(occupiedRanges, std::make_pair(other.mOffset, other.mOffset + other.vRequirements.size));
+				}
+
+				std::sort(occupiedRanges.begin(), occupiedRanges.end());
+
+				VkDeviceSize offset = 0;
+				for (const auto& range : occupiedRanges)
+				{
+					if (offset + resource.vRequirements.size <= range.first)
+						break;
+
+					offset = std::max(offset, _Helpers::AlignOffset(range.second, resource.vRequirements.alignment));
+				}
+
+				Heap& heap = mHeaps[heapIndex];
+				heap.mSize = std::max(heap.mSize, offset + resource.vRequirements.size);
+				heap.mAlignment = std::max(heap.mAlignment, resource.vRequirements.alignment);
+
+				resource.mHeap = heapIndex;
+				resource.mOffset = offset;
+			}
+
+			for (Heap& heap : mHeaps)
+			{
+				VkMemoryRequirements vRequirements = {};
+				vRequirements.size = heap.mSize;
+				vRequirements.alignment = heap.mAlignment;
+				vRequirements.memoryTypeBits = heap.mMemoryTypeBits;
+
+				if (!pDevice->GetMemoryAllocator().AllocateUnbound(vRequirements, heap.mIsLinear, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_NULL_HANDLE, &heap.mAllocation))
+					return false;
+			}
+
+			for (UI32 index : transients)
+			{
+				Resource& resource = mResources[index];
+				const VulkanAllocation& allocation = mHeaps[resource.mHeap].mAllocation;
+
+				if (!resource.mIsImage)
+				{
+					VK_ASSERT(vkBindBufferMemory(vLogicalDevice, resource.vBuffer, allocation.vMemory, allocation.mOffset + resource.mOffset), "Failed to bind the render graph buffer memory!");
+					continue;
+				}
+
+				VK_ASSERT(vkBindImageMemory(vLogicalDevice, resource.vImage, allocation.vMemory, allocation.mOffset + resource.mOffset), "Failed to bind the render graph image memory!");
+
+				VkImageViewCreateInfo vViewCI = {};
+				vViewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				vViewCI.flags = VK_NULL_HANDLE;
+				vViewCI.pNext = VK_NULL_HANDLE;
+				vViewCI.image = resource.vImage;
+				vViewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				vViewCI.format = resource.mImageDesc.vFormat;
+				vViewCI.subresourceRange.aspectMask = _Helpers::GetImageAspect(resource.mImageDesc.vFormat);
+				vViewCI.subresourceRange.levelCount = 1;
+				vViewCI.subresourceRange.layerCount = 1;
+
+				VK_ASSERT(vkCreateImageView(vLogicalDevice, &vViewCI, nullptr, &resource.vImageView), "Failed to create the render graph image view!");
+
+				if ((resource.vImageUsage & VK_IMAGE_USAGE_SAMPLED_BIT) && vViewCI.subresourceRange.aspectMask == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT))
+				{
+					vViewCI.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+					VK_ASSERT(vkCreateImageView(vLogicalDevice, &vViewCI, nullptr, &resource.vSampledImageView), "Failed to create the render graph sampled image view!");
+				}
+			}
+
+			return true;
+		}
+
+		void VulkanRenderGraph::ComputeBarriers()
+		{
+			// Nothing is known about what happened to imported resources before the graph.
+			std::vector<ResourceState> initialStates(mResources.size());
+			for (UI32 i = 0; i < mResources.size(); i++)
+			{
+				if (!mResources[i].mIsImported)
+					continue;
+
+				initialStates[i].vLayout = mResources[i].vInitialLayout;
+				initialStates[i].vWriteStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+				initialStates[i].vWriteAccess = VK_ACCESS_MEMORY_WRITE_BIT;
+			}
+
+			// The state at the end of a frame is the state the next frame starts in. A transient resource starts by
+			// waiting on the last use of every resource sharing its memory, including its own use in the last frame.
+			std::vector<ResourceState> endStates = SimulateStates(initialStates, false);
+			for (UI32 i = 0; i < mResources.size(); i++)
+			{
+				const Resource& resource = mResources[i];
+				if (resource.mIsImported || resource.mHeap == UINT32_MAX)
+					continue;
+
+				for (UI32 j = 0; j < mResources.size(); j++)
+				{
+					const Resource& other = mResources[j];
+					if (other.mIsImported || other.mHeap != resource.mHeap
+						|| other.mOffset >= resource.mOffset + resource.vRequirements.size || resource.mOffset >= other.mOffset + other.vRequirements.size)
+						continue;
+
+					initialStates[i].vWriteStages |= endStates[j].vWriteStages | endStates[j].vReadStages;
+					initialStates[i].vWriteAccess |= endStates[j].vWriteAccess;
+				}
+			}
+
+			mPassBarriers.assign(pPasses.size(), {});
+			mFinalBarriers.clear();
+			endStates = SimulateStates(initialStates, true);
+
+			// Imported resources are left in their final layout, with the writes of the graph visible to what follows.
+			for (UI32 i = 0; i < mResources.size(); i++)
+			{
+				const Resource& resource = mResources[i];
+				if (!resource.mIsImported || resource.mFirstPass == UINT32_MAX)
+					continue;
+
+				bool isWritten = false;
+				for (const auto& pPass : pPasses)
+					for (const VulkanRenderGraphPass::Use& use : pPass->mUses)
+						if (!pPass->mIsCulled && use.mResource == i && use.mIsWrite)
+							isWritten = true;
+
+				const ResourceState& state = endStates[i];
+				const bool isLayoutChange = resource.mIsImage && resource.vFinalLayout != VK_IMAGE_LAYOUT_UNDEFINED && state.vLayout != resource.vFinalLayout;
+				if (!isLayoutChange && !isWritten)
+					continue;
+
+				Barrier barrier = {};
+				barrier.mResource = i;
+				barrier.vSourceStages = state.vWriteStages | state.vReadStages;
+				barrier.vSourceAccess = state.vWriteAccess;
+				barrier.vDestinationStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+				barrier.vDestinationAccess = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+				barrier.vOldLayout = state.vLayout;
+				barrier.vNewLayout = isLayoutChange ? resource.vFinalLayout : state.vLayout;
+				INSERT_INTO_VECTOR(mFinalBarriers, barrier);
+			}
+
+			mBarrierCount = static_cast<UI32>(mFinalBarriers.size());
+			for (const std::vector<Barrier>& barriers : mPassBarriers)
+				mBarrierCount += static_cast<UI32>(barriers.size());
+		}
+
+		void VulkanRenderGraph::ReleaseTransientResources()
+		{
+			if (!pDevice)
+				return;
+
+			VkDevice vLogicalDevice = pDevice->vLogicalDevice;
+			for (Resource& resource : mResources)
+			{
+				if (resource.mIsImported)
+					continue;
+
+				vkDestroyImageView(vLogicalDevice, resource.vImageView, nullptr);
+				vkDestroyImageView(vLogicalDevice, resource.vSampledImageView, nullptr);
+				vkDestroyImage(vLogicalDevice, resource.vImage, nullptr);
+				vkDestroyBuffer(vLogicalDevice, resource.vBuffer, nullptr);
+
+				resource.vImageView = VK_NULL_HANDLE;
+				resource.vSampledImageView = VK_NULL_HANDLE;
+				resource.vImage = VK_NULL_HANDLE;
+				resource.vBuffer = VK_NULL_HANDLE;
+				resource.mHeap = UINT32_MAX;
+				resource.mOffset = 0;
+			}
+
+			for (Heap& heap : mHeaps)
+				if (heap.mAllocation.IsValid())
+					pDevice->GetMemoryAllocator().Free(&heap.mAllocation);
+
+			mHeaps.clear();
+			mUnaliasedSize = 0;
+		}
+
+		std::vector<VulkanRenderGraph::ResourceState> VulkanRenderGraph::SimulateStates(const std::vector<ResourceState>& initialStates, bool recordBarriers)
+		{
+			std::vector<ResourceState> states = initialStates;
+			for (UI32 i = 0; i < pPasses.size(); i++)
+			{
+				if (pPasses[i]->mIsCulled)
+					continue;
+
+				for (const VulkanRenderGraphPass::Use& use : pPasses[i]->mUses)
+				{
+					const Resource& resource = mResources[use.mResource];
+					ResourceState& state = states[use.mResource];
+
+					const bool isLayoutChange = resource.mIsImage && state.vLayout != use.vLayout;
+					bool needsBarrier = isLayoutChange;
+
+					Barrier barrier = {};
+					barrier.mResource = use.mResource;
+					barrier.vDestinationStages = use.vStages;
+					barrier.vDestinationAccess = use.vAccess;
+					barrier.vOldLayout = state.vLayout;
+					barrier.vNewLayout = resource.mIsImage ? use.vLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+					if (use.mIsWrite)
+					{
+						// Write after write and write after read.
+						needsBarrier |= (state.vWriteStages | state.vReadStages) != 0;
+						barrier.vSourceStages = state.vWriteStages | state.vReadStages;
+						barrier.vSourceAccess = state.vWriteAccess;
+
+						state.vWriteStages = use.vStages;
+						state.vWriteAccess = use.vAccess & _Helpers::WriteAccess;
+						state.vReadStages = VK_NULL_HANDLE;
+						state.vVisibleStages = VK_NULL_HANDLE;
+						state.vVisibleAccess = VK_NULL_HANDLE;
+					}
+					else
+					{
+						// Read after write, unless an earlier barrier already made the write visible to this read. Reads
+						// in the same layout never wait on each other.
+						const bool isVisible = (use.vStages & ~state.vVisibleStages) == 0 && (use.vAccess & ~state.vVisibleAccess) == 0;
+						needsBarrier |= state.vWriteStages != 0 && !isVisible;
+						barrier.vSourceStages = state.vWriteStages | (isLayoutChange ? state.vReadStages : VK_NULL_HANDLE);
+						barrier.vSourceAccess = state.vWriteAccess;
+
+						// The layout transition is a write the later reads must wait on.
+						if (isLayoutChange)
+						{
+							state.vWriteStages = use.vStages;
+							state.vWriteAccess = VK_NULL_HANDLE;
+							state.vReadStages = VK_NULL_HANDLE;
+							state.vVisibleStages = VK_NULL_HANDLE;
+							state.vVisibleAccess = VK_NULL_HANDLE;
+						}
+
+						if (needsBarrier)
+						{
+							state.vVisibleStages |= use.vStages;
+							state.vVisibleAccess |= use.vAccess;
+						}
+
+						state.vReadStages |= use.vStages;
+					}
+
+					if (resource.mIsImage)
+						state.vLayout = use.vLayout;
+
+					if (recordBarriers && needsBarrier)
+						INSERT_INTO_VECTOR(mPassBarriers[i], barrier);
+				}
+			}
+
+			return states;
+		}
+
+		void VulkanRenderGraph::RecordBarriers(VkCommandBuffer vCommandBuffer, const std::vector<Barrier>& barriers) const
+		{
+			if (barriers.empty())
+				return;
+
+			// Every barrier of a pass goes into a single call.
+			VkPipelineStageFlags vSourceStages = VK_NULL_HANDLE;
+			VkPipelineStageFlags vDestinationStages = VK_NULL_HANDLE;
+			std::vector<VkImageMemoryBarrier> vImageBarriers;
+			std::vector<VkBufferMemoryBarrier> vBufferBarriers;
+
+			for (const Barrier& barrier : barriers)
+			{
+				const Resource& resource = mResources[barrier.mResource];
+				vSourceStages |= barrier.vSourceStages;
+				vDestinationStages |= barrier.vDestinationStages;
+
+				if (resource.mIsImage)
+				{
+					VkImageMemoryBarrier vBarrier = {};
+					vBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					vBarrier.pNext = VK_NULL_HANDLE;
+					vBarrier.srcAccessMask = barrier.vSourceAccess;
+					vBarrier.dstAccessMask = barrier.vDestinationAccess;
+					vBarrier.oldLayout = barrier.vOldLayout;
+					vBarrier.newLayout = barrier.vNewLayout;
+					vBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					vBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					vBarrier.image = resource.vImage;
+					vBarrier.subresourceRange.aspectMask = _Helpers::GetImageAspect(resource.mImageDesc.vFormat);
+					vBarrier.subresourceRange.baseMipLevel = 0;
+					vBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+					vBarrier.subresourceRange.baseArrayLayer = 0;
+					vBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+					INSERT_INTO_VECTOR(vImageBarriers, vBarrier);
+				}
+				else
+				{
+					VkBufferMemoryBarrier vBarrier = {};
+					vBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+					vBarrier.pNext = VK_NULL_HANDLE;
+					vBarrier.srcAccessMask = barrier.vSourceAccess;
+					vBarrier.dstAccessMask = barrier.vDestinationAccess;
+					vBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					vBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					vBarrier.buffer = resource.vBuffer;
+					vBarrier.offset = 0;
+					vBarrier.size = VK_WHOLE_SIZE;
+					INSERT_INTO_VECTOR(vBufferBarriers, vBarrier);
+				}
+			}
+
+			// Nothing to wait on, only the layout transition of a resource used for the first time.
+			if (vSourceStages == VK_NULL_HANDLE)
+				vSourceStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+			vkCmdPipelineBarrier(vCommandBuffer, vSourceStages, vDestinationStages, VK_NULL_HANDLE, 0, nullptr,
+				static_cast<UI32>(vBufferBarriers.size()), vBufferBarriers.data(), static_cast<UI32>(vImageBarriers.size()), vImageBarriers.data());
+		}
+	}
+}
@@ -0,0 +1,359 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "MemoryAllocator.h"
+
+#include <functional>
+
+#define VULKAN_RENDER_GRAPH_INVALID_RESOURCE	UINT32_MAX
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		class VulkanDevice;
+		class VulkanGpuProfiler;
+		class VulkanRenderGraph;
+
+		/**
+		 * Vulkan Render Graph Access enum.
+		 * How a pass uses a resource. Every access implies the pipeline stages, access mask and image layout of the use.
+		 */
+		enum class VulkanRenderGraphAccess : UI8 {
+			COLOR_ATTACHMENT,				// Write.
+			DEPTH_STENCIL_ATTACHMENT,		// Write.
+			DEPTH_STENCIL_READ,				// Read only depth and stencil tests.
+			SAMPLED,						// Sampled image, any shader stage.
+			STORAGE_READ,					// Storage image or buffer, any shader stage.
+			STORAGE_WRITE,					// Storage image or buffer, any shader stage. Write.
+			UNIFORM_BUFFER,
+			VERTEX_BUFFER,
+			INDEX_BUFFER,
+			INDIRECT_BUFFER,
+			TRANSFER_SOURCE,
+			TRANSFER_DESTINATION,			// Write.
+			MAX
+		};
+
+		/**
+		 * Vulkan Render Graph Image Description structure.
+		 */
+		struct VulkanRenderGraphImageDesc {
+			VkExtent2D vExtent = {};
+			VkFormat vFormat = VK_FORMAT_R8G8B8A8_UNORM;
+			VkSampleCountFlagBits vSamples = VK_SAMPLE_COUNT_1_BIT;
+		};
+
+		/**
+		 * Vulkan Render Graph Pass object.
+		 * A pass declares every resource it reads and writes. A pass which writes a resource without reading it is
+		 * assumed to overwrite it entirely, so passes which load or blend into an attachment must read it as well.
+		 */
+		class VulkanRenderGraphPass {
+			friend class VulkanRenderGraph;
+
+			/**
+			 * Use structure.
+			 * Every access of a resource in the pass, merged.
+			 */
+			struct Use {
+				VkPipelineStageFlags vStages = VK_NULL_HANDLE;
+				VkAccessFlags vAccess = VK_NULL_HANDLE;
+				VkImageLayout vLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkImageUsageFlags vImageUsage = VK_NULL_HANDLE;
+				VkBufferUsageFlags vBufferUsage = VK_NULL_HANDLE;
+				UI32 mResource = VULKAN_RENDER_GRAPH_INVALID_RESOURCE;
+				bool mIsRead = false;
+				bool mIsWrite = false;
+				bool mHasLayoutConflict = false;
+				bool mHasImageOnlyAccess = false;		// Checked when compiling, once the kind of the resource is known.
+				bool mHasBufferOnlyAccess = false;
+			};
+
+		public:
+			using ExecuteFunction = std::function<void(VkCommandBuffer, const VulkanRenderGraph&)>;
+
+			VulkanRenderGraphPass(const char* pName, ExecuteFunction&& function) : mName(pName), mFunction(std::move(function)) {}
+			~VulkanRenderGraphPass() {}
+
+			/**
+			 * Declare a read.
+			 *
+			 * @param resource: The resource.
+			 * @param access: How the resource is read.
+			 * @return The pass.
+			 */
+			VulkanRenderGraphPass& Read(UI32 resource, VulkanRenderGraphAccess access);
+
+			/**
+			 * Declare a write.
+			 *
+			 * @param resource: The resource.
+			 * @param access: How the resource is written. Must be a write access.
+			 * @return The pass.
+			 */
+			VulkanRenderGraphPass& Write(UI32 resource, VulkanRenderGraphAccess access);
+
+			/**
+			 * Never cull the pass, even if nothing reads what it writes.
+			 *
+			 * @return The pass.
+			 */
+			VulkanRenderGraphPass& SetSideEffects() { mHasSideEffects = true; return *this; }
+
+			const String& GetName() const { return mName; }
+			bool IsCulled() const { return mIsCulled; }
+
+		private:
+			void AddAccess(UI32 resource, VulkanRenderGraphAccess access, bool isWrite);
+
+		private:
+			std::vector<Use> mUses;
+			String mName = "";
+			ExecuteFunction mFunction = {};
+			bool mHasSideEffects = false;
+			bool mIsCulled = false;
+		};
+
+		/**
+		 * Vulkan Render Graph object.
+		 * Passes are added in submission order and declare the resources they use. Compiling the graph:
+		 *	- culls the passes whose writes nothing reads, walking back from the imported resources,
+		 *	- derives the pipeline barriers and layout transitions between the remaining passes, batching the barriers
+		 *	  of each pass and skipping the ones between reads in the same layout,
+		 *	- creates the transient resources and places them in shared memory, so resources whose lifetimes do not
+		 *	  overlap alias each other.
+		 * The compiled graph is executed every frame. Transient resources are shared by the frames in flight: the
+		 * first barrier of every transient resource waits on the last use of the memory it occupies, in this frame
+		 * or the previous one.
+		 * Attachments are in the layout of their access when a pass executes and must be left in it, so render passes
+		 * use the same initial and final layout.
+		 */
+		class VulkanRenderGraph {
+			/**
+			 * Resource structure.
+			 */
+			struct Resource {
+				VulkanRenderGraphImageDesc mImageDesc = {};
+				VkMemoryRequirements vRequirements = {};
+				String mName = "";
+
+				VkImage vImage = VK_NULL_HANDLE;
+				VkImageView vImageView = VK_NULL_HANDLE;
+				VkImageView vSampledImageView = VK_NULL_HANDLE;		// Depth only view of sampled depth stencil images.
+				VkBuffer vBuffer = VK_NULL_HANDLE;
+				VkDeviceSize mSize = 0;								// Buffers only.
+
+				VkImageUsageFlags vImageUsage = VK_NULL_HANDLE;
+				VkBufferUsageFlags vBufferUsage = VK_NULL_HANDLE;
+				VkImageLayout vInitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;	// Imported images only.
+				VkImageLayout vFinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;		// Imported images only.
+
+				VkDeviceSize mOffset = 0;							// Offset in the heap.
+				UI32 mHeap = UINT32_MAX;
+				UI32 mFirstPass = UINT32_MAX;
+				UI32 mLastPass = 0;
+				bool mIsImage = false;
+				bool mIsImported = false;
+			};
+
+			/**
+			 * Resource state structure.
+			 * The synchronization state of a resource at a point of the graph.
+			 */
+			struct ResourceState {
+				VkImageLayout vLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkPipelineStageFlags vWriteStages = VK_NULL_HANDLE;		// The last write.
+				VkAccessFlags vWriteAccess = VK_NULL_HANDLE;
+				VkPipelineStageFlags vReadStages = VK_NULL_HANDLE;		// Reads since the last write.
+				VkPipelineStageFlags vVisibleStages = VK_NULL_HANDLE;	// Stages the last write was made visible to.
+				VkAccessFlags vVisibleAccess = VK_NULL_HANDLE;
+			};
+
+			/**
+			 * Barrier structure.
+			 */
+			struct Barrier {
+				VkPipelineStageFlags vSourceStages = VK_NULL_HANDLE;
+				VkPipelineStageFlags vDestinationStages = VK_NULL_HANDLE;
+				VkAccessFlags vSourceAccess = VK_NULL_HANDLE;
+				VkAccessFlags vDestinationAccess = VK_NULL_HANDLE;
+				VkImageLayout vOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkImageLayout vNewLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				UI32 mResource = VULKAN_RENDER_GRAPH_INVALID_RESOURCE;
+			};
+
+			/**
+			 * Heap structure.
+			 * Memory shared by aliasing resources.
+			 */
+			struct Heap {
+				VulkanAllocation mAllocation = {};
+				VkDeviceSize mSize = 0;
+				VkDeviceSize mAlignment = 1;
+				UI32 mMemoryTypeBits = 0;
+				bool mIsLinear = false;
+			};
+
+		public:
+			VulkanRenderGraph() {}
+			~VulkanRenderGraph() {}
+
+			/**
+			 * Initialize the graph.
+			 *
+			 * @param pDevice: The device.
+			 */
+			void Initialize(VulkanDevice* pDevice);
+
+			/**
+			 * Terminate the graph.
+			 * The GPU must be done with every frame the graph was executed in.
+			 */
+			void Terminate();
+
+			/**
+			 * Remove every pass and resource, to declare the graph again.
+			 * The GPU must be done with every frame the graph was executed in.
+			 */
+			void Reset();
+
+			/**
+			 * Create a transient image. It is only allocated if a pass which is not culled uses it.
+			 *
+			 * @param pName: The name of the image.
+			 * @param desc: The image description. The usage is derived from the passes.
+			 * @return The resource.
+			 */
+			UI32 CreateImage(const char* pName, const VulkanRenderGraphImageDesc& desc);
+
+			/**
+			 * Create a transient buffer. It is only allocated if a pass which is not culled uses it.
+			 *
+			 * @param pName: The name of the buffer.
+			 * @param size: The size of the buffer.
+			 * @return The resource.
+			 */
+			UI32 CreateBuffer(const char* pName, VkDeviceSize size);
+
+			/**
+			 * Import an image the graph does not own, such as a swap chain image.
+			 * Writes to imported resources are the outputs of the graph.
+			 *
+			 * @param pName: The name of the image.
+			 * @param vImage: The image.
+			 * @param vImageView: The image view.
+			 * @param vFormat: The format of the image.
+			 * @param vExtent: The extent of the image.
+			 * @param vInitialLayout: The layout the image is in before the graph executes.
+			 * @param vFinalLayout: The layout the image is left in after the graph executes.
+			 * @return The resource.
+			 */
+			UI32 ImportImage(const char* pName, VkImage vImage, VkImageView vImageView, VkFormat vFormat, VkExtent2D vExtent, VkImageLayout vInitialLayout, VkImageLayout vFinalLayout);
+
+			/**
+			 * Import a buffer the graph does not own.
+			 *
+			 * @param pName: The name of the buffer.
+			 * @param vBuffer: The buffer.
+			 * @param size: The size of the buffer.
+			 * @return The resource.
+			 */
+			UI32 ImportBuffer(const char* pName, VkBuffer vBuffer, VkDeviceSize size);
+
+			/**
+			 * Replace the handles of an imported image, for example with the acquired swap chain image.
+			 * The compiled barriers stay valid as long as the format and layouts do not change.
+			 *
+			 * @param resource: The imported image.
+			 * @param vImage: The image.
+			 * @param vImageView: The image view.
+			 */
+			void SetImportedImage(UI32 resource, VkImage vImage, VkImageView vImageView);
+
+			/**
+			 * Add a pass.
+			 *
+			 * @param pName: The name of the pass.
+			 * @param function: The function recording the pass.
+			 * @return The pass, to declare its resources.
+			 */
+			VulkanRenderGraphPass& AddPass(const char* pName, VulkanRenderGraphPass::ExecuteFunction&& function);
+
+			/**
+			 * Compile the graph.
+			 * Releases the transient resources of the last compilation, so the GPU must be done with them.
+			 *
+			 * @return Boolean value.
+			 */
+			bool Compile();
+
+			/**
+			 * Record the passes which were not culled, with their barriers.
+			 *
+			 * @param vCommandBuffer: The command buffer.
+			 * @param pProfiler: The profiler timing every pass. Optional.
+			 */
+			void Execute(VkCommandBuffer vCommandBuffer, VulkanGpuProfiler* pProfiler = nullptr);
+
+			VkImage GetImage(UI32 resource) const { return mResources[resource].vImage; }
+			VkImageView GetImageView(UI32 resource) const { return mResources[resource].vImageView; }
+
+			/**
+			 * Get the image view to sample an image with.
+			 * Sampling can only read one aspect, so depth stencil images are sampled through a depth only view.
+			 *
+			 * @param resource: The image.
+			 * @return The image view.
+			 */
+			VkImageView GetSampledImageView(UI32 resource) const { return mResources[resource].vSampledImageView != VK_NULL_HANDLE ? mResources[resource].vSampledImageView : mResources[resource].vImageView; }
+			VkBuffer GetBuffer(UI32 resource) const { return mResources[resource].vBuffer; }
+			VkFormat GetFormat(UI32 resource) const { return mResources[resource].mImageDesc.vFormat; }
+			VkExtent2D GetExtent(UI32 resource) const { return mResources[resource].mImageDesc.vExtent; }
+
+			UI32 GetCulledPassCount() const { return mCulledPassCount; }
+			UI32 GetBarrierCount() const { return mBarrierCount; }
+
+			/**
+			 * Get the memory of the transient resources.
+			 *
+			 * @return The size in bytes.
+			 */
+			VkDeviceSize GetTransientMemorySize() const;
+
+			/**
+			 * Get the memory the transient resources would need without aliasing.
+			 *
+			 * @return The size in bytes.
+			 */
+			VkDeviceSize GetUnaliasedMemorySize() const { return mUnaliasedSize; }
+
+		private:
+			bool Validate() const;
+			void CullPasses();
+			void ComputeLifetimes();
+			bool CreateTransientResources();
+			void ComputeBarriers();
+			void ReleaseTransientResources();
+
+			std::vector<ResourceState> SimulateStates(const std::vector<ResourceState>& initialStates, bool recordBarriers);
+			void RecordBarriers(VkCommandBuffer vCommandBuffer, const std::vector<Barrier>& barriers) const;
+
+		private:
+			std::vector<std::unique_ptr<VulkanRenderGraphPass>> pPasses;	// Pointers, so passes stay put while being declared.
+			std::vector<Resource> mResources;
+			std::vector<Heap> mHeaps;
+
+			std::vector<std::vector<Barrier>> mPassBarriers;
+			std::vector<Barrier> mFinalBarriers;
+
+			VulkanDevice* pDevice = nullptr;
+			VkDeviceSize mUnaliasedSize = 0;
+			UI32 mCulledPassCount = 0;
+			UI32 mBarrierCount = 0;
+			bool mIsCompiled = false;
+		};
+	}
+}
@@ -21,23 +21,12 @@ namespace Graphics
 				return availableFormats[0];
 			}
 
-			VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
-			{
-				VkPresentModeKHR bestMode = VK_PRESENT_MODE_FIFO_KHR;
-
-				for (const auto& availablePresentMode : availablePresentModes)
-				{
-					if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-						return availablePresentMode;
-					else if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-						bestMode = availablePresentMode;
-				}
-
-				return bestMode;
-			}
-
 			VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, UI32 width, UI32 height)
 			{
+				// The surface dictates the extent unless it reports the special value.
+				if (capabilities.currentExtent.width != UINT32_MAX)
+					return capabilities.currentExtent;
+
 				VkExtent2D actualExtent = {
 					width,
 					height
@@ -62,7 +51,8 @@ namespace Graphics
 				createInfo.format = imageFormat;
 
 				VkImageSubresourceRange vSubRange = {};
-				vSubRange.baseArrayLayer = 1;
+				vSubRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				vSubRange.baseArrayLayer = 0;
 				vSubRange.layerCount = 1;
 				vSubRange.levelCount = 1;
 				vSubRange.baseMipLevel = 0;
@@ -109,10 +99,45 @@ namespace Graphics
 		}
 
 		void SwapChain::Initialize(VulkanDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset)
+		{
+			Create(pDevice, { width, height }, VK_NULL_HANDLE);
+		}
+
+		void SwapChain::Terminate(VulkanDevice* pDevice)
+		{
+			DestroyImageViews(pDevice);
+
+			// Terminate the Swap Chain.
+			vkDestroySwapchainKHR(pDevice->vLogicalDevice, vSwapChain, nullptr);
+			vSwapChain = VK_NULL_HANDLE;
+			vImages.clear();
+		}
+
+		bool SwapChain::Recreate(VulkanDevice* pDevice, UI32 width, UI32 height)
+		{
+			// The capabilities follow the surface, so they are stale after a resize.
+			pDevice->GetSwapChainSupportDetails() = QuerySwapChainSupportDetails(pDevice->vPhysicalDevice, pDevice->vSurface);
+			pDevice->GetSurfaceCapabilities() = pDevice->GetSwapChainSupportDetails().capabilities;
+
+			VkExtent2D vNewExtent = _Helpers::ChooseSwapExtent(pDevice->GetSurfaceCapabilities(), width, height);
+			if (vNewExtent.width == 0 || vNewExtent.height == 0)
+				return false;
+
+			// Only the images depend on the extent. The frames, render passes and pipelines are kept.
+			DestroyImageViews(pDevice);
+
+			VkSwapchainKHR vOldSwapChain = vSwapChain;
+			Create(pDevice, vNewExtent, vOldSwapChain);
+			vkDestroySwapchainKHR(pDevice->vLogicalDevice, vOldSwapChain, nullptr);
+
+			return true;
+		}
+
+		void SwapChain::Create(VulkanDevice* pDevice, VkExtent2D vImageExtent, VkSwapchainKHR vOldSwapChain)
 		{
 			SwapChainSupportDetails& vSupport = pDevice->GetSwapChainSupportDetails();
 			VkSurfaceFormatKHR surfaceFormat = _Helpers::ChooseSwapSurfaceFormat(vSupport.formats);
-			VkPresentModeKHR presentMode = _Helpers::ChooseSwapPresentMode(vSupport.presentModes);
+			VkPresentModeKHR presentMode = pDevice->GetFramePacer().ChoosePresentMode(vSupport.presentModes);
 
 			VkCompositeAlphaFlagBitsKHR surfaceComposite = static_cast<VkCompositeAlphaFlagBitsKHR>(pDevice->GetSurfaceCapabilities().supportedCompositeAlpha);
 			surfaceComposite = (surfaceComposite & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR)
@@ -128,13 +153,17 @@ namespace Graphics
 			vCI.flags = VK_NULL_HANDLE;
 			vCI.pNext = VK_NULL_HANDLE;
 			vCI.surface = pDevice->vSurface;
-			vCI.minImageCount = pDevice->GetMaxFrameBufferCount();
+			vCI.minImageCount = pDevice->GetFramePacer().ChooseImageCount(vSupport.capabilities, pDevice->GetMaxFrameBufferCount());
 			vCI.imageFormat = surfaceFormat.format;
 			vCI.imageColorSpace = surfaceFormat.colorSpace;
-			vCI.imageExtent = { width, height };
+			vCI.imageExtent = vImageExtent;
 			vCI.imageArrayLayers = 1;
 			vCI.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+			// The frame loop clears the images directly when nothing renders to them.
+			if (vSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+				vCI.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
 			UI32 queueFamilyindices[2] = {
 					pDevice->vQueue.mGraphicsFamily.value(),
 					pDevice->vQueue.mTransferFamily.value()
@@ -157,33 +186,31 @@ namespace Graphics
 			vCI.compositeAlpha = surfaceComposite;
 			vCI.presentMode = presentMode;
 			vCI.clipped = VK_TRUE;
-			vCI.oldSwapchain = VK_NULL_HANDLE;
+			vCI.oldSwapchain = vOldSwapChain;
 
 			// Create the Vulkan Swap Chain.
 			VK_ASSERT(vkCreateSwapchainKHR(pDevice->vLogicalDevice, &vCI, nullptr, &vSwapChain), "Failed to create the Vulkan Swap Chain!");
 
-			// Get the swap chain images.
-			vImages.resize(vCI.minImageCount);
-			VK_ASSERT(vkGetSwapchainImagesKHR(pDevice->vLogicalDevice, vSwapChain, &vCI.minImageCount, vImages.data()), "Failed to get the Vulkan Swap Chain Images!");
+			// Get the swap chain images. The driver may create more than the requested minimum.
+			UI32 imageCount = 0;
+			vkGetSwapchainImagesKHR(pDevice->vLogicalDevice, vSwapChain, &imageCount, nullptr);
+			vImages.resize(imageCount);
+			VK_ASSERT(vkGetSwapchainImagesKHR(pDevice->vLogicalDevice, vSwapChain, &imageCount, vImages.data()), "Failed to get the Vulkan Swap Chain Images!");
 
 			// Create swap chain image views.
 			vImageViews = std::move(_Helpers::CreateImageViews(vImages, vCI.imageFormat, pDevice->vLogicalDevice));
 
 			vFormat = vCI.imageFormat;
+			vExtent = vCI.imageExtent;
 		}
 
-		void SwapChain::Terminate(VulkanDevice* pDevice)
+		void SwapChain::DestroyImageViews(VulkanDevice* pDevice)
 		{
 			// Terminate the image views.
 			for (auto itr = vImageViews.begin(); itr != vImageViews.end(); itr++)
 				vkDestroyImageView(pDevice->vLogicalDevice, *itr, nullptr);
 
 			vImageViews.clear();
-
-			// Terminate the Swap Chain.
-			vkDestroySwapchainKHR(pDevice->vLogicalDevice, vSwapChain, nullptr);
-			vSwapChain = VK_NULL_HANDLE;
-			vImages.clear();
 		}
 	}
 }
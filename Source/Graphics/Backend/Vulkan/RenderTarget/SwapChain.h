@@ -38,12 +38,35 @@ namespace Graphics
 			void Initialize(VulkanDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset);
 			void Terminate(VulkanDevice* pDevice);
 
+			/**
+			 * Recreate the swap chain for a new surface extent.
+			 * The old swap chain is handed to the new one so the presentation engine can reuse its resources, and is
+			 * destroyed afterwards. The GPU must be done with every image of the old swap chain.
+			 *
+			 * @param pDevice: The device.
+			 * @param width: The width of the window.
+			 * @param height: The height of the window.
+			 * @return False if the surface has a zero extent (minimized). The swap chain is left as is.
+			 */
+			bool Recreate(VulkanDevice* pDevice, UI32 width, UI32 height);
+
+			VkSwapchainKHR GetHandle() const { return vSwapChain; }
+			const std::vector<VkImage>& GetImages() const { return vImages; }
+			const std::vector<VkImageView>& GetImageViews() const { return vImageViews; }
+			VkFormat GetFormat() const { return vFormat; }
+			VkExtent2D GetExtent() const { return vExtent; }
+
+		private:
+			void Create(VulkanDevice* pDevice, VkExtent2D vImageExtent, VkSwapchainKHR vOldSwapChain);
+			void DestroyImageViews(VulkanDevice* pDevice);
+
 		private:
 			std::vector<VkImage> vImages;
 			std::vector<VkImageView> vImageViews;
 
 			VkSwapchainKHR vSwapChain = VK_NULL_HANDLE;
 			VkFormat vFormat = VkFormat::VK_FORMAT_UNDEFINED;
+			VkExtent2D vExtent = {};
 		};
 	}
 }
\ No newline at end of file
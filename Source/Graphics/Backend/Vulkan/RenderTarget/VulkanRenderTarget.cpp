@@ -3,11 +3,86 @@
 
 #include "VulkanRenderTarget.h"
 #include "Graphics/Backend/Vulkan/VulkanDevice.h"
+#include "Graphics/Backend/Vulkan/Macros.h"
+
+#include <cstring>
 
 namespace Graphics
 {
 	namespace VulkanBackend
 	{
+		namespace _Helpers
+		{
+			/**
+			 * Create a device local image with its memory and a view.
+			 *
+			 * @param pDevice: The device.
+			 * @param vExtent: The image extent.
+			 * @param vFormat: The image format.
+			 * @param vUsage: The image usage.
+			 * @param vAspect: The aspect of the view.
+			 * @param pImage: The image handle to be set.
+			 * @param pAllocation: The memory allocation to be set.
+			 * @param pImageView: The view handle to be set.
+			 */
+			void CreateAttachmentImage(VulkanDevice* pDevice, VkExtent2D vExtent, VkFormat vFormat, VkImageUsageFlags vUsage, VkImageAspectFlags vAspect, VkImage* pImage, VulkanAllocation* pAllocation, VkImageView* pImageView)
+			{
+				VkImageCreateInfo vImageCI = {};
+				vImageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				vImageCI.flags = VK_NULL_HANDLE;
+				vImageCI.pNext = VK_NULL_HANDLE;
+				vImageCI.imageType = VK_IMAGE_TYPE_2D;
+				vImageCI.format = vFormat;
+				vImageCI.extent = { vExtent.width, vExtent.height, 1 };
+				vImageCI.mipLevels = 1;
+				vImageCI.arrayLayers = 1;
+				vImageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+				vImageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+				vImageCI.usage = vUsage;
+				vImageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				vImageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				VK_ASSERT(vkCreateImage(pDevice->vLogicalDevice, &vImageCI, nullptr, pImage), "Failed to create the off screen image!");
+
+				pDevice->GetMemoryAllocator().AllocateImage(*pImage, vImageCI.tiling, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_NULL_HANDLE, pAllocation);
+
+				VkImageViewCreateInfo vViewCI = {};
+				vViewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				vViewCI.flags = VK_NULL_HANDLE;
+				vViewCI.pNext = VK_NULL_HANDLE;
+				vViewCI.image = *pImage;
+				vViewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				vViewCI.format = vFormat;
+				vViewCI.subresourceRange.aspectMask = vAspect;
+				vViewCI.subresourceRange.levelCount = 1;
+				vViewCI.subresourceRange.layerCount = 1;
+
+				VK_ASSERT(vkCreateImageView(pDevice->vLogicalDevice, &vViewCI, nullptr, pImageView), "Failed to create the off screen image view!");
+			}
+
+			/**
+			 * Find the first depth format usable as an optimal tiling attachment.
+			 *
+			 * @param vPhysicalDevice: The physical device.
+			 * @return The depth format. VK_FORMAT_UNDEFINED if none is supported.
+			 */
+			VkFormat FindDepthFormat(VkPhysicalDevice vPhysicalDevice)
+			{
+				const VkFormat vCandidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+
+				for (VkFormat vFormat : vCandidates)
+				{
+					VkFormatProperties vProperties = {};
+					vkGetPhysicalDeviceFormatProperties(vPhysicalDevice, vFormat, &vProperties);
+
+					if (vProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+						return vFormat;
+				}
+
+				return VK_FORMAT_UNDEFINED;
+			}
+		}
+
 		void VulkanRenderTargetSB3D::Initialize(GDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset)
 		{
 			mSwapChain.Initialize(dynamic_cast<VulkanDevice*>(pDevice), width, height, xOffset, yOffset);
@@ -15,6 +90,129 @@ namespace Graphics
 
 		void VulkanRenderTargetSB3D::Terminate(GDevice* pDevice)
 		{
+			mSwapChain.Terminate(dynamic_cast<VulkanDevice*>(pDevice));
+		}
+
+		void VulkanRenderTargetOS::Initialize(GDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset)
+		{
+			VulkanDevice* pVulkanDevice = dynamic_cast<VulkanDevice*>(pDevice);
+			vExtent = { width, height };
+
+			_Helpers::CreateAttachmentImage(pVulkanDevice, vExtent, vColorFormat,
+				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+				VK_IMAGE_ASPECT_COLOR_BIT, &vColorImage, &mColorAllocation, &vColorImageView);
+
+			if (mType != RenderTargetType::OFF_SCREEN_3D)
+				return;
+
+			vDepthFormat = _Helpers::FindDepthFormat(pVulkanDevice->vPhysicalDevice);
+			if (vDepthFormat == VK_FORMAT_UNDEFINED)
+			{
+				Logger::LogError(TEXT("No supported depth format was found for the off screen render target!"));
+				return;
+			}
+
+			_Helpers::CreateAttachmentImage(pVulkanDevice, vExtent, vDepthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+				VK_IMAGE_ASPECT_DEPTH_BIT, &vDepthImage, &mDepthAllocation, &vDepthImageView);
+		}
+
+		void VulkanRenderTargetOS::Terminate(GDevice* pDevice)
+		{
+			VulkanDevice* pVulkanDevice = dynamic_cast<VulkanDevice*>(pDevice);
+			VkDevice vLogicalDevice = pVulkanDevice->vLogicalDevice;
+
+			vkDestroyImageView(vLogicalDevice, vDepthImageView, nullptr);
+			vkDestroyImage(vLogicalDevice, vDepthImage, nullptr);
+			pVulkanDevice->GetMemoryAllocator().Free(&mDepthAllocation);
+
+			vkDestroyImageView(vLogicalDevice, vColorImageView, nullptr);
+			vkDestroyImage(vLogicalDevice, vColorImage, nullptr);
+			pVulkanDevice->GetMemoryAllocator().Free(&mColorAllocation);
+
+			vDepthImageView = VK_NULL_HANDLE;
+			vDepthImage = VK_NULL_HANDLE;
+			vColorImageView = VK_NULL_HANDLE;
+			vColorImage = VK_NULL_HANDLE;
+		}
+
+		bool VulkanRenderTargetOS::ReadPixels(GDevice* pDevice, std::vector<BYTE>* pPixels)
+		{
+			VulkanDevice* pVulkanDevice = dynamic_cast<VulkanDevice*>(pDevice);
+			VkDevice vLogicalDevice = pVulkanDevice->vLogicalDevice;
+			VkDeviceSize size = static_cast<VkDeviceSize>(vExtent.width) * vExtent.height * 4;
+
+			// Host visible buffer to copy the image into.
+			VkBufferCreateInfo vBufferCI = {};
+			vBufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			vBufferCI.flags = VK_NULL_HANDLE;
+			vBufferCI.pNext = VK_NULL_HANDLE;
+			vBufferCI.size = size;
+			vBufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			vBufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VkBuffer vBuffer = VK_NULL_HANDLE;
+			if (vkCreateBuffer(vLogicalDevice, &vBufferCI, nullptr, &vBuffer) != VK_SUCCESS)
+			{
+				Logger::LogError(TEXT("Failed to create the off screen read back buffer!"));
+				return false;
+			}
+
+			// Cached memory makes the host read fast.
+			VulkanAllocation allocation = {};
+			if (!pVulkanDevice->GetMemoryAllocator().AllocateBuffer(vBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, &allocation))
+			{
+				vkDestroyBuffer(vLogicalDevice, vBuffer, nullptr);
+				return false;
+			}
+
+			// The frames in flight may still render to the image.
+			pVulkanDevice->WaitIdle();
+
+			VkCommandBuffer vCommandBuffer = pVulkanDevice->BeginOneTimeCommands();
+
+			VkImageMemoryBarrier vBarrier = {};
+			vBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			vBarrier.pNext = VK_NULL_HANDLE;
+			vBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vBarrier.oldLayout = vColorLayout;
+			vBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			vBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBarrier.image = vColorImage;
+			vBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			vBarrier.subresourceRange.levelCount = 1;
+			vBarrier.subresourceRange.layerCount = 1;
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &vBarrier);
+
+			VkBufferImageCopy vRegion = {};
+			vRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			vRegion.imageSubresource.layerCount = 1;
+			vRegion.imageExtent = { vExtent.width, vExtent.height, 1 };
+			vkCmdCopyImageToBuffer(vCommandBuffer, vColorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vBuffer, 1, &vRegion);
+
+			VkBufferMemoryBarrier vBufferBarrier = {};
+			vBufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			vBufferBarrier.pNext = VK_NULL_HANDLE;
+			vBufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vBufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vBufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBufferBarrier.buffer = vBuffer;
+			vBufferBarrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &vBufferBarrier, 0, nullptr);
+
+			pVulkanDevice->EndOneTimeCommands(vCommandBuffer);
+			vColorLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+			// Host visible allocations stay mapped.
+			pPixels->resize(static_cast<size_t>(size));
+			std::memcpy(pPixels->data(), allocation.pMappedData, static_cast<size_t>(size));
+
+			vkDestroyBuffer(vLogicalDevice, vBuffer, nullptr);
+			pVulkanDevice->GetMemoryAllocator().Free(&allocation);
+
+			return true;
 		}
 	}
 }
@@ -5,6 +5,7 @@
 
 #include "Graphics/Core/GRenderTarget.h"
 #include "SwapChain.h"
+#include "Graphics/Backend/Vulkan/MemoryAllocator.h"
 
 namespace Graphics
 {
@@ -21,8 +22,60 @@ namespace Graphics
 			virtual void Initialize(GDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset) override final;
 			virtual void Terminate(GDevice* pDevice) override final;
 
+			SwapChain& GetSwapChain() { return mSwapChain; }
+
 		private:
 			SwapChain mSwapChain = {};
 		};
+
+		/**
+		 * Vulkan Render Target OS (Off Screen) object.
+		 * Renders into device local images instead of a swap chain, so no window or surface is needed. Off screen 3D
+		 * targets also have a depth attachment. The color image can be read back to the host.
+		 */
+		class VulkanRenderTargetOS : public GRenderTarget {
+		public:
+			VulkanRenderTargetOS(RenderTargetType type) : GRenderTarget(type) {}
+			~VulkanRenderTargetOS() {}
+
+			virtual void Initialize(GDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset) override final;
+			virtual void Terminate(GDevice* pDevice) override final;
+
+			/**
+			 * Read the color attachment back to the host.
+			 * Waits for the device to be idle, so it is meant for tooling and tests rather than every frame.
+			 *
+			 * @param pDevice: The device the target was created with.
+			 * @param pPixels: The tightly packed RGBA8 pixels.
+			 * @return Boolean value.
+			 */
+			bool ReadPixels(GDevice* pDevice, std::vector<BYTE>* pPixels);
+
+			VkImage GetColorImage() const { return vColorImage; }
+			VkImageView GetColorImageView() const { return vColorImageView; }
+			VkImage GetDepthImage() const { return vDepthImage; }
+			VkImageView GetDepthImageView() const { return vDepthImageView; }
+			VkFormat GetColorFormat() const { return vColorFormat; }
+			VkFormat GetDepthFormat() const { return vDepthFormat; }
+			VkExtent2D GetExtent() const { return vExtent; }
+
+			/**
+			 * The layout the color image is left in by the last recorded command buffer.
+			 */
+			VkImageLayout vColorLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		private:
+			VkImage vColorImage = VK_NULL_HANDLE;
+			VkImageView vColorImageView = VK_NULL_HANDLE;
+			VulkanAllocation mColorAllocation = {};
+
+			VkImage vDepthImage = VK_NULL_HANDLE;
+			VkImageView vDepthImageView = VK_NULL_HANDLE;
+			VulkanAllocation mDepthAllocation = {};
+
+			VkFormat vColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+			VkFormat vDepthFormat = VK_FORMAT_UNDEFINED;
+			VkExtent2D vExtent = {};
+		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,628 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VulkanRenderTargetCompute.h"
+#include "Graphics/Backend/Vulkan/VulkanDevice.h"
+#include "Graphics/Backend/Vulkan/ShaderModule.h"
+#include "Graphics/Backend/Vulkan/Macros.h"
+#include "Core/FileSystem/MappedFile.h"
+#include "Core/Types/Utilities.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		namespace _Helpers
+		{
+			/**
+			 * Check if a shader resource is backed by a buffer.
+			 *
+			 * @param type: The resource type.
+			 * @return Boolean value.
+			 */
+			bool IsBufferResource(ShaderResourceType type)
+			{
+				return type == ShaderResourceType::UNIFORM_BUFFER || type == ShaderResourceType::STORAGE_BUFFER;
+			}
+
+			/**
+			 * Create a buffer and allocate its memory.
+			 *
+			 * @param pDevice: The device.
+			 * @param size: The size of the buffer.
+			 * @param vUsage: The buffer usage.
+			 * @param vRequired: The required memory properties.
+			 * @param vPreferred: The preferred memory properties.
+			 * @param pBuffer: The buffer handle to be set.
+			 * @param pAllocation: The memory allocation to be set.
+			 * @return Boolean value.
+			 */
+			bool CreateComputeBuffer(VulkanDevice* pDevice, VkDeviceSize size, VkBufferUsageFlags vUsage, VkMemoryPropertyFlags vRequired, VkMemoryPropertyFlags vPreferred, VkBuffer* pBuffer, VulkanAllocation* pAllocation)
+			{
+				VkBufferCreateInfo vBufferCI = {};
+				vBufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				vBufferCI.flags = VK_NULL_HANDLE;
+				vBufferCI.pNext = VK_NULL_HANDLE;
+				vBufferCI.size = size;
+				vBufferCI.usage = vUsage;
+				vBufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				if (vkCreateBuffer(pDevice->vLogicalDevice, &vBufferCI, nullptr, pBuffer) != VK_SUCCESS)
+				{
+					Logger::LogError(TEXT("Failed to create the compute buffer!"));
+					return false;
+				}
+
+				if (!pDevice->GetMemoryAllocator().AllocateBuffer(*pBuffer, vRequired, vPreferred, pAllocation))
+				{
+					vkDestroyBuffer(pDevice->vLogicalDevice, *pBuffer, nullptr);
+					*pBuffer = VK_NULL_HANDLE;
+					return false;
+				}
+
+				return true;
+			}
+		}
+
+		void VulkanRenderTargetCompute::Initialize(GDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset)
+		{
+			this->pDevice = dynamic_cast<VulkanDevice*>(pDevice);
+
+			UI32 queueFamilyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(this->pDevice->vPhysicalDevice, &queueFamilyCount, nullptr);
+
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(this->pDevice->vPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+
+			// One time commands run on the graphics queue.
+			const float timestampPeriod = this->pDevice->GetPhysicalDeviceProperties().limits.timestampPeriod;
+			if (queueFamilies[this->pDevice->vQueue.mGraphicsFamily.value()].timestampValidBits == 0 || timestampPeriod <= 0.0f)
+			{
+				Logger::LogInfo(TEXT("The graphics queue does not support timestamps. Compute dispatches are not timed."));
+				return;
+			}
+
+			VkQueryPoolCreateInfo vQueryPoolCI = {};
+			vQueryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			vQueryPoolCI.flags = VK_NULL_HANDLE;
+			vQueryPoolCI.pNext = VK_NULL_HANDLE;
+			vQueryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			vQueryPoolCI.queryCount = 2;
+
+			if (vkCreateQueryPool(this->pDevice->vLogicalDevice, &vQueryPoolCI, nullptr, &vQueryPool) != VK_SUCCESS)
+			{
+				Logger::LogWarn(TEXT("Failed to create the compute timestamp query pool! Compute dispatches are not timed."));
+				vQueryPool = VK_NULL_HANDLE;
+				return;
+			}
+
+			mTimestampPeriod = timestampPeriod;
+		}
+
+		void VulkanRenderTargetCompute::Terminate(GDevice* pDevice)
+		{
+			DestroyPipeline();
+
+			for (Buffer& buffer : mBuffers)
+				DestroyBuffer(&buffer);
+
+			mBuffers.clear();
+
+			if (vQueryPool != VK_NULL_HANDLE)
+				vkDestroyQueryPool(this->pDevice->vLogicalDevice, vQueryPool, nullptr);
+
+			vQueryPool = VK_NULL_HANDLE;
+		}
+
+		bool VulkanRenderTargetCompute::SetShader(ShaderCode&& shaderCode)
+		{
+			if (shaderCode.GetStage() != ShaderStage::COMPUTE || !shaderCode.HasReflection())
+			{
+				Logger::LogError(TEXT("The compute playground needs a reflected compute shader!"));
+				return false;
+			}
+
+			VulkanPipelineLayoutCache& layoutCache = pDevice->GetPipelineLayoutCache();
+			for (const ShaderDescriptorBinding& binding : shaderCode.GetReflection().mDescriptorBindings)
+			{
+				if (!_Helpers::IsBufferResource(binding.mType) || binding.mCount != 1)
+				{
+					Logger::LogError((TEXT("The compute playground only binds single uniform and storage buffers! Unsupported binding: ") + StringToWString(binding.mName)).c_str());
+					return false;
+				}
+
+				// Fixed sets such as the bindless set are owned by the device, the playground can not put buffers in them.
+				if (layoutCache.IsFixedSet(binding.mSet))
+				{
+					Logger::LogError((TEXT("The compute playground can not bind buffers in the fixed set ") + std::to_wstring(binding.mSet) + TEXT("! Unsupported binding: ") + StringToWString(binding.mName)).c_str());
+					return false;
+				}
+			}
+
+			VkDevice vLogicalDevice = pDevice->vLogicalDevice;
+
+			// Dispatches wait for the GPU, so the previous pipeline is idle.
+			DestroyPipeline();
+			mShader = std::move(shaderCode);
+
+			vPipelineLayout = layoutCache.GetPipelineLayout({ &mShader }, &vSetLayouts);
+			if (vPipelineLayout == VK_NULL_HANDLE)
+			{
+				Logger::LogError(TEXT("Failed to create the compute pipeline layout!"));
+				return false;
+			}
+
+			// Matches the range the layout cache derived for the stage.
+			mPushConstantOffset = 0;
+			mPushConstantSize = 0;
+			const std::vector<ShaderPushConstantRange>& pushConstantRanges = mShader.GetReflection().mPushConstantRanges;
+			if (!pushConstantRanges.empty())
+			{
+				UI32 end = 0;
+				mPushConstantOffset = pushConstantRanges.front().mOffset;
+				for (const ShaderPushConstantRange& range : pushConstantRanges)
+				{
+					mPushConstantOffset = std::min(mPushConstantOffset, range.mOffset);
+					end = std::max(end, range.mOffset + range.mSize);
+				}
+
+				mPushConstantSize = end - mPushConstantOffset;
+			}
+
+			VkPipelineShaderStageCreateInfo vStage = {};
+			vStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			vStage.flags = VK_NULL_HANDLE;
+			vStage.pNext = VK_NULL_HANDLE;
+			vStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			vStage.module = CreateShaderModule(vLogicalDevice, mShader);
+			vStage.pName = "main";
+
+			if (vStage.module == VK_NULL_HANDLE)
+				return false;
+
+			VkComputePipelineCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.stage = vStage;
+			vCI.layout = vPipelineLayout;
+
+			VkResult vResult = vkCreateComputePipelines(vLogicalDevice, pDevice->GetPipelineCache(), 1, &vCI, nullptr, &vPipeline);
+			DestroyShaderModule(vLogicalDevice, vStage.module);
+
+			if (vResult != VK_SUCCESS)
+			{
+				Logger::LogError(TEXT("Failed to create the compute pipeline!"));
+				vPipeline = VK_NULL_HANDLE;
+				return false;
+			}
+
+			// One set per layout, including the empty layouts of unused sets, so sets can be bound by index. Fixed sets
+			// are left null: their layouts need pools the playground does not create, and the device binds them.
+			UI32 uniformCount = 0, storageCount = 0;
+			for (const ShaderDescriptorBinding& binding : mShader.GetReflection().mDescriptorBindings)
+			{
+				if (binding.mType == ShaderResourceType::UNIFORM_BUFFER)
+					uniformCount++;
+				else
+					storageCount++;
+			}
+
+			std::vector<VkDescriptorSetLayout> vAllocatedLayouts;
+			std::vector<UI32> allocatedSets;
+			for (UI32 set = 0; set < vSetLayouts.size(); set++)
+			{
+				if (layoutCache.IsFixedSet(set))
+					continue;
+
+				INSERT_INTO_VECTOR(vAllocatedLayouts, vSetLayouts[set]);
+				INSERT_INTO_VECTOR(allocatedSets, set);
+			}
+
+			vDescriptorSets.assign(vSetLayouts.size(), VK_NULL_HANDLE);
+			if (vAllocatedLayouts.empty())
+				return true;
+
+			std::vector<VkDescriptorPoolSize> vPoolSizes;
+			if (uniformCount)
+				INSERT_INTO_VECTOR(vPoolSizes, VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, uniformCount });
+
+			if (storageCount)
+				INSERT_INTO_VECTOR(vPoolSizes, VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageCount });
+
+			VkDescriptorPoolCreateInfo vPoolCI = {};
+			vPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			vPoolCI.flags = VK_NULL_HANDLE;
+			vPoolCI.pNext = VK_NULL_HANDLE;
+			vPoolCI.maxSets = static_cast<UI32>(vAllocatedLayouts.size());
+			vPoolCI.poolSizeCount = static_cast<UI32>(vPoolSizes.size());
+			vPoolCI.pPoolSizes = vPoolSizes.data();
+
+			if (vkCreateDescriptorPool(vLogicalDevice, &vPoolCI, nullptr, &vDescriptorPool) != VK_SUCCESS)
+			{
+				Logger::LogError(TEXT("Failed to create the compute descriptor pool!"));
+				vDescriptorPool = VK_NULL_HANDLE;
+				return false;
+			}
+
+			VkDescriptorSetAllocateInfo vAllocateInfo = {};
+			vAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			vAllocateInfo.pNext = VK_NULL_HANDLE;
+			vAllocateInfo.descriptorPool = vDescriptorPool;
+			vAllocateInfo.descriptorSetCount = static_cast<UI32>(vAllocatedLayouts.size());
+			vAllocateInfo.pSetLayouts = vAllocatedLayouts.data();
+
+			std::vector<VkDescriptorSet> vAllocatedSets(vAllocatedLayouts.size());
+			VK_ASSERT(vkAllocateDescriptorSets(vLogicalDevice, &vAllocateInfo, vAllocatedSets.data()), "Failed to allocate the compute descriptor sets!");
+
+			for (UI64 i = 0; i < allocatedSets.size(); i++)
+				vDescriptorSets[allocatedSets[i]] = vAllocatedSets[i];
+
+			mAreDescriptorsDirty = true;
+			return true;
+		}
+
+		bool VulkanRenderTargetCompute::CreateBuffer(UI32 set, UI32 binding, VkDeviceSize size, const void* pData)
+		{
+			if (size == 0)
+			{
+				Logger::LogError(TEXT("Compute buffers can not be empty!"));
+				return false;
+			}
+
+			Buffer buffer = {};
+			buffer.mSet = set;
+			buffer.mBinding = binding;
+			buffer.mSize = size;
+
+			const VkBufferUsageFlags vUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			if (!_Helpers::CreateComputeBuffer(pDevice, size, vUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, &buffer.vBuffer, &buffer.mAllocation))
+				return false;
+
+			if (pData && !CopyToBuffer(buffer, pData, size))
+			{
+				DestroyBuffer(&buffer);
+				return false;
+			}
+
+			// The old buffer may still be bound by a dispatch, but dispatches wait for the GPU.
+			Buffer* pOld = FindBuffer(set, binding);
+			if (pOld)
+			{
+				DestroyBuffer(pOld);
+				*pOld = buffer;
+			}
+			else
+				INSERT_INTO_VECTOR(mBuffers, buffer);
+
+			mAreDescriptorsDirty = true;
+			return true;
+		}
+
+		bool VulkanRenderTargetCompute::LoadBuffer(UI32 set, UI32 binding, const char* pFile)
+		{
+			MappedFile file;
+			if (!file.Open(pFile))
+			{
+				Logger::LogError((TEXT("Failed to open the compute buffer file: ") + StringToWString(pFile)).c_str());
+				return false;
+			}
+
+			return CreateBuffer(set, binding, static_cast<VkDeviceSize>(file.GetSize()), file.GetData());
+		}
+
+		bool VulkanRenderTargetCompute::GenerateBuffer(UI32 set, UI32 binding, VkDeviceSize size, VulkanComputeGenerator generator)
+		{
+			switch (generator)
+			{
+			case Graphics::VulkanBackend::VulkanComputeGenerator::ZEROS:
+				return GenerateBuffer(set, binding, size, [](BYTE* pData, VkDeviceSize size) { std::memset(pData, 0, static_cast<size_t>(size)); });
+
+			case Graphics::VulkanBackend::VulkanComputeGenerator::INDICES:
+				return GenerateBuffer(set, binding, size, [](BYTE* pData, VkDeviceSize size)
+					{
+						UI32* pElements = reinterpret_cast<UI32*>(pData);
+						for (VkDeviceSize i = 0; i < size / sizeof(UI32); i++)
+							pElements[i] = static_cast<UI32>(i);
+					});
+
+			case Graphics::VulkanBackend::VulkanComputeGenerator::RANDOM_FLOATS:
+				return GenerateBuffer(set, binding, size, [](BYTE* pData, VkDeviceSize size)
+					{
+						std::mt19937 engine(0);
+						std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+						float* pElements = reinterpret_cast<float*>(pData);
+						for (VkDeviceSize i = 0; i < size / sizeof(float); i++)
+							pElements[i] = distribution(engine);
+					});
+
+			default:
+				break;
+			}
+
+			return false;
+		}
+
+		bool VulkanRenderTargetCompute::GenerateBuffer(UI32 set, UI32 binding, VkDeviceSize size, const GeneratorFunction& function)
+		{
+			// Zeroed first so the tail past the last whole element is defined.
+			std::vector<BYTE> data(static_cast<size_t>(size), 0);
+			function(data.data(), size);
+
+			return CreateBuffer(set, binding, size, data.data());
+		}
+
+		bool VulkanRenderTargetCompute::Dispatch(const VulkanComputeDispatch& dispatch, VulkanComputeDispatchResult* pResult)
+		{
+			if (vPipeline == VK_NULL_HANDLE)
+			{
+				Logger::LogError(TEXT("No compute shader was set!"));
+				return false;
+			}
+
+			// The data covers the reflected range, starting at its offset.
+			if (dispatch.mPushConstants.size() != mPushConstantSize)
+			{
+				Logger::LogError((TEXT("The push constants are ") + std::to_wstring(dispatch.mPushConstants.size()) + TEXT(" bytes, the shader expects ") + std::to_wstring(mPushConstantSize) + TEXT("!")).c_str());
+				return false;
+			}
+
+			if (mAreDescriptorsDirty && !UpdateDescriptorSets())
+				return false;
+
+			VkDevice vLogicalDevice = pDevice->vLogicalDevice;
+			VkCommandBuffer vCommandBuffer = pDevice->BeginOneTimeCommands();
+
+			if (vQueryPool != VK_NULL_HANDLE)
+				vkCmdResetQueryPool(vCommandBuffer, vQueryPool, 0, 2);
+
+			vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vPipeline);
+
+			for (UI32 set = 0; set < vDescriptorSets.size(); set++)
+			{
+				if (vDescriptorSets[set] != VK_NULL_HANDLE)
+					vkCmdBindDescriptorSets(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vPipelineLayout, set, 1, &vDescriptorSets[set], 0, nullptr);
+				else if (set == VULKAN_BINDLESS_SET && pDevice->IsBindlessEnabled())
+					pDevice->GetBindlessTable().Bind(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vPipelineLayout);
+			}
+
+			if (mPushConstantSize)
+				vkCmdPushConstants(vCommandBuffer, vPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, mPushConstantOffset, mPushConstantSize, dispatch.mPushConstants.data());
+
+			// Uploads and earlier read backs must be done before the first iteration.
+			VkMemoryBarrier vBarrier = {};
+			vBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			vBarrier.pNext = VK_NULL_HANDLE;
+			vBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+			vBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &vBarrier, 0, nullptr, 0, nullptr);
+
+			if (vQueryPool != VK_NULL_HANDLE)
+				vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vQueryPool, 0);
+
+			// Iterations run back to back, so each sees the results of the previous one.
+			const UI32 iterations = std::max(dispatch.mIterations, 1U);
+			vBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			vBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+			for (UI32 i = 0; i < iterations; i++)
+			{
+				if (i > 0)
+					vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &vBarrier, 0, nullptr, 0, nullptr);
+
+				vkCmdDispatch(vCommandBuffer, dispatch.mGroupCountX, dispatch.mGroupCountY, dispatch.mGroupCountZ);
+			}
+
+			if (vQueryPool != VK_NULL_HANDLE)
+				vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vQueryPool, 1);
+
+			// Read backs copy from the buffers afterwards.
+			vBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			vBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &vBarrier, 0, nullptr, 0, nullptr);
+
+			pDevice->EndOneTimeCommands(vCommandBuffer);
+
+			if (!pResult)
+				return true;
+
+			*pResult = {};
+			if (mTrafficBytes)
+				pResult->mBytes = mTrafficBytes;
+			else
+			{
+				for (const ShaderDescriptorBinding& binding : mShader.GetReflection().mDescriptorBindings)
+				{
+					Buffer* pBuffer = FindBuffer(binding.mSet, binding.mBinding);
+					if (pBuffer)
+						pResult->mBytes += pBuffer->mSize;
+				}
+			}
+
+			if (vQueryPool == VK_NULL_HANDLE)
+				return true;
+
+			// The commands have finished, so the results are available without waiting.
+			UI64 timestamps[2] = {};
+			if (vkGetQueryPoolResults(vLogicalDevice, vQueryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(UI64), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+			{
+				Logger::LogWarn(TEXT("Failed to read the compute timestamps!"));
+				return true;
+			}
+
+			const double nanoseconds = static_cast<double>(timestamps[1] - timestamps[0]) * mTimestampPeriod / iterations;
+			pResult->mGpuTime = nanoseconds / 1000000.0;
+
+			// Bytes per nanosecond are gigabytes per second.
+			if (nanoseconds > 0.0)
+				pResult->mBandwidth = static_cast<double>(pResult->mBytes) / nanoseconds;
+
+			return true;
+		}
+
+		bool VulkanRenderTargetCompute::ReadBuffer(UI32 set, UI32 binding, std::vector<BYTE>* pData)
+		{
+			Buffer* pBuffer = FindBuffer(set, binding);
+			if (!pBuffer)
+			{
+				Logger::LogError(TEXT("No compute buffer exists for the binding!"));
+				return false;
+			}
+
+			// Cached memory makes the host read fast.
+			VkBuffer vStaging = VK_NULL_HANDLE;
+			VulkanAllocation allocation = {};
+			if (!_Helpers::CreateComputeBuffer(pDevice, pBuffer->mSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, &vStaging, &allocation))
+				return false;
+
+			VkCommandBuffer vCommandBuffer = pDevice->BeginOneTimeCommands();
+
+			VkBufferCopy vRegion = {};
+			vRegion.size = pBuffer->mSize;
+			vkCmdCopyBuffer(vCommandBuffer, pBuffer->vBuffer, vStaging, 1, &vRegion);
+
+			VkBufferMemoryBarrier vBufferBarrier = {};
+			vBufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			vBufferBarrier.pNext = VK_NULL_HANDLE;
+			vBufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vBufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vBufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBufferBarrier.buffer = vStaging;
+			vBufferBarrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &vBufferBarrier, 0, nullptr);
+
+			pDevice->EndOneTimeCommands(vCommandBuffer);
+
+			// Host visible allocations stay mapped.
+			pData->resize(static_cast<size_t>(pBuffer->mSize));
+			std::memcpy(pData->data(), allocation.pMappedData, static_cast<size_t>(pBuffer->mSize));
+
+			vkDestroyBuffer(pDevice->vLogicalDevice, vStaging, nullptr);
+			pDevice->GetMemoryAllocator().Free(&allocation);
+
+			return true;
+		}
+
+		bool VulkanRenderTargetCompute::SaveBuffer(UI32 set, UI32 binding, const char* pFile)
+		{
+			std::vector<BYTE> data;
+			if (!ReadBuffer(set, binding, &data))
+				return false;
+
+			std::ofstream file(pFile, std::ios::out | std::ios::binary);
+			if (!file.is_open())
+			{
+				Logger::LogError((TEXT("Failed to open the compute buffer file: ") + StringToWString(pFile)).c_str());
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(data.data()), data.size());
+			return true;
+		}
+
+		VulkanRenderTargetCompute::Buffer* VulkanRenderTargetCompute::FindBuffer(UI32 set, UI32 binding)
+		{
+			for (Buffer& buffer : mBuffers)
+				if (buffer.mSet == set && buffer.mBinding == binding)
+					return &buffer;
+
+			return nullptr;
+		}
+
+		void VulkanRenderTargetCompute::DestroyBuffer(Buffer* pBuffer)
+		{
+			if (pBuffer->vBuffer != VK_NULL_HANDLE)
+				vkDestroyBuffer(pDevice->vLogicalDevice, pBuffer->vBuffer, nullptr);
+
+			pDevice->GetMemoryAllocator().Free(&pBuffer->mAllocation);
+			pBuffer->vBuffer = VK_NULL_HANDLE;
+		}
+
+		void VulkanRenderTargetCompute::DestroyPipeline()
+		{
+			// The layouts are owned by the layout cache.
+			if (vPipeline != VK_NULL_HANDLE)
+				vkDestroyPipeline(pDevice->vLogicalDevice, vPipeline, nullptr);
+
+			if (vDescriptorPool != VK_NULL_HANDLE)
+				vkDestroyDescriptorPool(pDevice->vLogicalDevice, vDescriptorPool, nullptr);
+
+			vPipeline = VK_NULL_HANDLE;
+			vPipelineLayout = VK_NULL_HANDLE;
+			vDescriptorPool = VK_NULL_HANDLE;
+			vSetLayouts.clear();
+			vDescriptorSets.clear();
+		}
+
+		bool VulkanRenderTargetCompute::CopyToBuffer(const Buffer& buffer, const void* pData, VkDeviceSize size)
+		{
+			VkBuffer vStaging = VK_NULL_HANDLE;
+			VulkanAllocation allocation = {};
+			if (!_Helpers::CreateComputeBuffer(pDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, &vStaging, &allocation))
+				return false;
+
+			std::memcpy(allocation.pMappedData, pData, static_cast<size_t>(size));
+
+			VkCommandBuffer vCommandBuffer = pDevice->BeginOneTimeCommands();
+
+			VkBufferCopy vRegion = {};
+			vRegion.size = size;
+			vkCmdCopyBuffer(vCommandBuffer, vStaging, buffer.vBuffer, 1, &vRegion);
+
+			pDevice->EndOneTimeCommands(vCommandBuffer);
+
+			vkDestroyBuffer(pDevice->vLogicalDevice, vStaging, nullptr);
+			pDevice->GetMemoryAllocator().Free(&allocation);
+
+			return true;
+		}
+
+		bool VulkanRenderTargetCompute::UpdateDescriptorSets()
+		{
+			const std::vector<ShaderDescriptorBinding>& bindings = mShader.GetReflection().mDescriptorBindings;
+
+			// Filled first, so the writes can point into it without it reallocating.
+			std::vector<VkDescriptorBufferInfo> vBufferInfos;
+			vBufferInfos.reserve(bindings.size());
+
+			std::vector<VkWriteDescriptorSet> vWrites;
+			for (const ShaderDescriptorBinding& binding : bindings)
+			{
+				Buffer* pBuffer = FindBuffer(binding.mSet, binding.mBinding);
+				if (!pBuffer)
+				{
+					Logger::LogError((TEXT("No compute buffer was created for the binding: ") + StringToWString(binding.mName)).c_str());
+					return false;
+				}
+
+				VkDescriptorBufferInfo vBufferInfo = {};
+				vBufferInfo.buffer = pBuffer->vBuffer;
+				vBufferInfo.offset = 0;
+				vBufferInfo.range = VK_WHOLE_SIZE;
+				INSERT_INTO_VECTOR(vBufferInfos, vBufferInfo);
+
+				VkWriteDescriptorSet vWrite = {};
+				vWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				vWrite.pNext = VK_NULL_HANDLE;
+				vWrite.dstSet = vDescriptorSets[binding.mSet];
+				vWrite.dstBinding = binding.mBinding;
+				vWrite.descriptorCount = 1;
+				vWrite.descriptorType = GetDescriptorType(binding.mType);
+				vWrite.pBufferInfo = &vBufferInfos.back();
+				INSERT_INTO_VECTOR(vWrites, vWrite);
+			}
+
+			if (!vWrites.empty())
+				vkUpdateDescriptorSets(pDevice->vLogicalDevice, static_cast<UI32>(vWrites.size()), vWrites.data(), 0, nullptr);
+
+			mAreDescriptorsDirty = false;
+			return true;
+		}
+	}
+}
@@ -0,0 +1,200 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Graphics/Core/GRenderTarget.h"
+#include "Graphics/Backend/Vulkan/MemoryAllocator.h"
+#include "Core/Objects/ShaderCode.h"
+
+#include <functional>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		class VulkanDevice;
+
+		/**
+		 * Vulkan Compute Generator enum.
+		 * Built in contents for buffers which are not loaded from a file.
+		 */
+		enum class VulkanComputeGenerator : UI8 {
+			ZEROS,
+			INDICES,				// UI32 element i is i.
+			RANDOM_FLOATS,			// Floats in [0, 1), from a fixed seed so runs are comparable.
+		};
+
+		/**
+		 * Vulkan Compute Dispatch structure.
+		 */
+		struct VulkanComputeDispatch {
+			std::vector<BYTE> mPushConstants;		// The reflected push constant range, from its offset. Must match its size.
+			UI32 mGroupCountX = 1;
+			UI32 mGroupCountY = 1;
+			UI32 mGroupCountZ = 1;
+			UI32 mIterations = 1;		// The dispatch is repeated and the timings averaged.
+		};
+
+		/**
+		 * Vulkan Compute Dispatch Result structure.
+		 */
+		struct VulkanComputeDispatchResult {
+			double mGpuTime = 0.0;		// Milliseconds per iteration. 0 if the queue does not support timestamps.
+			double mBandwidth = 0.0;	// Gigabytes per second.
+			UI64 mBytes = 0;			// Bytes moved per iteration.
+		};
+
+		/**
+		 * Vulkan Render Target Compute object.
+		 * A compute playground: a compute pipeline built from a reflected compute shader and the buffers bound to it.
+		 * Buffers are created for the storage and uniform buffer bindings of the shader, filled from files or
+		 * generators, and read back after dispatching. Everything runs outside the frame loop and waits for the GPU,
+		 * so it is meant for prototyping kernels rather than per frame work.
+		 */
+		class VulkanRenderTargetCompute : public GRenderTarget {
+			/**
+			 * Buffer structure.
+			 */
+			struct Buffer {
+				VulkanAllocation mAllocation = {};
+				VkBuffer vBuffer = VK_NULL_HANDLE;
+				VkDeviceSize mSize = 0;
+				UI32 mSet = 0;
+				UI32 mBinding = 0;
+			};
+
+		public:
+			using GeneratorFunction = std::function<void(BYTE* pData, VkDeviceSize size)>;
+
+			VulkanRenderTargetCompute() : GRenderTarget(RenderTargetType::COMPUTE) {}
+			~VulkanRenderTargetCompute() {}
+
+			/**
+			 * Initialize the target.
+			 * The extent and offsets are unused; grid sizes are given with every dispatch.
+			 */
+			virtual void Initialize(GDevice* pDevice, UI32 width, UI32 height, float xOffset, float yOffset) override final;
+			virtual void Terminate(GDevice* pDevice) override final;
+
+			/**
+			 * Set the compute shader and build its pipeline.
+			 * Buffers already created for bindings of the previous shader are kept.
+			 *
+			 * @param shaderCode: The reflected SPIR-V compute shader.
+			 * @return Boolean value.
+			 */
+			bool SetShader(ShaderCode&& shaderCode);
+
+			/**
+			 * Create a buffer for a binding, replacing the existing one.
+			 *
+			 * @param set: The descriptor set of the binding.
+			 * @param binding: The binding.
+			 * @param size: The size of the buffer.
+			 * @param pData: The initial contents. nullptr leaves them undefined.
+			 * @return Boolean value.
+			 */
+			bool CreateBuffer(UI32 set, UI32 binding, VkDeviceSize size, const void* pData = nullptr);
+
+			/**
+			 * Create a buffer for a binding with the contents of a file.
+			 *
+			 * @param set: The descriptor set of the binding.
+			 * @param binding: The binding.
+			 * @param pFile: The file. Mapped, not copied.
+			 * @return Boolean value.
+			 */
+			bool LoadBuffer(UI32 set, UI32 binding, const char* pFile);
+
+			/**
+			 * Create a buffer for a binding with generated contents.
+			 *
+			 * @param set: The descriptor set of the binding.
+			 * @param binding: The binding.
+			 * @param size: The size of the buffer.
+			 * @param generator: The generator.
+			 * @return Boolean value.
+			 */
+			bool GenerateBuffer(UI32 set, UI32 binding, VkDeviceSize size, VulkanComputeGenerator generator);
+
+			/**
+			 * Create a buffer for a binding with contents written by a function.
+			 *
+			 * @param set: The descriptor set of the binding.
+			 * @param binding: The binding.
+			 * @param size: The size of the buffer.
+			 * @param function: The function writing the contents.
+			 * @return Boolean value.
+			 */
+			bool GenerateBuffer(UI32 set, UI32 binding, VkDeviceSize size, const GeneratorFunction& function);
+
+			/**
+			 * Dispatch the shader and wait for it to finish.
+			 * Every binding of the shader must have a buffer.
+			 *
+			 * @param dispatch: The dispatch.
+			 * @param pResult: The timing of the dispatch to be set. Optional.
+			 * @return Boolean value.
+			 */
+			bool Dispatch(const VulkanComputeDispatch& dispatch, VulkanComputeDispatchResult* pResult = nullptr);
+
+			/**
+			 * Read the contents of a buffer back to the host.
+			 *
+			 * @param set: The descriptor set of the binding.
+			 * @param binding: The binding.
+			 * @param pData: The contents to be set.
+			 * @return Boolean value.
+			 */
+			bool ReadBuffer(UI32 set, UI32 binding, std::vector<BYTE>* pData);
+
+			/**
+			 * Write the contents of a buffer to a file.
+			 *
+			 * @param set: The descriptor set of the binding.
+			 * @param binding: The binding.
+			 * @param pFile: The file.
+			 * @return Boolean value.
+			 */
+			bool SaveBuffer(UI32 set, UI32 binding, const char* pFile);
+
+			/**
+			 * Set the number of bytes a dispatch moves, for the bandwidth.
+			 * By default every bound buffer counts as read or written once per iteration.
+			 *
+			 * @param bytes: The bytes per iteration. 0 restores the default.
+			 */
+			void SetTrafficBytes(UI64 bytes) { mTrafficBytes = bytes; }
+
+			VkPipeline GetPipeline() const { return vPipeline; }
+			VkPipelineLayout GetPipelineLayout() const { return vPipelineLayout; }
+
+		private:
+			Buffer* FindBuffer(UI32 set, UI32 binding);
+			void DestroyBuffer(Buffer* pBuffer);
+			void DestroyPipeline();
+
+			bool CopyToBuffer(const Buffer& buffer, const void* pData, VkDeviceSize size);
+			bool UpdateDescriptorSets();
+
+		private:
+			std::vector<Buffer> mBuffers;
+			std::vector<VkDescriptorSetLayout> vSetLayouts;
+			std::vector<VkDescriptorSet> vDescriptorSets;	// Indexed by set. Null for fixed sets.
+			ShaderCode mShader = {};
+
+			VulkanDevice* pDevice = nullptr;
+			VkPipeline vPipeline = VK_NULL_HANDLE;
+			VkPipelineLayout vPipelineLayout = VK_NULL_HANDLE;
+			VkDescriptorPool vDescriptorPool = VK_NULL_HANDLE;
+			VkQueryPool vQueryPool = VK_NULL_HANDLE;
+
+			double mTimestampPeriod = 0.0;			// Nanoseconds per tick. 0 if timestamps are not supported.
+			UI64 mTrafficBytes = 0;
+			UI32 mPushConstantOffset = 0;
+			UI32 mPushConstantSize = 0;
+			bool mAreDescriptorsDirty = true;
+		};
+	}
+}
@@ -0,0 +1,125 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShaderModule.h"
+#include "Macros.h"
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		VkShaderModule CreateShaderModule(VkDevice vLogicalDevice, const ShaderCode& shaderCode)
+		{
+			if (shaderCode.GetType() != ShaderCodeType::SPIR_V || shaderCode.IsEmpty())
+			{
+				Logger::LogError(TEXT("Shader modules can only be created using SPIR-V code!"));
+				return VK_NULL_HANDLE;
+			}
+
+			VkShaderModuleCreateInfo vCI = {};
+			vCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			vCI.flags = VK_NULL_HANDLE;
+			vCI.pNext = VK_NULL_HANDLE;
+			vCI.codeSize = static_cast<size_t>(shaderCode.GetCodeSize());
+			vCI.pCode = shaderCode.GetCode();
+
+			VkShaderModule vShaderModule = VK_NULL_HANDLE;
+			VK_ASSERT(vkCreateShaderModule(vLogicalDevice, &vCI, nullptr, &vShaderModule), "Failed to create the Vulkan Shader Module!");
+
+			return vShaderModule;
+		}
+
+		void DestroyShaderModule(VkDevice vLogicalDevice, VkShaderModule vShaderModule)
+		{
+			vkDestroyShaderModule(vLogicalDevice, vShaderModule, nullptr);
+		}
+
+		VkShaderStageFlagBits GetShaderStageFlag(ShaderStage stage)
+		{
+			switch (stage)
+			{
+			case ShaderStage::VERTEX:
+				return VK_SHADER_STAGE_VERTEX_BIT;
+
+			case ShaderStage::TESSELLATION_CONTROL:
+				return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+
+			case ShaderStage::TESSELLATION_EVALUATION:
+				return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+
+			case ShaderStage::GEOMETRY:
+				return VK_SHADER_STAGE_GEOMETRY_BIT;
+
+			case ShaderStage::FRAGMENT:
+				return VK_SHADER_STAGE_FRAGMENT_BIT;
+
+			case ShaderStage::COMPUTE:
+				return VK_SHADER_STAGE_COMPUTE_BIT;
+
+			default:
+				Logger::LogError(TEXT("Invalid or undefined shader stage!"));
+				break;
+			}
+
+			return VK_SHADER_STAGE_ALL;
+		}
+
+		VkDescriptorType GetDescriptorType(ShaderResourceType type)
+		{
+			switch (type)
+			{
+			case ShaderResourceType::UNIFORM_BUFFER:
+				return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+			case ShaderResourceType::STORAGE_BUFFER:
+				return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+			case ShaderResourceType::UNIFORM_TEXEL_BUFFER:
+				return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+
+			case ShaderResourceType::STORAGE_TEXEL_BUFFER:
+				return VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+
+			case ShaderResourceType::COMBINED_IMAGE_SAMPLER:
+				return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+			case ShaderResourceType::SAMPLED_IMAGE:
+				return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+
+			case ShaderResourceType::STORAGE_IMAGE:
+				return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+			case ShaderResourceType::SAMPLER:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+			case ShaderResourceType::INPUT_ATTACHMENT:
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+
+			case ShaderResourceType::ACCELERATION_STRUCTURE:
+				return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+
+			default:
+				Logger::LogError(TEXT("Invalid or undefined shader resource type!"));
+				break;
+			}
+
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+
+		VkFormat GetVertexInputFormat(const ShaderVertexInput& input)
+		{
+			static const VkFormat vFormats[][4] = {
+				{ VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT },
+				{ VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT },
+				{ VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT },
+				{ VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+				{ VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT },
+			};
+
+			if (input.mType == ShaderAttributeType::UNDEFINED || input.mComponentCount < 1 || input.mComponentCount > 4)
+				return VK_FORMAT_UNDEFINED;
+
+			return vFormats[static_cast<UI8>(input.mType) - 1][input.mComponentCount - 1];
+		}
+	}
+}
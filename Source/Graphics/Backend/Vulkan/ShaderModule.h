@@ -0,0 +1,57 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Core/Objects/ShaderCode.h"
+
+#include <vulkan/vulkan.h>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		/**
+		 * Create a shader module.
+		 * The SPIR-V is read directly from the shader code object, which may be a mapped file.
+		 *
+		 * @param vLogicalDevice: The logical device.
+		 * @param shaderCode: The SPIR-V shader code.
+		 * @return The Vulkan shader module handle. VK_NULL_HANDLE if the code is not SPIR-V.
+		 */
+		VkShaderModule CreateShaderModule(VkDevice vLogicalDevice, const ShaderCode& shaderCode);
+
+		/**
+		 * Destroy a shader module.
+		 *
+		 * @param vLogicalDevice: The logical device.
+		 * @param vShaderModule: The shader module to be destroyed.
+		 */
+		void DestroyShaderModule(VkDevice vLogicalDevice, VkShaderModule vShaderModule);
+
+		/**
+		 * Get the Vulkan stage flag of a shader stage.
+		 *
+		 * @param stage: The shader stage.
+		 * @return The Vulkan shader stage flag.
+		 */
+		VkShaderStageFlagBits GetShaderStageFlag(ShaderStage stage);
+
+		/**
+		 * Get the Vulkan descriptor type of a reflected resource type.
+		 *
+		 * @param type: The resource type.
+		 * @return The Vulkan descriptor type.
+		 */
+		VkDescriptorType GetDescriptorType(ShaderResourceType type);
+
+		/**
+		 * Get the Vulkan format of a reflected vertex input.
+		 * Matrices use this format for each of their columns.
+		 *
+		 * @param input: The vertex input.
+		 * @return The Vulkan format. VK_FORMAT_UNDEFINED if the input can not be a vertex attribute.
+		 */
+		VkFormat GetVertexInputFormat(const ShaderVertexInput& input);
+	}
+}
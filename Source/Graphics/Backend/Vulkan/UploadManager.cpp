@@ -0,0 +1,365 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "UploadManager.h"
+#include "VulkanDevice.h"
+#include "Macros.h"
+
+#include <cstring>
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		void VulkanUploadManager::Initialize(VulkanDevice* pDevice, VkDeviceSize ringSize)
+		{
+			this->pDevice = pDevice;
+			this->mRingSize = ringSize;
+
+			mTransferFamily = pDevice->vQueue.mTransferFamily.value();
+			mGraphicsFamily = pDevice->vQueue.mGraphicsFamily.value();
+			vTransferQueue = pDevice->vQueue.vTransferQueue;
+
+			VkCommandPoolCreateInfo vPoolCI = {};
+			vPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			vPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			vPoolCI.pNext = VK_NULL_HANDLE;
+			vPoolCI.queueFamilyIndex = mTransferFamily;
+
+			VK_ASSERT(vkCreateCommandPool(pDevice->vLogicalDevice, &vPoolCI, nullptr, &vCommandPool), "Failed to create the upload command pool!");
+
+			VkBufferCreateInfo vBufferCI = {};
+			vBufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			vBufferCI.flags = VK_NULL_HANDLE;
+			vBufferCI.pNext = VK_NULL_HANDLE;
+			vBufferCI.size = ringSize;
+			vBufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			vBufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VK_ASSERT(vkCreateBuffer(pDevice->vLogicalDevice, &vBufferCI, nullptr, &vStagingBuffer), "Failed to create the staging buffer!");
+			pDevice->GetMemoryAllocator().AllocateBuffer(vStagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_NULL_HANDLE, &mStagingAllocation);
+		}
+
+		void VulkanUploadManager::Terminate()
+		{
+			WaitIdle();
+
+			VkDevice vLogicalDevice = pDevice->vLogicalDevice;
+			for (Batch& batch : mFreeBatches)
+				vkDestroyFence(vLogicalDevice, batch.vFence, nullptr);
+
+			// Destroying the pool frees the command buffers.
+			vkDestroyCommandPool(vLogicalDevice, vCommandPool, nullptr);
+
+			for (VkSemaphore vSemaphore : vSignaledSemaphores)
+				vkDestroySemaphore(vLogicalDevice, vSemaphore, nullptr);
+
+			for (VkSemaphore vSemaphore : vFreeSemaphores)
+				vkDestroySemaphore(vLogicalDevice, vSemaphore, nullptr);
+
+			vkDestroyBuffer(vLogicalDevice, vStagingBuffer, nullptr);
+			pDevice->GetMemoryAllocator().Free(&mStagingAllocation);
+
+			mFreeBatches.clear();
+			vSignaledSemaphores.clear();
+			vFreeSemaphores.clear();
+			vBufferAcquireBarriers.clear();
+			vImageAcquireBarriers.clear();
+			vCommandPool = VK_NULL_HANDLE;
+			vStagingBuffer = VK_NULL_HANDLE;
+		}
+
+		bool VulkanUploadManager::UploadBuffer(VkBuffer vBuffer, VkDeviceSize offset, const void* pData, VkDeviceSize size)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			const BYTE* pBytes = static_cast<const BYTE*>(pData);
+			VkDeviceSize chunkSize = mRingSize / 2;
+
+			for (VkDeviceSize copied = 0; copied < size; copied += chunkSize)
+			{
+				VkDeviceSize regionSize = std::min(chunkSize, size - copied);
+
+				VkDeviceSize stagingOffset = 0;
+				if (!Reserve(regionSize, &stagingOffset))
+					return false;
+
+				std::memcpy(mStagingAllocation.pMappedData + stagingOffset, pBytes + copied, static_cast<size_t>(regionSize));
+
+				VkBufferCopy vRegion = {};
+				vRegion.srcOffset = stagingOffset;
+				vRegion.dstOffset = offset + copied;
+				vRegion.size = regionSize;
+				vkCmdCopyBuffer(GetCommandBuffer(), vStagingBuffer, vBuffer, 1, &vRegion);
+			}
+
+			// Hand the buffer over to the graphics family.
+			if (mTransferFamily != mGraphicsFamily)
+			{
+				VkBufferMemoryBarrier vBarrier = {};
+				vBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				vBarrier.pNext = VK_NULL_HANDLE;
+				vBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				vBarrier.dstAccessMask = 0;
+				vBarrier.srcQueueFamilyIndex = mTransferFamily;
+				vBarrier.dstQueueFamilyIndex = mGraphicsFamily;
+				vBarrier.buffer = vBuffer;
+				vBarrier.offset = offset;
+				vBarrier.size = size;
+				vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &vBarrier, 0, nullptr);
+
+				vBarrier.srcAccessMask = 0;
+				vBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+				INSERT_INTO_VECTOR(vBufferAcquireBarriers, vBarrier);
+			}
+
+			return true;
+		}
+
+		bool VulkanUploadManager::UploadImage(VkImage vImage, const void* pData, VkDeviceSize size, VkExtent3D vExtent, VkImageSubresourceLayers vSubresource, VkImageLayout vFinalLayout)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			VkDeviceSize stagingOffset = 0;
+			if (!Reserve(size, &stagingOffset))
+			{
+				Logger::LogError(TEXT("The image does not fit in the staging ring buffer!"));
+				return false;
+			}
+
+			std::memcpy(mStagingAllocation.pMappedData + stagingOffset, pData, static_cast<size_t>(size));
+			VkCommandBuffer vCommandBuffer = GetCommandBuffer();
+
+			VkImageMemoryBarrier vBarrier = {};
+			vBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			vBarrier.pNext = VK_NULL_HANDLE;
+			vBarrier.srcAccessMask = 0;
+			vBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			vBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			vBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vBarrier.image = vImage;
+			vBarrier.subresourceRange.aspectMask = vSubresource.aspectMask;
+			vBarrier.subresourceRange.baseMipLevel = vSubresource.mipLevel;
+			vBarrier.subresourceRange.levelCount = 1;
+			vBarrier.subresourceRange.baseArrayLayer = vSubresource.baseArrayLayer;
+			vBarrier.subresourceRange.layerCount = vSubresource.layerCount;
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &vBarrier);
+
+			VkBufferImageCopy vRegion = {};
+			vRegion.bufferOffset = stagingOffset;
+			vRegion.imageSubresource = vSubresource;
+			vRegion.imageExtent = vExtent;
+			vkCmdCopyBufferToImage(vCommandBuffer, vStagingBuffer, vImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &vRegion);
+
+			// Transition to the final layout, releasing the image to the graphics family if needed. The semaphore the
+			// graphics queue waits on makes the writes visible.
+			vBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vBarrier.dstAccessMask = 0;
+			vBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			vBarrier.newLayout = vFinalLayout;
+
+			if (mTransferFamily != mGraphicsFamily)
+			{
+				vBarrier.srcQueueFamilyIndex = mTransferFamily;
+				vBarrier.dstQueueFamilyIndex = mGraphicsFamily;
+			}
+
+			vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &vBarrier);
+
+			if (mTransferFamily != mGraphicsFamily)
+			{
+				vBarrier.srcAccessMask = 0;
+				vBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+				INSERT_INTO_VECTOR(vImageAcquireBarriers, vBarrier);
+			}
+
+			return true;
+		}
+
+		void VulkanUploadManager::Flush()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			Submit();
+			Reclaim(false);
+		}
+
+		void VulkanUploadManager::WaitIdle()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			Submit();
+
+			while (!mSubmittedBatches.empty())
+				Reclaim(true);
+		}
+
+		void VulkanUploadManager::AcquireUploads(VkCommandBuffer vCommandBuffer, std::vector<VkSemaphore>* pWaitSemaphores)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			Submit();
+			Reclaim(false);
+
+			if (!vBufferAcquireBarriers.empty() || !vImageAcquireBarriers.empty())
+			{
+				vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+					static_cast<UI32>(vBufferAcquireBarriers.size()), vBufferAcquireBarriers.data(),
+					static_cast<UI32>(vImageAcquireBarriers.size()), vImageAcquireBarriers.data());
+
+				vBufferAcquireBarriers.clear();
+				vImageAcquireBarriers.clear();
+			}
+
+			pWaitSemaphores->insert(pWaitSemaphores->end(), vSignaledSemaphores.begin(), vSignaledSemaphores.end());
+			vSignaledSemaphores.clear();
+		}
+
+		void VulkanUploadManager::RecycleSemaphores(std::vector<VkSemaphore>& vSemaphores)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			INSERT_INTO_VECTOR(vFreeSemaphores, vSemaphores.begin(), vSemaphores.end());
+			vSemaphores.clear();
+		}
+
+		bool VulkanUploadManager::Reserve(VkDeviceSize size, VkDeviceSize* pOffset)
+		{
+			size = (size + VULKAN_UPLOAD_ALIGNMENT - 1) & ~static_cast<VkDeviceSize>(VULKAN_UPLOAD_ALIGNMENT - 1);
+			if (size > mRingSize / 2)
+				return false;
+
+			while (true)
+			{
+				// Regions never wrap; the tail end of the ring is skipped instead.
+				UI64 start = mRingHead;
+				UI64 position = start % mRingSize;
+				if (position + size > mRingSize)
+					start += mRingSize - position;
+
+				if (start + size - mRingTail <= mRingSize)
+				{
+					mRingHead = start + size;
+					*pOffset = start % mRingSize;
+					return true;
+				}
+
+				// The ring is full. The recording batch may be the one holding the space.
+				Submit();
+				Reclaim(true);
+			}
+		}
+
+		VkCommandBuffer VulkanUploadManager::GetCommandBuffer()
+		{
+			if (mRecordingBatch.vCommandBuffer != VK_NULL_HANDLE)
+				return mRecordingBatch.vCommandBuffer;
+
+			if (mFreeBatches.empty())
+				mRecordingBatch = CreateBatch();
+			else
+			{
+				mRecordingBatch = mFreeBatches.back();
+				mFreeBatches.pop_back();
+			}
+
+			VkCommandBufferBeginInfo vBeginInfo = {};
+			vBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			vBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vBeginInfo.pNext = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkBeginCommandBuffer(mRecordingBatch.vCommandBuffer, &vBeginInfo), "Failed to begin the upload command buffer!");
+			return mRecordingBatch.vCommandBuffer;
+		}
+
+		void VulkanUploadManager::Submit()
+		{
+			if (mRecordingBatch.vCommandBuffer == VK_NULL_HANDLE)
+				return;
+
+			VK_ASSERT(vkEndCommandBuffer(mRecordingBatch.vCommandBuffer), "Failed to end the upload command buffer!");
+
+			VkSemaphore vSemaphore = GetSemaphore();
+
+			VkSubmitInfo vSubmitInfo = {};
+			vSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			vSubmitInfo.pNext = VK_NULL_HANDLE;
+			vSubmitInfo.commandBufferCount = 1;
+			vSubmitInfo.pCommandBuffers = &mRecordingBatch.vCommandBuffer;
+			vSubmitInfo.signalSemaphoreCount = 1;
+			vSubmitInfo.pSignalSemaphores = &vSemaphore;
+
+			// The transfer queue may be the graphics queue, which the render thread submits to.
+			{
+				std::lock_guard<std::mutex> queueLock(pDevice->GetQueueMutex());
+				VK_ASSERT(vkQueueSubmit(vTransferQueue, 1, &vSubmitInfo, mRecordingBatch.vFence), "Failed to submit the uploads!");
+			}
+
+			INSERT_INTO_VECTOR(vSignaledSemaphores, vSemaphore);
+
+			mRecordingBatch.mRingEnd = mRingHead;
+			mSubmittedBatches.push_back(mRecordingBatch);
+			mRecordingBatch = Batch();
+		}
+
+		void VulkanUploadManager::Reclaim(bool waitForOldest)
+		{
+			VkDevice vLogicalDevice = pDevice->vLogicalDevice;
+
+			if (waitForOldest && !mSubmittedBatches.empty())
+				vkWaitForFences(vLogicalDevice, 1, &mSubmittedBatches.front().vFence, VK_TRUE, UINT64_MAX);
+
+			// Batches complete in submission order on a single queue.
+			while (!mSubmittedBatches.empty() && vkGetFenceStatus(vLogicalDevice, mSubmittedBatches.front().vFence) == VK_SUCCESS)
+			{
+				Batch batch = mSubmittedBatches.front();
+				mSubmittedBatches.pop_front();
+
+				mRingTail = batch.mRingEnd;
+
+				vkResetFences(vLogicalDevice, 1, &batch.vFence);
+				vkResetCommandBuffer(batch.vCommandBuffer, VK_NULL_HANDLE);
+				INSERT_INTO_VECTOR(mFreeBatches, batch);
+			}
+		}
+
+		VulkanUploadManager::Batch VulkanUploadManager::CreateBatch()
+		{
+			Batch batch = {};
+
+			VkCommandBufferAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			vAI.pNext = VK_NULL_HANDLE;
+			vAI.commandPool = vCommandPool;
+			vAI.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			vAI.commandBufferCount = 1;
+
+			VK_ASSERT(vkAllocateCommandBuffers(pDevice->vLogicalDevice, &vAI, &batch.vCommandBuffer), "Failed to allocate the upload command buffer!");
+
+			VkFenceCreateInfo vFenceCI = {};
+			vFenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			vFenceCI.flags = VK_NULL_HANDLE;
+			vFenceCI.pNext = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkCreateFence(pDevice->vLogicalDevice, &vFenceCI, nullptr, &batch.vFence), "Failed to create the upload fence!");
+			return batch;
+		}
+
+		VkSemaphore VulkanUploadManager::GetSemaphore()
+		{
+			if (!vFreeSemaphores.empty())
+			{
+				VkSemaphore vSemaphore = vFreeSemaphores.back();
+				vFreeSemaphores.pop_back();
+				return vSemaphore;
+			}
+
+			VkSemaphoreCreateInfo vSemaphoreCI = {};
+			vSemaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			vSemaphoreCI.flags = VK_NULL_HANDLE;
+			vSemaphoreCI.pNext = VK_NULL_HANDLE;
+
+			VkSemaphore vSemaphore = VK_NULL_HANDLE;
+			VK_ASSERT(vkCreateSemaphore(pDevice->vLogicalDevice, &vSemaphoreCI, nullptr, &vSemaphore), "Failed to create the upload semaphore!");
+			return vSemaphore;
+		}
+	}
+}
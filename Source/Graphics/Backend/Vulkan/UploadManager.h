@@ -0,0 +1,154 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "MemoryAllocator.h"
+
+#include <deque>
+
+/**
+ * The size of the staging ring buffer.
+ */
+#define VULKAN_UPLOAD_RING_SIZE			(64ULL * 1024 * 1024)
+
+/**
+ * The alignment of every staging region. Covers buffer copies and the texel sizes of every uncompressed format.
+ */
+#define VULKAN_UPLOAD_ALIGNMENT			16
+
+namespace Graphics
+{
+	namespace VulkanBackend
+	{
+		class VulkanDevice;
+
+		/**
+		 * Vulkan Upload Manager object.
+		 * Copies data into device local buffers and images on the transfer queue through a persistently mapped staging
+		 * ring buffer. Copies are recorded into a batch which is submitted as a single transfer submission when the frame
+		 * begins, or earlier when the ring runs out of space. The graphics queue waits on the batch semaphores and takes
+		 * ownership of the resources when the transfer queue belongs to another family.
+		 * Uploads can be enqueued from any thread.
+		 */
+		class VulkanUploadManager {
+			/**
+			 * Upload batch structure.
+			 */
+			struct Batch {
+				VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE;
+				VkFence vFence = VK_NULL_HANDLE;
+				UI64 mRingEnd = 0;							// The ring position after the last staging region of the batch.
+			};
+
+		public:
+			VulkanUploadManager() {}
+			~VulkanUploadManager() {}
+
+			/**
+			 * Initialize the upload manager.
+			 *
+			 * @param pDevice: The device.
+			 * @param ringSize: The size of the staging ring buffer.
+			 */
+			void Initialize(VulkanDevice* pDevice, VkDeviceSize ringSize = VULKAN_UPLOAD_RING_SIZE);
+
+			/**
+			 * Terminate the upload manager.
+			 * Waits for the submitted batches. The device must be idle.
+			 */
+			void Terminate();
+
+			/**
+			 * Upload data to a buffer.
+			 * Uploads larger than half the ring are split.
+			 *
+			 * @param vBuffer: The destination buffer. Must have been created with transfer destination usage.
+			 * @param offset: The destination offset.
+			 * @param pData: The data to copy.
+			 * @param size: The size of the data.
+			 * @return Boolean value.
+			 */
+			bool UploadBuffer(VkBuffer vBuffer, VkDeviceSize offset, const void* pData, VkDeviceSize size);
+
+			/**
+			 * Upload data to an image subresource.
+			 * The previous contents of the image are discarded.
+			 *
+			 * @param vImage: The destination image. Must have been created with transfer destination usage.
+			 * @param pData: The tightly packed texel data.
+			 * @param size: The size of the data. Must fit in half the ring.
+			 * @param vExtent: The extent of the subresource.
+			 * @param vSubresource: The subresource to copy to.
+			 * @param vFinalLayout: The layout the image is used in afterwards.
+			 * @return Boolean value.
+			 */
+			bool UploadImage(VkImage vImage, const void* pData, VkDeviceSize size, VkExtent3D vExtent, VkImageSubresourceLayers vSubresource, VkImageLayout vFinalLayout);
+
+			/**
+			 * Submit the recorded copies.
+			 */
+			void Flush();
+
+			/**
+			 * Submit the recorded copies and wait for every batch to complete.
+			 */
+			void WaitIdle();
+
+			/**
+			 * Make the submitted uploads available to a graphics command buffer.
+			 * Records the ownership acquire barriers and hands over the semaphores the submission must wait on.
+			 *
+			 * @param vCommandBuffer: The graphics command buffer being recorded.
+			 * @param pWaitSemaphores: The semaphores to wait on. They must be returned with RecycleSemaphores once the
+			 * submission completed.
+			 */
+			void AcquireUploads(VkCommandBuffer vCommandBuffer, std::vector<VkSemaphore>* pWaitSemaphores);
+
+			/**
+			 * Return semaphores handed out by AcquireUploads.
+			 *
+			 * @param vSemaphores: The semaphores. Cleared afterwards.
+			 */
+			void RecycleSemaphores(std::vector<VkSemaphore>& vSemaphores);
+
+			bool HasPendingUploads() const { return mRecordingBatch.vCommandBuffer != VK_NULL_HANDLE; }
+
+		private:
+			bool Reserve(VkDeviceSize size, VkDeviceSize* pOffset);
+			VkCommandBuffer GetCommandBuffer();
+
+			void Submit();
+			void Reclaim(bool waitForOldest);
+
+			Batch CreateBatch();
+			VkSemaphore GetSemaphore();
+
+		private:
+			Batch mRecordingBatch = {};
+			std::deque<Batch> mSubmittedBatches;
+			std::vector<Batch> mFreeBatches;
+
+			std::vector<VkBufferMemoryBarrier> vBufferAcquireBarriers;
+			std::vector<VkImageMemoryBarrier> vImageAcquireBarriers;
+
+			std::vector<VkSemaphore> vSignaledSemaphores;
+			std::vector<VkSemaphore> vFreeSemaphores;
+
+			std::mutex mMutex;
+
+			VulkanAllocation mStagingAllocation = {};
+			VkBuffer vStagingBuffer = VK_NULL_HANDLE;
+			UI64 mRingHead = 0;								// Monotonic write position.
+			UI64 mRingTail = 0;								// Monotonic position of the oldest region in use.
+			VkDeviceSize mRingSize = 0;
+
+			VkCommandPool vCommandPool = VK_NULL_HANDLE;
+			VkQueue vTransferQueue = VK_NULL_HANDLE;
+			UI32 mTransferFamily = 0;
+			UI32 mGraphicsFamily = 0;
+
+			VulkanDevice* pDevice = nullptr;
+		};
+	}
+}
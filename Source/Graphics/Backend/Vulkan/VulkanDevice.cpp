@@ -7,12 +7,19 @@
 #include "Macros.h"
 
 #include "RenderTarget/VulkanRenderTarget.h"
+#include "RenderTarget/VulkanRenderTargetCompute.h"
 
 #include "Core/Types/Utilities.h"
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
 #include <set>
 
+#define VULKAN_PIPELINE_CACHE_FILE	"Cache/PipelineCache.bin"
+
 namespace Graphics
 {
 	namespace VulkanBackend
@@ -42,6 +49,40 @@ namespace Graphics
 				return requiredExtensions.empty();
 			}
 
+			/**
+			 * Check if the physical device supports the descriptor indexing features bindless rendering needs.
+			 *
+			 * @param vPhysicalDevice: The physical device.
+			 * @param vApiVersion: The API version of the physical device.
+			 * @return Boolean value.
+			 */
+			bool CheckDescriptorIndexingSupport(VkPhysicalDevice vPhysicalDevice, UI32 vApiVersion)
+			{
+				// Core in 1.2, an extension before that.
+				if (vApiVersion < VK_API_VERSION_1_1)
+					return false;
+
+				if (vApiVersion < VK_API_VERSION_1_2 && !CheckDeviceExtensionSupport(vPhysicalDevice, { VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME }))
+					return false;
+
+				VkPhysicalDeviceDescriptorIndexingFeatures vIndexingFeatures = {};
+				vIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+				VkPhysicalDeviceFeatures2 vFeatures = {};
+				vFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+				vFeatures.pNext = &vIndexingFeatures;
+				vkGetPhysicalDeviceFeatures2(vPhysicalDevice, &vFeatures);
+
+				return vIndexingFeatures.runtimeDescriptorArray
+					&& vIndexingFeatures.descriptorBindingPartiallyBound
+					&& vIndexingFeatures.descriptorBindingUpdateUnusedWhilePending
+					&& vIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+					&& vIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind
+					&& vIndexingFeatures.descriptorBindingStorageImageUpdateAfterBind
+					&& vIndexingFeatures.shaderSampledImageArrayNonUniformIndexing
+					&& vIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
+			}
+
 			/**
 			 * Check if a physical device is suitable to use.
 			 *
@@ -52,11 +93,11 @@ namespace Graphics
 			 */
 			bool IsPhysicalDeviceSuitable(VkPhysicalDevice vDevice, VkSurfaceKHR vSurface, const std::vector<const char*>& deviceExtensions)
 			{
-				VulkanQueue _queue = CreateQueue(vDevice);
+				VulkanQueue _queue = CreateQueue(vDevice, vSurface);
 
 				bool extensionsSupported = CheckDeviceExtensionSupport(vDevice, deviceExtensions);
-				bool swapChainAdequate = false;
-				if (extensionsSupported)
+				bool swapChainAdequate = vSurface == VK_NULL_HANDLE;	// Headless devices never present.
+				if (extensionsSupported && !swapChainAdequate)
 				{
 					SwapChainSupportDetails swapChainSupport = QuerySwapChainSupportDetails(vDevice, vSurface);
 					swapChainAdequate = (!swapChainSupport.formats.empty()) && (!swapChainSupport.presentModes.empty());
@@ -70,6 +111,94 @@ namespace Graphics
 					&& swapChainAdequate
 					&& supportedFeatures.samplerAnisotropy;
 			}
+			/**
+			 * Score a physical device.
+			 * The device type dominates, then the size of the largest device local heap, the limits and whether the
+			 * device has queue families for async compute and dedicated transfers.
+			 *
+			 * @param vDevice: The physical device.
+			 * @param vSurface: The surface the device will be using.
+			 * @return The score. Higher is better.
+			 */
+			UI64 ScorePhysicalDevice(VkPhysicalDevice vDevice, VkSurfaceKHR vSurface)
+			{
+				VkPhysicalDeviceProperties vProperties = {};
+				vkGetPhysicalDeviceProperties(vDevice, &vProperties);
+
+				VkPhysicalDeviceMemoryProperties vMemoryProperties = {};
+				vkGetPhysicalDeviceMemoryProperties(vDevice, &vMemoryProperties);
+
+				UI64 score = 0;
+				switch (vProperties.deviceType)
+				{
+				case VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+					score += 100000;
+					break;
+				case VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+					score += 50000;
+					break;
+				case VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+					score += 20000;
+					break;
+				case VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_CPU:
+					score += 1000;
+					break;
+				default:
+					break;
+				}
+
+				// One point per 16 MB of the largest device local heap.
+				VkDeviceSize largestHeap = 0;
+				for (UI32 i = 0; i < vMemoryProperties.memoryHeapCount; i++)
+					if (vMemoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+						largestHeap = std::max(largestHeap, vMemoryProperties.memoryHeaps[i].size);
+
+				score += largestHeap >> 24;
+
+				score += vProperties.limits.maxImageDimension2D >> 8;
+				score += vProperties.limits.maxComputeSharedMemorySize >> 10;
+				score += vProperties.limits.maxPerStageDescriptorSampledImages >> 10;
+				score += vProperties.limits.maxBoundDescriptorSets;
+
+				VulkanQueue queue = CreateQueue(vDevice, vSurface);
+				if (queue.HasAsyncCompute())
+					score += 500;
+
+				if (queue.HasDedicatedTransfer())
+					score += 500;
+
+				return score;
+			}
+
+			/**
+			 * Check if a physical device matches a device override.
+			 * The override is either the index of the device in enumeration order or a case insensitive part of its name.
+			 *
+			 * @param vDevice: The physical device.
+			 * @param index: The enumeration index of the device.
+			 * @param override: The override.
+			 * @return Boolean value.
+			 */
+			bool MatchesDeviceOverride(VkPhysicalDevice vDevice, UI32 index, const String& override)
+			{
+				// Digits too long for an index fall through and are matched against the name.
+				UI32 overrideIndex = 0;
+				const char* pEnd = override.data() + override.size();
+				const auto result = std::from_chars(override.data(), pEnd, overrideIndex);
+				if (!override.empty() && result.ec == std::errc() && result.ptr == pEnd)
+					return overrideIndex == index;
+
+				VkPhysicalDeviceProperties vProperties = {};
+				vkGetPhysicalDeviceProperties(vDevice, &vProperties);
+
+				auto toLower = [](String string)
+				{
+					std::transform(string.begin(), string.end(), string.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+					return string;
+				};
+
+				return toLower(vProperties.deviceName).find(toLower(override)) != String::npos;
+			}
 		}
 
 		void VulkanDevice::CreateWindow(UI32 width, UI32 height, const char* pTitle)
@@ -92,37 +221,106 @@ namespace Graphics
 			if (enableValidation)
 				INSERT_INTO_VECTOR(mValidationLayers, "VK_LAYER_KHRONOS_validation");
 
+			// Without a window there is nothing to present to.
+			bool isHeadless = pWindow == nullptr;
+
 			// Create the instance.
-			vInstance = CreateInstance(enableValidation, mValidationLayers);
+			vInstance = CreateInstance(enableValidation, mValidationLayers, !isHeadless);
 
 			// Create the debug messenger.
 			if (enableValidation)
 				vDebugMessenger = CreateDebugMessenger(vInstance);
 
-			// Create the surface.
-			CreateSurface();
-
 			std::vector<const char*> deviceExtensions;
-			INSERT_INTO_VECTOR(deviceExtensions, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+			if (!isHeadless)
+			{
+				// Create the surface.
+				CreateSurface();
+				INSERT_INTO_VECTOR(deviceExtensions, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+			}
 
 			// Create physical device.
 			CreatePhysicalDevice(deviceExtensions);
 
-			// Get swap chain support details.
-			vSwapChainSupportDetails = QuerySwapChainSupportDetails(vPhysicalDevice, vSurface);
+			if (!isHeadless)
+			{
+				// Get swap chain support details.
+				vSwapChainSupportDetails = QuerySwapChainSupportDetails(vPhysicalDevice, vSurface);
+				QuerySurfaceCapabilities();
+			}
 
-			QuerySurfaceCapabilities();
 			GetMaxSupportedSampleCount();
 
 			// Create queue.
-			vQueue = CreateQueue(vPhysicalDevice);
+			vQueue = CreateQueue(vPhysicalDevice, vSurface);
 
 			// Create logical device.
 			CreateLogicalDevice(deviceExtensions);
+			GetQueues(vLogicalDevice, &vQueue);
+
+			mMemoryAllocator.Initialize(vLogicalDevice, vPhysicalDevice);
+			mUploadManager.Initialize(this);
+
+			CreateFrames(VULKAN_DEFAULT_FRAMES_IN_FLIGHT);
+			mCommandRecorder.Initialize(vLogicalDevice, vQueue.mGraphicsFamily.value(), GetFramesInFlight());
+			mDescriptorAllocator.Initialize(vLogicalDevice, GetFramesInFlight());
+			mGpuProfiler.Initialize(vLogicalDevice, vPhysicalDevice, vQueue.mGraphicsFamily.value(), GetFramesInFlight());
+
+			VkCommandPoolCreateInfo vPoolCI = {};
+			vPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			vPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			vPoolCI.pNext = VK_NULL_HANDLE;
+			vPoolCI.queueFamilyIndex = vQueue.mGraphicsFamily.value();
+
+			VK_ASSERT(vkCreateCommandPool(vLogicalDevice, &vPoolCI, nullptr, &vOneTimeCommandPool), "Failed to create the one time command pool!");
+
+			mPipelineLayoutCache.Initialize(vLogicalDevice);
+			if (mIsBindlessEnabled)
+			{
+				VkPhysicalDeviceDescriptorIndexingProperties vIndexingProperties = {};
+				vIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+				VkPhysicalDeviceProperties2 vProperties = {};
+				vProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+				vProperties.pNext = &vIndexingProperties;
+				vkGetPhysicalDeviceProperties2(vPhysicalDevice, &vProperties);
+
+				mBindlessTable.Initialize(vLogicalDevice, vIndexingProperties, GetFramesInFlight());
+				mPipelineLayoutCache.SetFixedSetLayout(VULKAN_BINDLESS_SET, mBindlessTable.GetSetLayout(), mBindlessTable.GetSetLayoutBindings());
+			}
+
+			mPipelineCache.Initialize(vLogicalDevice, vPhysicalDeviceProperties, VULKAN_PIPELINE_CACHE_FILE);
+			mPipelineCompiler.Initialize(vLogicalDevice, mPipelineCache.GetHandle(), &mPipelineLayoutCache, GetFramesInFlight());
+			mDefaultPass.Initialize(this);
 		}
 
 		void VulkanDevice::Terminate()
 		{
+			WaitIdle();
+
+			mDefaultPass.Terminate();
+			mCommandRecorder.Terminate();
+			mDescriptorAllocator.Terminate();
+			mGpuProfiler.Terminate();
+			mPipelineCompiler.Terminate();
+			mPipelineCache.Terminate();
+			mPipelineLayoutCache.Terminate();
+
+			if (mIsBindlessEnabled)
+				mBindlessTable.Terminate();
+
+			DestroyFrames();
+			vkDestroyCommandPool(vLogicalDevice, vOneTimeCommandPool, nullptr);
+
+			mUploadManager.Terminate();
+
+#ifdef SS_DEBUG
+			printf("%s", mMemoryAllocator.DumpStatistics().c_str());
+
+#endif	// SS_DEBUG
+
+			mMemoryAllocator.Terminate();
+
 			// Destroy logical device.
 			vkDestroyDevice(vLogicalDevice, nullptr);
 
@@ -130,28 +328,201 @@ namespace Graphics
 			if (vDebugMessenger)
 				DestroyDebugMessenger(vInstance, vDebugMessenger);
 
-			DestroySurface();
+			if (vSurface)
+				DestroySurface();
 
 			DestroyInstance(vInstance);
 
 			if (pWindow)
+			{
 				DestroyWindow();
 
-			// Destroy GLFW context.
-			TerminateGLFW();
+				// Destroy GLFW context.
+				TerminateGLFW();
+			}
 		}
 
 		void VulkanDevice::BeginDraw()
 		{
-			pWindow->PollInputs();
+			mIsFrameActive = false;
+			mHasSwapChainImage = false;
+
+			// Wait till the GPU is done with the last submission of this frame's resources.
+			VulkanFrame& frame = mFrames[mFrameIndex];
+			vkWaitForFences(vLogicalDevice, 1, &frame.vInFlightFence, VK_TRUE, UINT64_MAX);
+			mUploadManager.RecycleSemaphores(frame.vUploadSemaphores);
+
+			// Keep nothing queued behind the GPU, so the frame shows the inputs sampled below as soon as possible.
+			if (mFramePacer.WaitsForPreviousFrame())
+			{
+				const UI32 previousFrame = (mFrameIndex + GetFramesInFlight() - 1) % GetFramesInFlight();
+				vkWaitForFences(vLogicalDevice, 1, &mFrames[previousFrame].vInFlightFence, VK_TRUE, UINT64_MAX);
+			}
+
+			mFramePacer.Pace();
+
+			// The inputs are sampled after every wait, as close to recording and submission as possible.
+			if (pWindow)
+			{
+				pWindow->PollInputs();
+
+				// Any number of resize events between two frames results in a single recreation.
+				if (pWindow->GetInputCenter()->IsWindowResized)
+				{
+					pWindow->GetInputCenter()->IsWindowResized = false;
+					mIsSwapChainDirty = true;
+				}
+			}
+
+			// Frame boundary: pipelines which finished compiling are drawn with from this frame on.
+			mPipelineCompiler.SwapPipelines();
+
+			// A minimized window has nothing to present to.
+			bool isMinimized = false;
+			if (pScreenTarget && mIsSwapChainDirty)
+				isMinimized = !RecreateSwapChain();
+
+			if (pScreenTarget && !isMinimized && pScreenTarget->GetSwapChain().GetHandle() != VK_NULL_HANDLE)
+			{
+				VkResult vResult = vkAcquireNextImageKHR(vLogicalDevice, pScreenTarget->GetSwapChain().GetHandle(), UINT64_MAX, frame.vImageAvailable, VK_NULL_HANDLE, &mImageIndex);
+				if (vResult == VK_SUCCESS || vResult == VK_SUBOPTIMAL_KHR)
+				{
+					// With more images than frames, an image may come back while an older frame still renders to it.
+					if (vImageFences[mImageIndex] != VK_NULL_HANDLE && vImageFences[mImageIndex] != frame.vInFlightFence)
+						vkWaitForFences(vLogicalDevice, 1, &vImageFences[mImageIndex], VK_TRUE, UINT64_MAX);
+
+					vImageFences[mImageIndex] = frame.vInFlightFence;
+					mHasSwapChainImage = true;
+
+					// A suboptimal image is still rendered and presented, the swap chain is recreated next frame.
+					if (vResult == VK_SUBOPTIMAL_KHR)
+						mIsSwapChainDirty = true;
+				}
+				else if (vResult == VK_ERROR_OUT_OF_DATE_KHR)
+					mIsSwapChainDirty = true;
+				else
+					Logger::LogError(TEXT("Failed to acquire the next swap chain image!"));
+			}
+
+			// Off screen targets render even when no swap chain image is available.
+			if (!mHasSwapChainImage && pOffScreenTargets.empty())
+			{
+				// Nothing can be rendered till the window is restored, so there is no point in spinning.
+				if (isMinimized)
+					static_cast<VulkanWindow*>(pWindow)->WaitForEvents();
+
+				return;
+			}
+
+			// The fence is only reset once a submission is guaranteed, so a skipped frame never deadlocks the next wait.
+			vkResetFences(vLogicalDevice, 1, &frame.vInFlightFence);
+			vkResetCommandPool(vLogicalDevice, frame.vCommandPool, VK_NULL_HANDLE);
+			mCommandRecorder.BeginFrame(mFrameIndex);
+			mDescriptorAllocator.BeginFrame(mFrameIndex);
+
+			if (mIsBindlessEnabled)
+				mBindlessTable.BeginFrame();
+
+			VkCommandBufferBeginInfo vBeginInfo = {};
+			vBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			vBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vBeginInfo.pNext = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkBeginCommandBuffer(frame.vCommandBuffer, &vBeginInfo), "Failed to begin the frame command buffer!");
+			mIsFrameActive = true;
+
+			// Bound once for the whole frame. The bindless set is the first set of every derived pipeline layout, so
+			// binding pipelines never disturbs it.
+			if (mIsBindlessEnabled)
+			{
+				mBindlessTable.Bind(frame.vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+				mBindlessTable.Bind(frame.vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+			}
+
+			// Resolves the timings of the frame's previous submission, which its fence guarantees are available.
+			mGpuProfiler.BeginFrame(mFrameIndex, frame.vCommandBuffer);
+
+			// Refreshing the title every frame would make it unreadable.
+			if (mShowProfilerOverlay && pWindow && mGpuProfiler.GetFrameNumber() % 30 == 0)
+				static_cast<VulkanWindow*>(pWindow)->SetTitleSuffix(mGpuProfiler.GetSummary());
+
+			// Uploads enqueued since the last frame are submitted to the transfer queue and waited on by this frame.
+			mUploadManager.AcquireUploads(frame.vCommandBuffer, &frame.vUploadSemaphores);
 		}
 
 		void VulkanDevice::Update()
 		{
+			if (!mIsFrameActive)
+				return;
+
+			VkCommandBuffer vCommandBuffer = mFrames[mFrameIndex].vCommandBuffer;
+
+			VulkanProfilerScope scope(&mGpuProfiler, vCommandBuffer, "Default Pass");
+			mDefaultPass.Record(vCommandBuffer, &mGpuProfiler);
 		}
 
 		void VulkanDevice::EndDraw()
 		{
+			if (!mIsFrameActive)
+				return;
+
+			VulkanFrame& frame = mFrames[mFrameIndex];
+			VK_ASSERT(vkEndCommandBuffer(frame.vCommandBuffer), "Failed to end the frame command buffer!");
+
+			std::vector<VkSemaphore> vWaitSemaphores = frame.vUploadSemaphores;
+			std::vector<VkPipelineStageFlags> vWaitStages(vWaitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+			if (mHasSwapChainImage)
+			{
+				INSERT_INTO_VECTOR(vWaitSemaphores, frame.vImageAvailable);
+				INSERT_INTO_VECTOR(vWaitStages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+			}
+
+			VkSubmitInfo vSubmitInfo = {};
+			vSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			vSubmitInfo.pNext = VK_NULL_HANDLE;
+			vSubmitInfo.waitSemaphoreCount = static_cast<UI32>(vWaitSemaphores.size());
+			vSubmitInfo.pWaitSemaphores = vWaitSemaphores.data();
+			vSubmitInfo.pWaitDstStageMask = vWaitStages.data();
+			vSubmitInfo.commandBufferCount = 1;
+			vSubmitInfo.pCommandBuffers = &frame.vCommandBuffer;
+			vSubmitInfo.signalSemaphoreCount = mHasSwapChainImage ? 1 : 0;
+			vSubmitInfo.pSignalSemaphores = &frame.vRenderFinished;
+
+			{
+				std::lock_guard<std::mutex> lock(mQueueMutex);
+				VK_ASSERT(vkQueueSubmit(vQueue.vGraphicsQueue, 1, &vSubmitInfo, frame.vInFlightFence), "Failed to submit the frame!");
+			}
+
+			mPipelineCompiler.EndFrame();
+
+			mIsFrameActive = false;
+			mFrameIndex = (mFrameIndex + 1) % GetFramesInFlight();
+
+			if (!mHasSwapChainImage)
+				return;
+
+			VkSwapchainKHR vSwapChain = pScreenTarget->GetSwapChain().GetHandle();
+
+			VkPresentInfoKHR vPresentInfo = {};
+			vPresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+			vPresentInfo.pNext = VK_NULL_HANDLE;
+			vPresentInfo.waitSemaphoreCount = 1;
+			vPresentInfo.pWaitSemaphores = &frame.vRenderFinished;
+			vPresentInfo.swapchainCount = 1;
+			vPresentInfo.pSwapchains = &vSwapChain;
+			vPresentInfo.pImageIndices = &mImageIndex;
+
+			VkResult vResult = VK_SUCCESS;
+			{
+				std::lock_guard<std::mutex> lock(mQueueMutex);
+				vResult = vkQueuePresentKHR(vQueue.vGraphicsQueue, &vPresentInfo);
+			}
+
+			if (vResult == VK_ERROR_OUT_OF_DATE_KHR || vResult == VK_SUBOPTIMAL_KHR)
+				mIsSwapChainDirty = true;
+			else if (vResult != VK_SUCCESS)
+				Logger::LogError(TEXT("Failed to present the swap chain image!"));
 		}
 
 		GRenderTarget* VulkanDevice::CreateRenderTarget(RenderTargetType type, UI32 width, UI32 height, float xOffset, float yOffset)
@@ -165,12 +536,29 @@ namespace Graphics
 				VulkanRenderTargetSB3D* pRT = new VulkanRenderTargetSB3D();
 				pRT->Initialize(this, width, height, xOffset, yOffset);
 
+				pScreenTarget = pRT;
+				vImageFences.assign(pRT->GetSwapChain().GetImages().size(), VK_NULL_HANDLE);
+				mDefaultPass.Invalidate();
+
 				return pRT;
 			}
 			case Graphics::RenderTargetType::OFF_SCREEN_2D:
-				break;
 			case Graphics::RenderTargetType::OFF_SCREEN_3D:
-				break;
+			{
+				VulkanRenderTargetOS* pRT = new VulkanRenderTargetOS(type);
+				pRT->Initialize(this, width, height, xOffset, yOffset);
+
+				INSERT_INTO_VECTOR(pOffScreenTargets, pRT);
+				mDefaultPass.Invalidate();
+				return pRT;
+			}
+			case Graphics::RenderTargetType::COMPUTE:
+			{
+				VulkanRenderTargetCompute* pRT = new VulkanRenderTargetCompute();
+				pRT->Initialize(this, width, height, xOffset, yOffset);
+
+				return pRT;
+			}
 			default:
 				break;
 			}
@@ -180,12 +568,67 @@ namespace Graphics
 
 		void VulkanDevice::DestroyRenderTarget(GRenderTarget* pRenderTarget)
 		{
+			// The frames in flight may still render to it.
+			WaitIdle();
+
+			mDefaultPass.ReleaseFramebuffers();
+			mDefaultPass.Invalidate();
+
+			if (pRenderTarget == pScreenTarget)
+			{
+				pScreenTarget = nullptr;
+				vImageFences.clear();
+			}
+
+			pOffScreenTargets.erase(std::remove(pOffScreenTargets.begin(), pOffScreenTargets.end(), pRenderTarget), pOffScreenTargets.end());
+
 			pRenderTarget->Terminate(this);
 			delete pRenderTarget;
 		}
 
+		void VulkanDevice::SetDisplayShader(ShaderCode&& shaderCode)
+		{
+			mDefaultPass.SetShader(std::move(shaderCode));
+		}
+
+		void VulkanDevice::SetProfilerOverlay(bool isEnabled)
+		{
+			mShowProfilerOverlay = isEnabled;
+
+			if (!isEnabled && pWindow)
+				static_cast<VulkanWindow*>(pWindow)->SetTitleSuffix("");
+		}
+
+		void VulkanDevice::SetPresentPolicy(VulkanPresentPolicy policy)
+		{
+			if (policy == mFramePacer.GetPolicy())
+				return;
+
+			mFramePacer.SetPolicy(policy);
+			if (pScreenTarget)
+				mIsSwapChainDirty = true;
+		}
+
+		void VulkanDevice::SetFramesInFlight(UI32 frameCount)
+		{
+			WaitIdle();
+
+			DestroyFrames();
+			CreateFrames(frameCount);
+			mCommandRecorder.SetFrameCount(GetFramesInFlight());
+			mDescriptorAllocator.SetFrameCount(GetFramesInFlight());
+			mBindlessTable.SetFrameCount(GetFramesInFlight());
+			mGpuProfiler.SetFrameCount(GetFramesInFlight());
+
+			vImageFences.assign(vImageFences.size(), VK_NULL_HANDLE);
+			mPipelineCompiler.SetRetireFrameCount(GetFramesInFlight());
+		}
+
 		UI32 VulkanDevice::GetMaxFrameBufferCount() const
 		{
+			if (IsHeadless())
+				return VULKAN_HEADLESS_FRAME_BUFFER_COUNT;
+
 			UI32 bufferCount = vSwapChainSupportDetails.capabilities.minImageCount + 1;
 			if (vSwapChainSupportDetails.capabilities.maxImageCount > 0
 				&& bufferCount > vSwapChainSupportDetails.capabilities.maxImageCount)
@@ -194,6 +637,62 @@ namespace Graphics
 			return bufferCount;
 		}
 
+		UI32 VulkanDevice::FindMemoryType(UI32 typeFilter, VkMemoryPropertyFlags vProperties) const
+		{
+			for (UI32 i = 0; i < vMemoryProperties.memoryTypeCount; i++)
+				if ((typeFilter & (1 << i)) && (vMemoryProperties.memoryTypes[i].propertyFlags & vProperties) == vProperties)
+					return i;
+
+			Logger::LogError(TEXT("Failed to find a suitable memory type!"));
+			return UINT32_MAX;
+		}
+
+		VkCommandBuffer VulkanDevice::BeginOneTimeCommands()
+		{
+			VkCommandBufferAllocateInfo vAI = {};
+			vAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			vAI.pNext = VK_NULL_HANDLE;
+			vAI.commandPool = vOneTimeCommandPool;
+			vAI.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			vAI.commandBufferCount = 1;
+
+			VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE;
+			VK_ASSERT(vkAllocateCommandBuffers(vLogicalDevice, &vAI, &vCommandBuffer), "Failed to allocate the one time command buffer!");
+
+			VkCommandBufferBeginInfo vBeginInfo = {};
+			vBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			vBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vBeginInfo.pNext = VK_NULL_HANDLE;
+
+			VK_ASSERT(vkBeginCommandBuffer(vCommandBuffer, &vBeginInfo), "Failed to begin the one time command buffer!");
+			return vCommandBuffer;
+		}
+
+		void VulkanDevice::EndOneTimeCommands(VkCommandBuffer vCommandBuffer)
+		{
+			VK_ASSERT(vkEndCommandBuffer(vCommandBuffer), "Failed to end the one time command buffer!");
+
+			VkSubmitInfo vSubmitInfo = {};
+			vSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			vSubmitInfo.pNext = VK_NULL_HANDLE;
+			vSubmitInfo.commandBufferCount = 1;
+			vSubmitInfo.pCommandBuffers = &vCommandBuffer;
+
+			{
+				std::lock_guard<std::mutex> lock(mQueueMutex);
+				VK_ASSERT(vkQueueSubmit(vQueue.vGraphicsQueue, 1, &vSubmitInfo, VK_NULL_HANDLE), "Failed to submit the one time command buffer!");
+				vkQueueWaitIdle(vQueue.vGraphicsQueue);
+			}
+
+			vkFreeCommandBuffers(vLogicalDevice, vOneTimeCommandPool, 1, &vCommandBuffer);
+		}
+
+		void VulkanDevice::WaitIdle()
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			vkDeviceWaitIdle(vLogicalDevice);
+		}
+
 		/**
 		 * Error callback function for GLFW.
 		 *
@@ -247,24 +746,38 @@ namespace Graphics
 			std::vector<VkPhysicalDevice> devices(deviceCount);
 			vkEnumeratePhysicalDevices(vInstance, &deviceCount, devices.data());
 
-			// Iterate through all the candidate devices and find the best device.
-			for (const VkPhysicalDevice& device : devices)
-			{
-				if (_Helpers::IsPhysicalDeviceSuitable(device, vSurface, deviceExtensions))
-				{
-					vkGetPhysicalDeviceProperties(device, &vPhysicalDeviceProperties);
+			// The environment overrides the configured device.
+			String override = mPhysicalDeviceOverride;
+			if (const char* pOverride = std::getenv(VULKAN_DEVICE_OVERRIDE_ENV))
+				override = pOverride;
 
-					if (vPhysicalDeviceProperties.deviceType == VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-						vPhysicalDevice = device;
-					else if (vPhysicalDeviceProperties.deviceType == VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU)
-						vPhysicalDevice = device;
-					else
-						vPhysicalDevice = device;
+			// Pick the suitable device with the highest score, unless one matches the override.
+			UI64 bestScore = 0;
+			bool isOverridden = false;
+			for (UI32 i = 0; i < deviceCount; i++)
+			{
+				const VkPhysicalDevice& device = devices[i];
+				if (!_Helpers::IsPhysicalDeviceSuitable(device, vSurface, deviceExtensions))
+					continue;
 
+				if (!override.empty() && _Helpers::MatchesDeviceOverride(device, i, override))
+				{
+					vPhysicalDevice = device;
+					isOverridden = true;
 					break;
 				}
+
+				UI64 score = _Helpers::ScorePhysicalDevice(device, vSurface);
+				if (vPhysicalDevice == VK_NULL_HANDLE || score > bestScore)
+				{
+					vPhysicalDevice = device;
+					bestScore = score;
+				}
 			}
 
+			if (!override.empty() && !isOverridden)
+				Logger::LogWarn((TEXT("No suitable physical device matches \"") + StringToWString(override) + TEXT("\"! Falling back to the highest scoring device.")).c_str());
+
 			//  Check if a physical device was found.
 			if (vPhysicalDevice == VK_NULL_HANDLE)
 			{
@@ -272,6 +785,9 @@ namespace Graphics
 				return;
 			}
 
+			vkGetPhysicalDeviceProperties(vPhysicalDevice, &vPhysicalDeviceProperties);
+			vkGetPhysicalDeviceMemoryProperties(vPhysicalDevice, &vMemoryProperties);
+
 #ifdef SS_DEBUG
 			printf("\n\t---------- VULKAN PHYSICAL DEVICE INFO ----------\n");
 			printf("API Version: %I32d\n", vPhysicalDeviceProperties.apiVersion);
@@ -302,6 +818,7 @@ namespace Graphics
 			}
 
 			printf("Device Name: %s\n", vPhysicalDeviceProperties.deviceName);
+			printf("Score: %llu%s\n", _Helpers::ScorePhysicalDevice(vPhysicalDevice, vSurface), isOverridden ? " (overridden)" : "");
 			printf("\t-------------------------------------------------\n\n");
 
 #endif	// SS_DEBUG
@@ -332,14 +849,36 @@ namespace Graphics
 			deviceFeatures.samplerAnisotropy = VK_TRUE;
 			deviceFeatures.sampleRateShading = VK_TRUE; // Enable sample shading feature for the device
 
+			// Bindless rendering is enabled whenever the device supports it.
+			std::vector<const char*> enabledExtensions = deviceExtensions;
+			VkPhysicalDeviceDescriptorIndexingFeatures vIndexingFeatures = {};
+			vIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+			mIsBindlessEnabled = _Helpers::CheckDescriptorIndexingSupport(vPhysicalDevice, vPhysicalDeviceProperties.apiVersion);
+			if (mIsBindlessEnabled)
+			{
+				if (vPhysicalDeviceProperties.apiVersion < VK_API_VERSION_1_2)
+					INSERT_INTO_VECTOR(enabledExtensions, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+				vIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+				vIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+				vIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+				vIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+				vIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+				vIndexingFeatures.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+				vIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+				vIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+			}
+
 			// Device create info.
 			VkDeviceCreateInfo createInfo = {};
 			createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+			createInfo.pNext = mIsBindlessEnabled ? &vIndexingFeatures : VK_NULL_HANDLE;
 			createInfo.queueCreateInfoCount = static_cast<UI32>(queueCreateInfos.size());
 			createInfo.pQueueCreateInfos = queueCreateInfos.data();
 			createInfo.pEnabledFeatures = &deviceFeatures;
-			createInfo.enabledExtensionCount = static_cast<UI32>(deviceExtensions.size());
-			createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+			createInfo.enabledExtensionCount = static_cast<UI32>(enabledExtensions.size());
+			createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 			createInfo.enabledLayerCount = static_cast<UI32>(mValidationLayers.size());
 			createInfo.ppEnabledLayerNames = mValidationLayers.data();
 
@@ -364,5 +903,51 @@ namespace Graphics
 			else if (vSampleCount & VK_SAMPLE_COUNT_2_BIT) vSampleCount = VK_SAMPLE_COUNT_2_BIT;
 			else vSampleCount = VK_SAMPLE_COUNT_1_BIT;
 		}
+
+		void VulkanDevice::CreateFrames(UI32 frameCount)
+		{
+			frameCount = std::max(1U, std::min(frameCount, GetMaxFrameBufferCount()));
+
+			mFrames.resize(frameCount);
+			for (VulkanFrame& frame : mFrames)
+				frame = CreateFrame(vLogicalDevice, vQueue.mGraphicsFamily.value());
+
+			mFrameIndex = 0;
+		}
+
+		void VulkanDevice::DestroyFrames()
+		{
+			for (VulkanFrame& frame : mFrames)
+			{
+				mUploadManager.RecycleSemaphores(frame.vUploadSemaphores);
+				DestroyFrame(vLogicalDevice, &frame);
+			}
+
+			mFrames.clear();
+		}
+
+		bool VulkanDevice::RecreateSwapChain()
+		{
+			WindowExtent extent = pWindow->GetExtent();
+			if (extent.mWidth == 0 || extent.mHeight == 0)
+				return false;
+
+			// Only the frames in flight can still use the old images, so there is no need to idle the whole device.
+			std::vector<VkFence> vFences;
+			for (const VulkanFrame& frame : mFrames)
+				INSERT_INTO_VECTOR(vFences, frame.vInFlightFence);
+
+			vkWaitForFences(vLogicalDevice, static_cast<UI32>(vFences.size()), vFences.data(), VK_TRUE, UINT64_MAX);
+
+			mDefaultPass.ReleaseFramebuffers();
+			mDefaultPass.Invalidate();
+
+			if (!pScreenTarget->GetSwapChain().Recreate(this, extent.mWidth, extent.mHeight))
+				return false;
+
+			vImageFences.assign(pScreenTarget->GetSwapChain().GetImages().size(), VK_NULL_HANDLE);
+			mIsSwapChainDirty = false;
+			return true;
+		}
 	}
 }
@@ -6,11 +6,50 @@
 #include "Graphics/Core/GDevice.h"
 #include "RenderTarget/SwapChain.h"
 #include "Queue.h"
+#include "PipelineLayoutCache.h"
+#include "PipelineCache.h"
+#include "PipelineCompiler.h"
+#include "Frame.h"
+#include "MemoryAllocator.h"
+#include "UploadManager.h"
+#include "CommandRecorder.h"
+#include "DescriptorAllocator.h"
+#include "BindlessTable.h"
+#include "GpuProfiler.h"
+#include "FramePacer.h"
+#include "DefaultPass.h"
+
+#include <mutex>
+
+/**
+ * The number of frames the CPU may record ahead of the GPU.
+ * Limited by the number of swap chain images.
+ */
+#define VULKAN_DEFAULT_FRAMES_IN_FLIGHT		2
+
+/**
+ * The number of frame buffers a headless device pretends its swap chain has.
+ */
+#define VULKAN_HEADLESS_FRAME_BUFFER_COUNT	3
+
+/**
+ * The environment variable overriding the physical device selection. Holds the index of the device in enumeration
+ * order or a part of its name.
+ */
+#define VULKAN_DEVICE_OVERRIDE_ENV			"SS_VULKAN_DEVICE"
 
 namespace Graphics
 {
 	namespace VulkanBackend
 	{
+		class VulkanRenderTargetSB3D;
+		class VulkanRenderTargetOS;
+
+		/**
+		 * Vulkan Device object.
+		 * If no window was created before Initialize, the device is headless: no surface is created and physical
+		 * devices without presentation support are accepted, so only off screen render targets can be used.
+		 */
 		class VulkanDevice : public GDevice {
 		public:
 			VulkanDevice() {}
@@ -19,6 +58,12 @@ namespace Graphics
 			virtual void CreateWindow(UI32 width, UI32 height, const char* pTitle) override final;
 			virtual void DestroyWindow() override final;
 
+			/**
+			 * Initialize the device.
+			 * The device is headless if CreateWindow was not called before this.
+			 *
+			 * @param enableValidation: Whether or not to enable API validation.
+			 */
 			virtual void Initialize(bool enableValidation) override final;
 			virtual void Terminate() override final;
 
@@ -30,11 +75,126 @@ namespace Graphics
 			virtual GRenderTarget* CreateRenderTarget(RenderTargetType type, UI32 width, UI32 height, float xOffset, float yOffset) override final;
 			virtual void DestroyRenderTarget(GRenderTarget* pRenderTarget) override final;
 
+			virtual void SetDisplayShader(ShaderCode&& shaderCode) override final;
+
 		public:
+			/**
+			 * Select the physical device to use instead of the highest scoring one.
+			 * Must be called before Initialize. The VULKAN_DEVICE_OVERRIDE_ENV environment variable takes precedence.
+			 *
+			 * @param override: The index of the device in enumeration order or a part of its name.
+			 */
+			void SetPhysicalDeviceOverride(const String& override) { mPhysicalDeviceOverride = override; }
+
 			VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() { return vPhysicalDeviceProperties; }
 			SwapChainSupportDetails& GetSwapChainSupportDetails() { return vSwapChainSupportDetails; }
 			VkSurfaceCapabilitiesKHR& GetSurfaceCapabilities() { return vSurfaceCapabilities; }
 			UI32 GetMaxFrameBufferCount() const;
+			bool IsHeadless() const { return vSurface == VK_NULL_HANDLE; }
+
+			/**
+			 * Find a memory type.
+			 *
+			 * @param typeFilter: The memory type bits the resource accepts.
+			 * @param vProperties: The required memory properties.
+			 * @return The memory type index. UINT32_MAX if none matches.
+			 */
+			UI32 FindMemoryType(UI32 typeFilter, VkMemoryPropertyFlags vProperties) const;
+
+			/**
+			 * Begin recording a command buffer which is submitted once and waited on.
+			 * Meant for setup work and tooling, never for per frame work.
+			 *
+			 * @return The command buffer.
+			 */
+			VkCommandBuffer BeginOneTimeCommands();
+
+			/**
+			 * End, submit and wait for a command buffer from BeginOneTimeCommands.
+			 *
+			 * @param vCommandBuffer: The command buffer.
+			 */
+			void EndOneTimeCommands(VkCommandBuffer vCommandBuffer);
+
+			/**
+			 * Wait for the device to be idle.
+			 * Holds the queue mutex, as waiting on the device requires every queue to be externally synchronized.
+			 */
+			void WaitIdle();
+
+			/**
+			 * Get the mutex guarding the queues.
+			 * The transfer and compute queues may be the graphics queue, so every submission, present and queue wait
+			 * locks this, whichever queue it uses and whichever thread it runs on.
+			 *
+			 * @return The mutex.
+			 */
+			std::mutex& GetQueueMutex() { return mQueueMutex; }
+			VulkanPipelineLayoutCache& GetPipelineLayoutCache() { return mPipelineLayoutCache; }
+			VkPipelineCache GetPipelineCache() const { return mPipelineCache.GetHandle(); }
+			VulkanPipelineCompiler& GetPipelineCompiler() { return mPipelineCompiler; }
+			VulkanMemoryAllocator& GetMemoryAllocator() { return mMemoryAllocator; }
+			VulkanUploadManager& GetUploadManager() { return mUploadManager; }
+			VulkanCommandRecorder& GetCommandRecorder() { return mCommandRecorder; }
+			VulkanDescriptorAllocator& GetDescriptorAllocator() { return mDescriptorAllocator; }
+
+			/**
+			 * Check if bindless rendering is enabled.
+			 * It is enabled when the physical device supports the descriptor indexing features. Pipeline layouts derived
+			 * from shaders then always contain the bindless table layout at VULKAN_BINDLESS_SET, and the table is bound
+			 * at the beginning of every frame.
+			 *
+			 * @return Boolean value.
+			 */
+			bool IsBindlessEnabled() const { return mIsBindlessEnabled; }
+			VulkanBindlessTable& GetBindlessTable() { return mBindlessTable; }
+			VulkanGpuProfiler& GetGpuProfiler() { return mGpuProfiler; }
+
+			/**
+			 * Show the GPU timings of the last resolved frame in the window title.
+			 *
+			 * @param isEnabled: Whether the timings are shown.
+			 */
+			void SetProfilerOverlay(bool isEnabled);
+
+			/**
+			 * Set the present policy.
+			 * The swap chain is recreated with the present mode of the policy at the beginning of the next frame.
+			 *
+			 * @param policy: The present policy.
+			 */
+			void SetPresentPolicy(VulkanPresentPolicy policy);
+			VulkanPresentPolicy GetPresentPolicy() const { return mFramePacer.GetPolicy(); }
+
+			/**
+			 * Limit the frame rate on the CPU. The uncapped policy ignores the limit.
+			 *
+			 * @param frameRate: The frame rate in frames per second. 0 removes the limit.
+			 */
+			void SetFrameRateLimit(float frameRate) { mFramePacer.SetFrameRateLimit(frameRate); }
+			VulkanFramePacer& GetFramePacer() { return mFramePacer; }
+
+			/**
+			 * Set the number of frames in flight.
+			 * Waits for the device to be idle and recreates the frame resources.
+			 *
+			 * @param frameCount: The requested frame count. Clamped to [1, GetMaxFrameBufferCount()].
+			 */
+			void SetFramesInFlight(UI32 frameCount);
+
+			UI32 GetFramesInFlight() const { return static_cast<UI32>(mFrames.size()); }
+			UI32 GetFrameIndex() const { return mFrameIndex; }
+			UI32 GetImageIndex() const { return mImageIndex; }
+			VulkanFrame& GetCurrentFrame() { return mFrames[mFrameIndex]; }
+			VkCommandBuffer GetCurrentCommandBuffer() { return mFrames[mFrameIndex].vCommandBuffer; }
+
+			/**
+			 * Check if a frame is being recorded.
+			 * False between BeginDraw and EndDraw when no swap chain image could be acquired.
+			 *
+			 * @return Boolean value.
+			 */
+			bool IsFrameActive() const { return mIsFrameActive; }
 
 		private:
 			void SetupGLFW();
@@ -50,13 +210,45 @@ namespace Graphics
 
 			void GetMaxSupportedSampleCount();
 
+			void CreateFrames(UI32 frameCount);
+			void DestroyFrames();
+
+			bool RecreateSwapChain();
+
 		public:
 			VkPhysicalDeviceProperties vPhysicalDeviceProperties = {};
+			VkPhysicalDeviceMemoryProperties vMemoryProperties = {};
 			SwapChainSupportDetails vSwapChainSupportDetails = {};
 			VkSurfaceCapabilitiesKHR vSurfaceCapabilities = {};
 
 			std::vector<const char*> mValidationLayers;
 			VulkanQueue vQueue = {};
+			std::mutex mQueueMutex;
+			VulkanPipelineLayoutCache mPipelineLayoutCache = {};
+			VulkanPipelineCache mPipelineCache = {};
+			VulkanPipelineCompiler mPipelineCompiler = {};
+			VulkanMemoryAllocator mMemoryAllocator = {};
+			VulkanUploadManager mUploadManager = {};
+			VulkanCommandRecorder mCommandRecorder = {};
+			VulkanDescriptorAllocator mDescriptorAllocator = {};
+			VulkanBindlessTable mBindlessTable = {};
+			VulkanGpuProfiler mGpuProfiler = {};
+			VulkanFramePacer mFramePacer = {};
+			VulkanDefaultPass mDefaultPass = {};
+
+			std::vector<VulkanFrame> mFrames;
+			std::vector<VkFence> vImageFences;			// The fence of the frame last rendering to each swap chain image.
+			VulkanRenderTargetSB3D* pScreenTarget = nullptr;
+			std::vector<VulkanRenderTargetOS*> pOffScreenTargets;
+			VkCommandPool vOneTimeCommandPool = VK_NULL_HANDLE;
+			UI32 mFrameIndex = 0;
+			UI32 mImageIndex = 0;
+			bool mIsFrameActive = false;
+			bool mHasSwapChainImage = false;
+			bool mIsSwapChainDirty = false;				// Set by resizes and out of date swap chains, handled once per frame.
+			bool mIsBindlessEnabled = false;
+			String mPhysicalDeviceOverride = "";
+			bool mShowProfilerOverlay = false;
 
 			VkInstance vInstance = VK_NULL_HANDLE;
 			VkDebugUtilsMessengerEXT vDebugMessenger = VK_NULL_HANDLE;
@@ -74,6 +74,7 @@ namespace Graphics
 		void VulkanWindow::Initialize(UI32 width, UI32 height, const char* pTitle)
 		{
 			mExtent = WindowExtent(width, height);
+			mTitle = pTitle;
 
 #ifdef SS_DEBUG
 			pWindowHandle = glfwCreateWindow(width, height, pTitle, nullptr, nullptr);
@@ -108,6 +109,16 @@ namespace Graphics
 		{
 			glfwPollEvents();
 		}
+
+		void VulkanWindow::WaitForEvents()
+		{
+			glfwWaitEvents();
+		}
+
+		void VulkanWindow::SetTitleSuffix(const String& suffix)
+		{
+			glfwSetWindowTitle(pWindowHandle, suffix.empty() ? mTitle.c_str() : (mTitle + " | " + suffix).c_str());
+		}
 		
 		void VulkanWindow::SetupInputs()
 		{
@@ -20,6 +20,18 @@ namespace Graphics
 
 			virtual void PollInputs() override final;
 
+			/**
+			 * Block till an event arrives. Used instead of polling while nothing can be rendered.
+			 */
+			void WaitForEvents();
+
+			/**
+			 * Show text after the title the window was created with.
+			 *
+			 * @param suffix: The text. An empty string restores the title.
+			 */
+			void SetTitleSuffix(const String& suffix);
+
 			GLFWwindow* GetWindowHandle() const { return pWindowHandle; }
 
 		private:
@@ -27,6 +39,7 @@ namespace Graphics
 			void SetupCallbacks();
 
 		private:
+			String mTitle = "";
 			GLFWwindow* pWindowHandle = nullptr;
 		};
 	}
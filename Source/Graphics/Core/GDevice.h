@@ -5,6 +5,7 @@
 
 #include "GWindow.h"
 #include "GRenderTarget.h"
+#include "Core/Objects/ShaderCode.h"
 
 namespace Graphics
 {
@@ -27,8 +28,16 @@ namespace Graphics
 		virtual GRenderTarget* CreateRenderTarget(RenderTargetType type, UI32 width, UI32 height, float xOffset, float yOffset) { return nullptr; }
 		virtual void DestroyRenderTarget(GRenderTarget* pRenderTarget) {}
 
+		/**
+		 * Set a stage of the shader drawn over the render target.
+		 * Drawing starts once both the vertex and fragment stages are set; setting a stage again rebuilds the pipeline.
+		 *
+		 * @param shaderCode: The reflected SPIR-V shader code.
+		 */
+		virtual void SetDisplayShader(ShaderCode&& shaderCode) {}
+
 	public:
-		Inputs::InputCenter* GetInputCenter() const { return pWindow->GetInputCenter(); }
+		Inputs::InputCenter* GetInputCenter() const { return pWindow ? pWindow->GetInputCenter() : nullptr; }
 
 	protected:
 		GWindow* pWindow = nullptr;
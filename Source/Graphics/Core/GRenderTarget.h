@@ -14,6 +14,7 @@ namespace Graphics
 		SCREEN_BOUND_3D,
 		OFF_SCREEN_2D,
 		OFF_SCREEN_3D,
+		COMPUTE,
 	};
 
 	class GRenderTarget {
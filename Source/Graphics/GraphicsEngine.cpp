@@ -3,12 +3,20 @@
 
 #include "GraphicsEngine.h"
 #include "Core/ErrorHandler/Logger.h"
+#include "Core/Types/Utilities.h"
 
 #include "Backend/Vulkan/VulkanDevice.h"
 
+#include <algorithm>
+
+#define SHADER_DIRECTORY			"Shaders"
+#define SHADER_CACHE_DIRECTORY		"Cache/Shaders"
+#define DISPLAY_VERTEX_SHADER		"Shaders/Display.vert"
+#define DISPLAY_FRAGMENT_SHADER		"Shaders/Display.frag"
+
 namespace Graphics
 {
-	void GraphcisEngine::Initialize(GraphcisAPI gAPI)
+	void GraphcisEngine::Initialize(GraphcisAPI gAPI, bool isHeadless)
 	{
 		switch (gAPI)
 		{
@@ -20,7 +28,8 @@ namespace Graphics
 			break;
 		}
 
-		GetDevice()->CreateWindow(mDefaultExtent.mWidth, mDefaultExtent.mHeight, "Shader Studio v1.0");
+		if (!isHeadless)
+			GetDevice()->CreateWindow(mDefaultExtent.mWidth, mDefaultExtent.mHeight, "Shader Studio v1.0");
 
 #if SS_DEBUG
 		GetDevice()->Initialize(true);
@@ -30,11 +39,14 @@ namespace Graphics
 
 #endif	// SS_DEBUG
 
-		CreateRenderTarget();
+		CreateRenderTarget(isHeadless);
+		InitializeShaders();
 	}
 
 	void GraphcisEngine::Update()
 	{
+		ApplyShaderReloads();
+
 		GetDevice()->BeginDraw();
 		GetDevice()->Update();
 		GetDevice()->EndDraw();
@@ -42,18 +54,84 @@ namespace Graphics
 
 	void GraphcisEngine::Terminate()
 	{
+		mShaderHotReloader.Terminate();
+		mDisplayShaders.clear();
+
 		DestroyRenderTarget();
 		GetDevice()->Terminate();
 		delete GetDevice();
 	}
 	
-	void GraphcisEngine::CreateRenderTarget()
+	void GraphcisEngine::CreateRenderTarget(bool isHeadless)
 	{
-		pRenderTarget = GetDevice()->CreateRenderTarget(RenderTargetType::SCREEN_BOUND_3D, mDefaultExtent.mWidth, mDefaultExtent.mHeight, 0.0f, 0.0f);
+		RenderTargetType type = isHeadless ? RenderTargetType::OFF_SCREEN_3D : RenderTargetType::SCREEN_BOUND_3D;
+		pRenderTarget = GetDevice()->CreateRenderTarget(type, mDefaultExtent.mWidth, mDefaultExtent.mHeight, 0.0f, 0.0f);
 	}
 	
 	void GraphcisEngine::DestroyRenderTarget()
 	{
 		GetDevice()->DestroyRenderTarget(pRenderTarget);
 	}
+
+	void GraphcisEngine::InitializeShaders()
+	{
+		if (!mShaderHotReloader.Initialize(SHADER_CACHE_DIRECTORY))
+			Logger::LogError(TEXT("Failed to initialize the shader hot reloader!"));
+
+		if (!mShaderHotReloader.WatchDirectory(SHADER_DIRECTORY))
+			Logger::LogError(TEXT("Failed to watch the shader directory! Shaders will not be reloaded on change."));
+
+		LoadDisplayShader(DISPLAY_VERTEX_SHADER, ShaderStage::VERTEX);
+		LoadDisplayShader(DISPLAY_FRAGMENT_SHADER, ShaderStage::FRAGMENT);
+	}
+
+	void GraphcisEngine::LoadDisplayShader(const char* pFile, ShaderStage stage)
+	{
+		ShaderCompileInfo info = {};
+		info.mFile = pFile;
+		info.mStage = stage;
+
+		// Registered even if the first compile fails, so that fixing the file picks it up.
+		INSERT_INTO_VECTOR(mDisplayShaders, mShaderHotReloader.Register(info));
+
+		ShaderCode shaderCode = {};
+		ShaderCompileResult result = mShaderHotReloader.GetCompiler().Compile(info, &shaderCode);
+
+		if (!result.mLog.empty())
+			Logger::LogWarn(StringToWString(result.mLog).c_str());
+
+		if (!result.mSuccess)
+		{
+			Logger::LogError((TEXT("Failed to compile the display shader ") + StringToWString(pFile) + TEXT("!")).c_str());
+			return;
+		}
+
+		GetDevice()->SetDisplayShader(std::move(shaderCode));
+	}
+
+	void GraphcisEngine::ApplyShaderReloads()
+	{
+		// Never waits on the compiler threads; anything not ready yet is picked up next frame.
+		if (!mShaderHotReloader.Poll(&mShaderReloads))
+			return;
+
+		for (ShaderReload& reload : mShaderReloads)
+		{
+			if (!reload.mResult.mLog.empty())
+				Logger::LogWarn(StringToWString(reload.mResult.mLog).c_str());
+
+			if (!reload.mResult.mSuccess)
+			{
+				Logger::LogError(TEXT("Shader reload failed, keeping the previous shader."));
+				continue;
+			}
+
+			// The device compiles the new pipeline in the background and keeps drawing the old one until it is ready.
+			if (std::find(mDisplayShaders.begin(), mDisplayShaders.end(), reload.mHandle) != mDisplayShaders.end())
+				GetDevice()->SetDisplayShader(std::move(reload.mCode));
+		}
+
+		// Every reload was handed off above.
+		mShaderReloads.clear();
+	}
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Core/GDevice.h"
+#include "Core/Compiler/ShaderHotReloader.h"
 
 namespace Graphics
 {
@@ -19,20 +20,35 @@ namespace Graphics
 		GraphcisEngine() {}
 		~GraphcisEngine() {}
 
-		void Initialize(GraphcisAPI gAPI = GraphcisAPI::VULKAN);
+		/**
+		 * Initialize the engine.
+		 *
+		 * @param gAPI: The graphics API.
+		 * @param isHeadless: Whether to render off screen without a window. The input center is nullptr if true.
+		 */
+		void Initialize(GraphcisAPI gAPI = GraphcisAPI::VULKAN, bool isHeadless = false);
 		void Update();
 		void Terminate();
 
 		Inputs::InputCenter* GetInputCenter() const { return pDevice->GetInputCenter(); }
+		ShaderHotReloader& GetShaderHotReloader() { return mShaderHotReloader; }
 
 	private:
 		constexpr GDevice* GetDevice() const noexcept { return pDevice; }
 
 	private:
-		void CreateRenderTarget();
+		void CreateRenderTarget(bool isHeadless);
 		void DestroyRenderTarget();
 
+		void InitializeShaders();
+		void LoadDisplayShader(const char* pFile, ShaderStage stage);
+		void ApplyShaderReloads();
+
 	private:
+		std::vector<ShaderReload> mShaderReloads;
+		std::vector<UI64> mDisplayShaders;		// Hot reloader handles of the display shader stages.
+		ShaderHotReloader mShaderHotReloader = {};
+
 		GDevice* pDevice = nullptr;
 		GRenderTarget* pRenderTarget = nullptr;
 		WindowExtent mDefaultExtent = WindowExtent(1280, 720);
@@ -0,0 +1,269 @@
+// Copyright 2020 Dhiraj Wishal
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Core/Compiler/ShaderBatchCompiler.h"
+#include "Core/Objects/ShaderPack.h"
+#include "Core/ErrorHandler/Logger.h"
+#include "Core/Types/Utilities.h"
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+/**
+ * Print the command line usage.
+ */
+void PrintUsage()
+{
+	std::cout << "Usage: ShaderBuilder <directory | manifest> [options]\n"
+		<< "  -c <directory>   Compile cache directory.\n"
+		<< "  -o <directory>   Write the compiled SPIR-V to this directory.\n"
+		<< "  -p <file>        Write the compiled shaders and their reflection to a shader pack.\n"
+		<< "                   Shaders are named by their path, variants by \"<path>#<variant key>\".\n"
+		<< "  -I <directory>   Add an include directory.\n"
+		<< "  -D <NAME=VALUE>  Add a define to every shader.\n"
+		<< "  -j <count>       Number of worker threads (default: all cores).\n"
+		<< "  -t <1.0|1.1|1.2> Target Vulkan version (default: 1.2).\n"
+		<< "  -O <none|performance|size> SPIR-V optimization preset (default: none).\n"
+		<< "  -z <none|spirv>  Compression of the cache entries and the pack (default: none).\n";
+}
+
+/**
+ * Get the path of the SPIR-V file a shader is written to.
+ * The directory layout of the input is kept, and variants get their key appended to the file name.
+ *
+ * @param info: The compile info of the shader.
+ * @param baseInfo: The info the defines were inherited from.
+ * @param inputBase: The directory the shaders were collected from.
+ * @param outputDirectory: The output directory.
+ * @return The path.
+ */
+std::filesystem::path GetOutputPath(const ShaderCompileInfo& info, const ShaderCompileInfo& baseInfo, const std::filesystem::path& inputBase, const String& outputDirectory)
+{
+	// Manifests may reference files outside of their directory, which must not be written outside of the output.
+	std::filesystem::path relativePath = std::filesystem::path(info.mFile).lexically_relative(inputBase);
+	if (relativePath.empty() || *relativePath.begin() == "..")
+		relativePath = std::filesystem::path(info.mFile).filename();
+
+	String fileName = relativePath.filename().string();
+
+	String key = ShaderBatchCompiler::GetVariantKey(info, baseInfo);
+	if (!key.empty())
+	{
+		for (char& character : key)
+			if (!std::isalnum(static_cast<unsigned char>(character)) && character != '_' && character != '-' && character != '=')
+				character = '_';
+
+		fileName += "." + key;
+	}
+
+	return std::filesystem::path(outputDirectory) / relativePath.parent_path() / (fileName + ".spv");
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	String input = argv[1];
+	String cacheDirectory, outputDirectory, packFile;
+	UI32 threadCount = 0;
+	bool compress = false;
+	ShaderCompileInfo baseInfo = {};
+
+	for (I32 i = 2; i < argc; i++)
+	{
+		String argument = argv[i];
+		if (i + 1 >= argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		String value = argv[++i];
+		if (argument == "-c")
+			cacheDirectory = value;
+		else if (argument == "-o")
+			outputDirectory = value;
+		else if (argument == "-p")
+			packFile = value;
+		else if (argument == "-I")
+			baseInfo.mIncludeDirectories.push_back(value);
+		else if (argument == "-D")
+		{
+			UI64 separator = value.find('=');
+			if (separator == String::npos)
+				baseInfo.mDefines.push_back({ value, "" });
+			else
+				baseInfo.mDefines.push_back({ value.substr(0, separator), value.substr(separator + 1) });
+		}
+		else if (argument == "-j")
+		{
+			const char* pEnd = value.data() + value.size();
+			std::from_chars_result result = std::from_chars(value.data(), pEnd, threadCount);
+			if (result.ec != std::errc() || result.ptr != pEnd)
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (argument == "-t")
+		{
+			if (value == "1.0")
+				baseInfo.mTarget = ShaderTargetEnvironment::VULKAN_1_0;
+			else if (value == "1.1")
+				baseInfo.mTarget = ShaderTargetEnvironment::VULKAN_1_1;
+			else if (value == "1.2")
+				baseInfo.mTarget = ShaderTargetEnvironment::VULKAN_1_2;
+			else
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (argument == "-O")
+		{
+			if (value == "none")
+				baseInfo.mOptimization = ShaderOptimizationLevel::NONE;
+			else if (value == "performance")
+				baseInfo.mOptimization = ShaderOptimizationLevel::PERFORMANCE;
+			else if (value == "size")
+				baseInfo.mOptimization = ShaderOptimizationLevel::SIZE;
+			else
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (argument == "-z")
+		{
+			if (value == "none")
+				compress = false;
+			else if (value == "spirv")
+				compress = true;
+			else
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// Collect the shaders. Packed shaders are named by their path relative to the input.
+	std::vector<ShaderCompileInfo> infos;
+	std::filesystem::path inputBase = std::filesystem::path(input).parent_path();
+	if (std::filesystem::is_directory(input))
+	{
+		inputBase = input;
+
+		if (!ShaderBatchCompiler::CollectDirectory(input.c_str(), baseInfo, &infos))
+		{
+			Logger::LogError((TEXT("Failed to read the shader directory: ") + StringToWString(input)).c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		String error;
+		if (!ShaderBatchCompiler::LoadManifest(input.c_str(), baseInfo, &infos, &error))
+		{
+			Logger::LogError(StringToWString(error).c_str());
+			return 1;
+		}
+	}
+
+	if (!outputDirectory.empty())
+		std::filesystem::create_directories(outputDirectory);
+
+	ShaderBatchCompiler compiler;
+	compiler.Initialize(cacheDirectory.empty() ? nullptr : cacheDirectory.c_str(), threadCount, compress);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<ShaderBatchEntry> entries = compiler.Compile(infos);
+	auto end = std::chrono::steady_clock::now();
+
+	const UI32 usedThreadCount = compiler.GetThreadPool().GetThreadCount();
+	compiler.Terminate();
+
+	// Report in input order so that the output is stable between runs.
+	ShaderPackWriter packWriter;
+	packWriter.SetCompression(compress);
+	std::set<std::filesystem::path> outputPaths;
+	UI32 failedCount = 0, cachedCount = 0;
+	for (const ShaderBatchEntry& entry : entries)
+	{
+		if (!entry.mResult.mLog.empty())
+			std::cout << entry.mResult.mLog << (entry.mResult.mLog.back() == '\n' ? "" : "\n");
+
+		if (!entry.mResult.mSuccess)
+		{
+			Logger::LogError((TEXT("Failed: ") + StringToWString(entry.mInfo.mFile)).c_str());
+			failedCount++;
+			continue;
+		}
+
+		if (entry.mResult.mCacheHit)
+			cachedCount++;
+
+		if (baseInfo.mOptimization != ShaderOptimizationLevel::NONE)
+		{
+			const I64 delta = static_cast<I64>(entry.mResult.mOptimizedInstructionCount) - static_cast<I64>(entry.mResult.mInstructionCount);
+			std::cout << entry.mInfo.mFile << ": " << entry.mResult.mInstructionCount << " -> " << entry.mResult.mOptimizedInstructionCount
+				<< " instructions (" << (delta > 0 ? "+" : "") << delta << ")\n";
+		}
+
+		if (!outputDirectory.empty())
+		{
+			std::filesystem::path outputPath = GetOutputPath(entry.mInfo, baseInfo, inputBase, outputDirectory);
+			if (!outputPaths.insert(outputPath).second)
+				Logger::LogWarn((TEXT("Two shaders are written to the same file, the first is overwritten: ") + StringToWString(outputPath.string())).c_str());
+
+			std::filesystem::create_directories(outputPath.parent_path());
+			std::ofstream file(outputPath, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(entry.mCode.GetCode()), entry.mCode.GetCodeSize());
+		}
+
+		if (!packFile.empty())
+		{
+			String name = std::filesystem::path(entry.mInfo.mFile).lexically_relative(inputBase).generic_string();
+
+			// Variants of one source are packed as "<path>#<variant key>".
+			const String key = ShaderBatchCompiler::GetVariantKey(entry.mInfo, baseInfo);
+			if (!key.empty())
+				name += "#" + key;
+
+			if (!packWriter.Add(name, entry.mCode))
+			{
+				Logger::LogError((TEXT("Failed to pack the shader (duplicate name?): ") + StringToWString(name)).c_str());
+				failedCount++;
+			}
+		}
+	}
+
+	if (!packFile.empty() && !failedCount && !packWriter.Write(packFile.c_str()))
+	{
+		Logger::LogError((TEXT("Failed to write the shader pack: ") + StringToWString(packFile)).c_str());
+		failedCount++;
+	}
+
+	const UI64 milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+	Logger::LogInfo((std::to_wstring(entries.size()) + TEXT(" shaders, ")
+		+ std::to_wstring(cachedCount) + TEXT(" cached, ")
+		+ std::to_wstring(failedCount) + TEXT(" failed in ")
+		+ std::to_wstring(milliseconds) + TEXT(" ms using ")
+		+ std::to_wstring(usedThreadCount) + TEXT(" threads.")).c_str());
+
+	return failedCount ? 1 : 0;
+}
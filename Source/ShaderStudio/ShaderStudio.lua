@@ -17,7 +17,9 @@ project "ShaderStudio"
 		"**.txt",
 		"**.cpp",
 		"**.h",
-		"**.lua"
+		"**.lua",
+		"**.vert",
+		"**.frag"
 	}
 
 	includedirs {
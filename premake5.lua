@@ -27,6 +27,7 @@ IncludeDir["gli"] = "$(SolutionDir)Dependencies/ThirdParty/gli"
 IncludeDir["Vulkan"] = "$(SolutionDir)Dependencies/ThirdParty/Vulkan/include"
 IncludeDir["SPIRVTools"] = "$(SolutionDir)Dependencies/ThirdParty/SPIRV-Tools/include"
 IncludeDir["glslang"] = "$(SolutionDir)Dependencies/ThirdParty/glslang/"
+IncludeDir["SPIRVCross"] = "$(SolutionDir)Dependencies/ThirdParty/SPIRV-Cross"
 IncludeDir["FreeImage"] = "$(SolutionDir)Dependencies/ThirdParty/FreeImage/Include"
 
 IncludeDir["jpeg"] = "$(SolutionDir)Dependencies/ThirdParty/gil/jpeg-6b"
@@ -46,7 +47,10 @@ IncludeLib["glslang"] = "$(SolutionDir)Dependencies/ThirdParty/Binaries/glslang/
 IncludeLib["FreeImageD"] = "$(SolutionDir)Dependencies/ThirdParty/Binaries/FreeImage/Debug"
 IncludeLib["FreeImageR"] = "$(SolutionDir)Dependencies/ThirdParty/Binaries/FreeImage/Release"
 
+include "Dependencies/ThirdParty/SPIRV-Cross/SPIRV-Cross.lua"
+
 include "Source/Core/Core.lua"
 include "Source/Graphics/Graphics.lua"
 include "Source/Inputs/Inputs.lua"
-include "Source/ShaderStudio/ShaderStudio.lua"
\ No newline at end of file
+include "Source/ShaderStudio/ShaderStudio.lua"
+include "Source/ShaderBuilder/ShaderBuilder.lua"
\ No newline at end of file